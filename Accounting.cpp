@@ -0,0 +1,146 @@
+#include "Accounting.h"
+
+bool Accounting::_enabled = false;
+volatile long Accounting::_allocations[NumCategories];
+volatile long Accounting::_bytes[NumCategories];
+volatile long Accounting::_live[NumCategories];
+volatile long Accounting::_peak[NumCategories];
+volatile long Accounting::_liveTotal = 0;
+volatile long Accounting::_peakTotal = 0;
+
+/**
+ * Raises a peak to the supplied value if it is higher, without losing a
+ * higher value stored concurrently by another thread.
+ */
+static void
+raisePeak(volatile long* peak, long value)
+{
+    long current = *peak;
+    while (value > current) {
+        long seen = __sync_val_compare_and_swap(peak, current, value);
+        if (seen == current) {
+            break;
+        }
+        current = seen;
+    }
+}
+
+void
+Accounting::setEnabled(bool value)
+{
+    _enabled = value;
+}
+
+void*
+Accounting::allocate(Category category, std::size_t bytes)
+{
+    void* memory = ::operator new(bytes);
+    allocated(category, bytes);
+    return memory;
+}
+
+void
+Accounting::release(Category category, void* memory, std::size_t bytes)
+{
+    released(category, bytes);
+    ::operator delete(memory);
+}
+
+void
+Accounting::allocated(Category category, std::size_t bytes)
+{
+    if (!_enabled) {
+        return;
+    }
+    long size = static_cast<long>(bytes);
+    __sync_fetch_and_add(&_allocations[category], 1);
+    __sync_fetch_and_add(&_bytes[category], size);
+    raisePeak(&_peak[category], __sync_add_and_fetch(&_live[category], size));
+    raisePeak(&_peakTotal, __sync_add_and_fetch(&_liveTotal, size));
+}
+
+void
+Accounting::released(Category category, std::size_t bytes)
+{
+    if (!_enabled) {
+        return;
+    }
+    long size = static_cast<long>(bytes);
+    __sync_fetch_and_sub(&_live[category], size);
+    __sync_fetch_and_sub(&_liveTotal, size);
+}
+
+void
+Accounting::resetPeaks()
+{
+    for (int i = 0; i < NumCategories; i++) {
+        _peak[i] = _live[i];
+    }
+    _peakTotal = _liveTotal;
+}
+
+void
+Accounting::resetTotals()
+{
+    for (int i = 0; i < NumCategories; i++) {
+        _allocations[i] = 0;
+        _bytes[i] = 0;
+    }
+}
+
+long
+Accounting::getAllocations(Category category)
+{
+    return _allocations[category];
+}
+
+long
+Accounting::getBytes(Category category)
+{
+    return _bytes[category];
+}
+
+long
+Accounting::getLive(Category category)
+{
+    return _live[category];
+}
+
+long
+Accounting::getPeak(Category category)
+{
+    return _peak[category];
+}
+
+long
+Accounting::getPeakTotal()
+{
+    return _peakTotal;
+}
+
+const char*
+Accounting::getCategoryName(Category category)
+{
+    switch (category) {
+    case NodeMemory:
+        return "node";
+    case EdgeMemory:
+        return "edge";
+    case BlockMemory:
+        return "block";
+    case ControlBlockMemory:
+        return "shared_ptr";
+    case LabelMemory:
+        return "label";
+    case BlockMapMemory:
+        return "block map";
+    case DemanglerMemory:
+        return "demangler";
+    case GraphMemory:
+        return "graph";
+    case WriteMemory:
+        return "write";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,177 @@
+/*
+** Accounting.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	ACCOUNTING_H_
+# define   	ACCOUNTING_H_
+
+#include <boost/checked_delete.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <new>
+
+/**
+ * Counts the allocations and live bytes of the data structures built for
+ * each graph, broken down by category, so that the functions and the
+ * structures driving peak memory use can be identified.
+ *
+ * Accounting is off by default and costs a single test per allocation
+ * while off.  It should be enabled before anything it counts is
+ * allocated, otherwise releasing objects allocated earlier makes the live
+ * figures drift low.  Counters are updated atomically, so allocations may
+ * happen on any thread.
+ */
+class Accounting {
+public:
+    /**
+     * The categories memory is accounted under.
+     */
+    enum Category {
+        NodeMemory, /** Node objects */
+        EdgeMemory, /** Edge objects */
+        BlockMemory, /** Block objects */
+        ControlBlockMemory, /** shared_ptr control blocks */
+        LabelMemory, /** interned label and name strings */
+        BlockMapMemory, /** the BasicBlock to Block map */
+        DemanglerMemory, /** strings returned by the demangler */
+        GraphMemory, /** the frozen per-function Graph */
+        WriteMemory, /** files waiting to be written */
+        NumCategories
+    };
+
+    /**
+     * Turns accounting on or off.
+     */
+    static void setEnabled(bool value);
+    /**
+     * @return true if allocations are being counted.
+     */
+    static bool isEnabled() { return _enabled; }
+
+    /**
+     * Allocates memory and counts it under a category.
+     * @param category The category to count the memory under.
+     * @param bytes The number of bytes to allocate.
+     */
+    static void* allocate(Category category, std::size_t bytes);
+    /**
+     * Frees memory returned by allocate.
+     * @param category The category the memory was counted under.
+     * @param memory The memory to free.
+     * @param bytes The number of bytes that were allocated.
+     */
+    static void release(Category category, void* memory, std::size_t bytes);
+    /**
+     * Counts memory allocated elsewhere (by the demangler, ...).
+     */
+    static void allocated(Category category, std::size_t bytes);
+    /**
+     * Counts the release of memory passed to allocated.
+     */
+    static void released(Category category, std::size_t bytes);
+
+    /**
+     * Starts a new measurement of peak use, from the bytes currently live.
+     */
+    static void resetPeaks();
+    /**
+     * Zeroes the allocation and byte totals.  Live bytes are unaffected.
+     */
+    static void resetTotals();
+
+    /**
+     * @return The number of allocations since the totals were reset.
+     */
+    static long getAllocations(Category category);
+    /**
+     * @return The number of bytes allocated since the totals were reset.
+     */
+    static long getBytes(Category category);
+    /**
+     * @return The number of bytes currently allocated.
+     */
+    static long getLive(Category category);
+    /**
+     * @return The largest number of bytes live at once since the peaks were
+     * reset.
+     */
+    static long getPeak(Category category);
+    /**
+     * @return The largest number of bytes live at once across all
+     * categories since the peaks were reset.
+     */
+    static long getPeakTotal();
+    /**
+     * @return A short name for the category, e.g. "node".
+     */
+    static const char* getCategoryName(Category category);
+
+    /**
+     * A standard allocator counting its memory under a category, for
+     * containers and shared_ptr control blocks.
+     */
+    template <class T, Category C>
+    class Allocator {
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+
+        template <class U>
+        struct rebind {
+            typedef Allocator<U, C> other;
+        };
+
+        Allocator() {}
+        template <class U>
+        Allocator(const Allocator<U, C>&) {}
+
+        pointer address(reference value) const { return &value; }
+        const_pointer address(const_reference value) const { return &value; }
+        size_type max_size() const { return static_cast<size_type>(-1) / sizeof(T); }
+
+        pointer allocate(size_type count, const void* = 0)
+        {
+            return static_cast<pointer>(Accounting::allocate(C, count * sizeof(T)));
+        }
+        void deallocate(pointer memory, size_type count)
+        {
+            Accounting::release(C, memory, count * sizeof(T));
+        }
+        void construct(pointer memory, const T& value) { ::new (static_cast<void*>(memory)) T(value); }
+        void destroy(pointer memory) { memory->~T(); }
+
+        template <class U>
+        bool operator==(const Allocator<U, C>&) const { return true; }
+        template <class U>
+        bool operator!=(const Allocator<U, C>&) const { return false; }
+    };
+
+    /**
+     * Takes ownership of an object with a shared_ptr whose control block
+     * is counted under ControlBlockMemory.
+     * @param object The object to own.
+     */
+    template <class T>
+    static boost::shared_ptr<T> share(T* object)
+    {
+        return boost::shared_ptr<T>(object, boost::checked_deleter<T>(),
+                                    Allocator<T, ControlBlockMemory>());
+    }
+private:
+    static bool _enabled;
+    static volatile long _allocations[NumCategories];
+    static volatile long _bytes[NumCategories];
+    static volatile long _live[NumCategories];
+    static volatile long _peak[NumCategories];
+    static volatile long _liveTotal;
+    static volatile long _peakTotal;
+};
+
+#endif 	    /* !ACCOUNTING_H_ */
@@ -2,9 +2,10 @@
 
 #include <stdio.h>
 
-Block::Block(unsigned int identifier, std::string label) :
+Block::Block(StringTable& strings, unsigned int identifier, std::string label) :
+    _strings(&strings),
     _id(identifier),
-    _label(label)
+    _label(strings.intern(label))
 {
 }
 
@@ -18,13 +19,13 @@ Block::getId()
     return _id;
 }
 
-std::string
+const std::string&
 Block::getLabel()
 {
-    return _label;
+    return _strings->lookup(_label);
 }
 
-Nodes
+const Nodes&
 Block::getNodes()
 {
     return _nodes;
@@ -39,7 +40,7 @@ Block::setId(unsigned int value)
 void
 Block::setLabel(std::string value)
 {
-    _label = value;
+    _label = _strings->intern(value);
 }
 
 void
@@ -48,39 +49,76 @@ Block::appendNode(pNode node)
     _nodes.push_back(node);
 }
 
+// Marks a block on the chain being walked, not resolved yet.
+static const int Resolving = -2;
+
 int
-Block::findEdge(llvm::BasicBlock* block, std::map<llvm::BasicBlock*, pBlock> blocks)
+Block::findEdge(llvm::BasicBlock* block, const BlockMap& blocks)
 {
-    int result = -1;
+    ResolvedEdges resolved;
+    return findEdge(block, blocks, resolved);
+}
 
+int
+Block::findEdge(llvm::BasicBlock* block, const BlockMap& blocks,
+                ResolvedEdges& resolved)
+{
     // The result is the id of the first node that should be displayed starting
     // from the supplied block and traversing nodes (including across blocks)
-    // until one is found that should be displayed.
-    std::map<llvm::BasicBlock*, pBlock>::iterator entry = blocks.find(block);
-    if (entry != blocks.end()) {
-        Nodes nodes = entry->second->getNodes();
-        if (nodes.size() > 0) {
-            bool found = false;
-            for (unsigned int j = 0; j < nodes.size(); j++) {
-                if (nodes[j]->getNodeLabel().length() > 0) {
-                    result = nodes[j]->getNodeId();
-                    found = true;
-                    break;
-                }
+    // until one is found that should be displayed.  Every block on the way
+    // leads to the same node, so they all get the result.
+    std::vector<llvm::BasicBlock*> chain;
+    int result = -1;
+    while (block != NULL) {
+        std::pair<ResolvedEdges::iterator, bool> known =
+            resolved.insert(std::pair<llvm::BasicBlock*, int>(block, Resolving));
+        if (!known.second) {
+            // A block on the current chain means it loops back on itself
+            // without ever reaching something to display.
+            if (known.first->second != Resolving) {
+                result = known.first->second;
+            }
+            break;
+        }
+        chain.push_back(block);
+        block = NULL;
+
+        BlockMap::const_iterator entry = blocks.find(chain.back());
+        if (entry == blocks.end()) {
+            break;
+        }
+        const Nodes& nodes = entry->second->getNodes();
+        for (unsigned int j = 0; j < nodes.size(); j++) {
+            if (nodes[j]->getNodeLabel().length() > 0) {
+                result = nodes[j]->getNodeId();
+                break;
             }
+        }
 
-            // If a node could not be found, recursively call findEdge for each block.
-            if (!found) {
-                std::map<std::string, llvm::BasicBlock*> i_blocks = nodes[nodes.size() - 1]->getBlockEdges();
-                result = findEdge(i_blocks.begin()->second, blocks);
+        // If a node could not be found, carry on with the first successor.
+        if (result < 0 && nodes.size() > 0) {
+            std::map<std::string, llvm::BasicBlock*> successors = nodes[nodes.size() - 1]->getBlockEdges();
+            if (successors.size() > 0) {
+                block = successors.begin()->second;
             }
         }
     }
+
+    for (std::vector<llvm::BasicBlock*>::iterator it = chain.begin(); it != chain.end(); it++) {
+        resolved[*it] = result;
+    }
     return result;
 }
 
 void
-Block::processNodes(std::map<llvm::BasicBlock*, pBlock> blocks)
+Block::processNodes(const BlockMap& blocks)
+{
+    ResolvedEdges resolved;
+    processNodes(blocks, resolved);
+}
+
+void
+Block::processNodes(const BlockMap& blocks, ResolvedEdges& resolved)
 {
     // This is ugly, but works (in principle and reality).
     // nextNodeId holds the id of the node to point to.
@@ -98,7 +136,7 @@ Block::processNodes(std::map<llvm::BasicBlock*, pBlock> blocks)
                 // current node as the next node since we're working backwards.
                 char buffer[255];
                 sprintf(buffer, "%d", nextNodeId);
-                _nodes[i]->addNodeEdge(new Edge(buffer));
+                _nodes[i]->addNodeEdge(new Edge(*_strings, buffer));
                 nextNodeId = _nodes[i]->getNodeId();
             }
         } else {
@@ -122,12 +160,17 @@ Block::processNodes(std::map<llvm::BasicBlock*, pBlock> blocks)
                 // would be displayed.  If the node has a label, it is
                 // the next id and the found edge is it's next id.
                 // Otherwise, the next id is the found edge.
-                int edgeId = findEdge(it->second, blocks);
+                int edgeId = findEdge(it->second, blocks, resolved);
                 if (_nodes[i]->getNodeLabel().length() > 0) {
+                    // Nothing displayable is reachable along this
+                    // edge, so there is nothing to point to.
+                    if (edgeId < 0) {
+                        continue;
+                    }
                     char buffer[255];
                     sprintf(buffer, "%d", edgeId);
                     std::string edgeLabel = std::string(buffer);
-                    _nodes[i]->addNodeEdge(new Edge(edgeLabel, it->first));
+                    _nodes[i]->addNodeEdge(new Edge(*_strings, edgeLabel, it->first));
                     nextNodeId = _nodes[i]->getNodeId();
                 } else {
                     nextNodeId = edgeId;
@@ -9,16 +9,31 @@
 #ifndef  BLOCK_H_
 # define BLOCK_H_
 
+#include "Accounting.h"
 #include "Node.h"
+#include "StringTable.h"
 
 #include "llvm/BasicBlock.h"
 
 #include <boost/shared_ptr.hpp>
 #include <vector>
 #include <map>
+#include <set>
 
 class Block;
 typedef boost::shared_ptr<Block> pBlock;
+/**
+ * Maps each BasicBlock of a function to the Block representing it.
+ */
+typedef std::map<llvm::BasicBlock*, pBlock, std::less<llvm::BasicBlock*>,
+                 Accounting::Allocator<std::pair<llvm::BasicBlock* const, pBlock>,
+                                       Accounting::BlockMapMemory> > BlockMap;
+/**
+ * The id of the first displayed node reached from each BasicBlock already
+ * resolved, or -1 if none is reachable.  Shared by every Block of a
+ * function, so that each chain of blocks is only walked once.
+ */
+typedef std::map<llvm::BasicBlock*, int> ResolvedEdges;
 
 /**
  * Represents a block within the file.  A block is made up of a series of
@@ -32,10 +47,12 @@ public:
      * identifier and label.  The identifier is expected to be
      * globally unique, but no verification is performed by the
      * object.
+     * @param strings The table the label, and the labels of the edges
+     * made by processNodes, are interned in
      * @param identifier The unique reference for this Block
      * @param label The (optional) label to associate with this Block
      */
-    Block(unsigned int identifier, std::string label="");
+    Block(StringTable& strings, unsigned int identifier, std::string label="");
     /**
      * Destructor, does not explicitely free any resources, by may
      * cause any Node objects to go out of scope (via shared pointers)
@@ -43,6 +60,13 @@ public:
      */
     ~Block();
 
+    /**
+     * Block objects are allocated through Accounting so their memory can be
+     * counted under BlockMemory.
+     */
+    static void* operator new(std::size_t size) { return Accounting::allocate(Accounting::BlockMemory, size); }
+    static void operator delete(void* object, std::size_t size) { Accounting::release(Accounting::BlockMemory, object, size); }
+
     /**
      * @return The unique identifier for this Block
      */
@@ -50,11 +74,11 @@ public:
     /**
      * @return The label associated with this Block
      */
-    std::string getLabel();
+    const std::string& getLabel();
     /**
      * @return the ordered list of Nodes representing instructions.
      */
-    Nodes getNodes();
+    const Nodes& getNodes();
 
     /**
      * @param value Value to set the unique identifier to
@@ -73,28 +97,45 @@ public:
 
     /**
      * Determine the id of the first node in the chain associated with the supplied
-     * block that should be displayed.  This uses a recursive method to traverse
-     * subsequent blocks.
+     * block that should be displayed.  Blocks without a displayed node pass on
+     * to their first successor, followed iteratively.
      * @param block The LLVM block to use as a starting point
      * @param blocks The map of LLVM blocks to internal blocks to traverse.
      * @return The id of the first labelled node in the hierarchy starting at the
-     * supplied block.
+     * supplied block, or -1 if no labelled node is reachable.
      */
-    int findEdge(llvm::BasicBlock* block, std::map<llvm::BasicBlock*, pBlock> blocks);
+    int findEdge(llvm::BasicBlock* block, const BlockMap& blocks);
+    /**
+     * Same as above, looking up and recording every block of the chain in
+     * resolved, so that no block is walked twice.
+     * @param resolved The blocks of the function resolved so far.
+     */
+    int findEdge(llvm::BasicBlock* block, const BlockMap& blocks,
+                 ResolvedEdges& resolved);
     /**
      * Perform processing of the contained nodes to create appropriate edges.
      * @param blocks The map of LLVM blockss to internal blocks for mapping edges.
      */
-    void processNodes(std::map<llvm::BasicBlock*, pBlock> blocks);
+    void processNodes(const BlockMap& blocks);
+    /**
+     * Same as above, sharing the blocks resolved with the other blocks of
+     * the function.
+     * @param resolved The blocks of the function resolved so far.
+     */
+    void processNodes(const BlockMap& blocks, ResolvedEdges& resolved);
 private:
+    /**
+     * The table the strings of this Block are interned in.
+     */
+    StringTable* _strings;
     /**
      * The unique identifier for this Block.
      */
     unsigned int _id;
     /**
-     * The label associated with this Block.
+     * The interned label associated with this Block.
      */
-    std::string _label;
+    StringTable::Id _label;
     /**
      * The list of Nodes representing instructions for this Block.
      */
@@ -0,0 +1,155 @@
+#include "DotEmitter.h"
+#include "DotText.h"
+#include "Node.h"
+
+DotEmitter::DotEmitter(std::ostream& out, std::string prefix) :
+    GraphEmitter(out),
+    _prefix(prefix),
+    _layout(NULL)
+{
+}
+
+void
+DotEmitter::beginGraph(const std::string& identifier, const std::string& label)
+{
+    // The start node already carries the label.
+    _out << "digraph " << identifier << " {\n";
+    if (_layout != NULL) {
+        // Only neato honours pinned positions.  Running neato -n2
+        // directly also skips its solver.
+        _out << "layout=neato\n";
+    }
+}
+
+void
+DotEmitter::emitNode(const Graph& graph, Graph::Index node)
+{
+    /**
+     * This is all kinds of hacky.  The entire processing structure
+     * and internal storage of nodes should be modified, but it'd be
+     * hard to beat the speed of this, seeing as it's O(n).  This
+     * works because of how DOT files are specified.  Node
+     * "definitions" can occur anywhere and "node edge definitions"
+     * can occur anywhere.  In practice, the current model is to
+     * generate the definition of the node, followed by the edges
+     * leading away from the node.
+     */
+
+    std::string name = graph.getName(node);
+
+    // First, DOT files can't have '.' (or most other punctuation) in
+    // identifiers, so they are escaped as '_' and their hex code.
+    if (name.length() > 0) {
+        name = DotText::sanitizeIdentifier(name);
+    }
+
+    /**
+     * This begins the node definition in the file.  The node
+     * definition includes the identifier (name or id), the label to
+     * display for it and the shape of the node.  The format used is
+     * node_identifier [label="<label>" shape="<shape>"]
+     */ 
+    // If the node has a name assigned to it (in practice, only
+    // functions have names assigned), emit the name, otherwise,
+    // use the node id that was assigned.
+    _out << _prefix;
+    if (name.length() > 0) {
+        _out << name;
+    } else {
+        graph.writeDotId(_out, node);
+    }
+
+    // Every node has a label, even if that label is an empty string.
+    // This greatly simplifies processing, but requires getNodeLable()
+    // to return an empty string rather than NULL if a label hasn't
+    // been assigned.
+    // Labels are escaped as they are written, since demangled names
+    // are full of quotes, braces and angle brackets.
+    _out << " [label=\"";
+    DotText::writeEscapedLabel(_out, graph.getLabel(node));
+    _out << "\"";
+    // Emit the shape to draw for the node.  To match the graphs,
+    // start should technically be a filled circle with no name, end
+    // should be a filled circle with a concentric circle with no
+    // name.  The default is box since we don't have a way of knowing
+    // what actual node type it is (makes it easy to add new node
+    // types without needing special handling until it's known).
+    _out << " shape=";
+    switch(graph.getType(node)) {
+    case Node::START:
+        //out << "circle";
+        _out << "none";
+        break;
+    case Node::END:
+        //out << "doublecircle";
+        _out << "none";
+        break;
+    case Node::DECISION:
+        _out << "diamond";
+        break;
+    case Node::ELIDED:
+        _out << "note";
+        break;
+    case Node::ACTIVITY:
+    default:
+        _out << "box";
+    }
+    if (_layout != NULL && node < _layout->size()) {
+        _out << " pos=\"";
+        _layout->writePosition(_out, node);
+        _out << "!\"";
+    }
+
+    _out << "]\n";
+    /**
+     * This ends the node definition portion.  The node will be
+     * displayed in the graph and potentially have edges leading to
+     * it.  At this point, no edges lead away from the node.
+     */
+
+    /**
+     * This begins the node edge definition portion.  
+     */
+    // An entry in the file needs to occur with the following format
+    // for the edges leading away from the node:
+    // node_identifier -> subsequent_node_identifier [label="<label>"]
+    // <label> is the label to apply to the edge, not to a node.
+    for (Graph::Index edge = graph.getEdgesBegin(node);
+         edge < graph.getEdgesEnd(node);
+         edge++) {
+        // Again, output the name or the id associated with the node.
+        _out << _prefix;
+        if (name.length() > 0) {
+            _out << name;
+        } else {
+            graph.writeDotId(_out, node);
+        }
+        _out << " -> ";
+
+        // Edges lead to the position of a node in the graph, which is
+        // written under its id.
+        _out << _prefix;
+        graph.writeDotId(_out, graph.getEdgeTarget(edge));
+        
+        // The label associated with the edge, typically empty but is
+        // currently true/false for edges leading from decision nodes.
+        // Profiled edges also show how many times they were taken.
+        _out << "[label=\"";
+        DotText::writeEscapedLabel(_out, graph.getEdgeLabel(edge));
+        if (graph.getEdgeWeight(edge) >= 0) {
+            if (graph.getEdgeLabel(edge).length() > 0) {
+                _out << " ";
+            }
+            _out << "(" << static_cast<uint64_t>(graph.getEdgeWeight(edge)) << ")";
+        }
+        _out << "\"]";
+
+        _out << "\n";
+    }
+}
+
+void
+DotEmitter::endGraph()
+{
+    _out << "}";
+}
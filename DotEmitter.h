@@ -0,0 +1,47 @@
+/*
+** DotEmitter.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	DOTEMITTER_H_
+# define   	DOTEMITTER_H_
+
+#include "GraphEmitter.h"
+#include "Layout.h"
+
+/**
+ * Writes a graph as a Graphviz DOT digraph.  Node shapes follow the node
+ * type: diamonds for decisions, notes for elided parts of the graph and
+ * boxes for everything else.
+ *
+ * With a Layout, every node is pinned at its position and the graph asks
+ * for the neato engine, so Graphviz only routes the edges.
+ */
+class DotEmitter : public GraphEmitter {
+public:
+    /**
+     * Constructor.
+     * @param out The stream to write to.
+     * @param prefix Prepended to every node id written, to keep the ids of
+     * expanded callees distinct from the caller's.
+     */
+    DotEmitter(std::ostream& out, std::string prefix = "");
+
+    virtual void beginGraph(const std::string& identifier, const std::string& label);
+    virtual void emitNode(const Graph& graph, Graph::Index node);
+    virtual void endGraph();
+
+    /**
+     * Sets the positions to write for the nodes of the graphs written
+     * next.
+     * @param layout The layout of the graph, or NULL to leave the layout
+     * to Graphviz.
+     */
+    void setLayout(const Layout* layout) { _layout = layout; }
+private:
+    std::string _prefix;
+    const Layout* _layout;
+};
+
+#endif 	    /* !DOTEMITTER_H_ */
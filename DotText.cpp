@@ -0,0 +1,265 @@
+#include "DotText.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @return true if the character is copied unchanged into a DOT identifier.
+ */
+static inline bool
+isAlphanumeric(unsigned char value)
+{
+    return (value >= '0' && value <= '9') ||
+        (value >= 'A' && value <= 'Z') ||
+        (value >= 'a' && value <= 'z');
+}
+
+/**
+ * @return true if the character can't appear unchanged in a quoted DOT
+ * string.
+ */
+static inline bool
+isLabelSpecial(unsigned char value)
+{
+    return value == '"' || value == '\\' || value < 0x20;
+}
+
+#if defined(__AVX2__)
+/**
+ * @return a mask with every byte of value that is in [low, low + span] set.
+ */
+static inline __m256i
+inRange(__m256i value, char low, char span)
+{
+    __m256i offset = _mm256_sub_epi8(value, _mm256_set1_epi8(low));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(span)), offset);
+}
+#elif defined(__SSE2__)
+/**
+ * @return a mask with every byte of value that is in [low, low + span] set.
+ */
+static inline __m128i
+inRange(__m128i value, char low, char span)
+{
+    __m128i offset = _mm_sub_epi8(value, _mm_set1_epi8(low));
+    return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(span)), offset);
+}
+#endif
+
+/**
+ * Finds the length of the run of characters at the start of data that
+ * don't need escaping.
+ * @param data The text to scan.
+ * @param length The number of characters in data.
+ * @return The index of the first character that needs escaping, or length.
+ */
+static size_t
+plainLabelLength(const char* data, size_t length)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    for (; i + 32 <= length; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                                                          _mm256_cmpeq_epi8(chunk, backslash)),
+                                          inRange(chunk, 0, 0x1F));
+        unsigned int mask = _mm256_movemask_epi8(special);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                    _mm_cmpeq_epi8(chunk, backslash)),
+                                       inRange(chunk, 0, 0x1F));
+        unsigned int mask = _mm_movemask_epi8(special);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; i < length; i++) {
+        if (isLabelSpecial(data[i])) {
+            break;
+        }
+    }
+    return i;
+}
+
+/**
+ * Finds the length of the run of letters and digits at the start of data.
+ * @param data The text to scan.
+ * @param length The number of characters in data.
+ * @return The index of the first other character, or length.
+ */
+static size_t
+alphanumericLength(const char* data, size_t length)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 32 <= length; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i valid = _mm256_or_si256(_mm256_or_si256(inRange(chunk, '0', 9),
+                                                        inRange(chunk, 'A', 25)),
+                                        inRange(chunk, 'a', 25));
+        unsigned int mask = ~static_cast<unsigned int>(_mm256_movemask_epi8(valid));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__SSE2__)
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i valid = _mm_or_si128(_mm_or_si128(inRange(chunk, '0', 9),
+                                                  inRange(chunk, 'A', 25)),
+                                     inRange(chunk, 'a', 25));
+        unsigned int mask = ~_mm_movemask_epi8(valid) & 0xFFFF;
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; i < length; i++) {
+        if (!isAlphanumeric(data[i])) {
+            break;
+        }
+    }
+    return i;
+}
+
+/**
+ * Appends a character to an identifier as '_' and its two hex digits.
+ */
+static void
+appendHexEscape(std::string& out, unsigned char value)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    out += '_';
+    out += digits[value >> 4];
+    out += digits[value & 0xF];
+}
+
+/**
+ * Appends to a std::string, for escapeLabel.
+ */
+struct StringSink {
+    StringSink(std::string& out) : _out(out) {}
+    void write(const char* data, size_t length) { _out.append(data, length); }
+    std::string& _out;
+};
+
+/**
+ * Writes to a std::ostream, for writeEscapedLabel.
+ */
+struct StreamSink {
+    StreamSink(std::ostream& out) : _out(out) {}
+    void write(const char* data, size_t length) { _out.write(data, length); }
+    std::ostream& _out;
+};
+
+/**
+ * Copies value to the sink, alternating between copying a run of
+ * characters that need no escaping in one go and escaping the single
+ * character that ended the run.
+ */
+template <class Sink>
+static void
+escapeTo(Sink& sink, const std::string& value)
+{
+    const char* data = value.data();
+    size_t length = value.length();
+    size_t i = 0;
+
+    while (i < length) {
+        size_t plain = plainLabelLength(data + i, length - i);
+        sink.write(data + i, plain);
+        i += plain;
+        if (i == length) {
+            break;
+        }
+
+        switch (data[i]) {
+        case '"':
+            sink.write("\\\"", 2);
+            break;
+        case '\\':
+            sink.write("\\\\", 2);
+            break;
+        case '\n':
+            sink.write("\\n", 2);
+            break;
+        default:
+            sink.write(" ", 1);
+        }
+        i++;
+    }
+}
+
+std::string
+DotText::sanitizeIdentifier(const std::string& value)
+{
+    if (value.length() == 0) {
+        return "_";
+    }
+
+    const char* data = value.data();
+    size_t length = value.length();
+    size_t i = 0;
+
+    std::string result;
+    result.reserve(length);
+
+    // Unquoted DOT identifiers can't start with a digit.
+    if (data[0] >= '0' && data[0] <= '9') {
+        appendHexEscape(result, data[0]);
+        i++;
+    }
+
+    // '_' introduces every escape, so it is doubled itself, which keeps
+    // distinct names from ever sharing an identifier.
+    while (i < length) {
+        size_t plain = alphanumericLength(data + i, length - i);
+        result.append(data + i, plain);
+        i += plain;
+        if (i < length) {
+            if (data[i] == '_') {
+                result.append("__", 2);
+            } else {
+                appendHexEscape(result, data[i]);
+            }
+            i++;
+        }
+    }
+
+    return result;
+}
+
+std::string
+DotText::escapeLabel(const std::string& value)
+{
+    std::string result;
+    result.reserve(value.length());
+    StringSink sink(result);
+    escapeTo(sink, value);
+    return result;
+}
+
+void
+DotText::writeEscapedLabel(std::ostream& out, const std::string& value)
+{
+    StreamSink sink(out);
+    escapeTo(sink, value);
+}
@@ -0,0 +1,48 @@
+/*
+** DotText.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	DOTTEXT_H_
+# define   	DOTTEXT_H_
+
+#include <ostream>
+#include <string>
+
+/**
+ * Converts arbitrary text (symbol names, demangled C++ signatures, ...)
+ * into text that is valid inside a DOT file.  Both conversions make a
+ * single pass over their input, 16 or 32 bytes at a time when SSE2 or
+ * AVX2 is available at compile time and a byte at a time otherwise.
+ */
+class DotText {
+public:
+    /**
+     * Converts the supplied text into a DOT identifier.  Letters and digits
+     * are kept, '_' is doubled and every other byte, as well as a leading
+     * digit, becomes '_' and two hex digits ("hello.bc" is "hello_2Ebc").
+     * Distinct texts never give the same identifier.  An empty text
+     * becomes "_".
+     * @param value The text to convert.
+     * @return The identifier.
+     */
+    static std::string sanitizeIdentifier(const std::string& value);
+    /**
+     * Escapes the supplied text for use inside a double quoted DOT string.
+     * '"' and '\' are backslash escaped, newlines become the DOT line break
+     * "\n" and any other control character becomes a space.
+     * @param value The text to escape.
+     * @return The escaped text, without surrounding quotes.
+     */
+    static std::string escapeLabel(const std::string& value);
+    /**
+     * Writes the supplied text to the stream escaped as by escapeLabel,
+     * without building an intermediate string.
+     * @param out The stream to write to.
+     * @param value The text to escape.
+     */
+    static void writeEscapedLabel(std::ostream& out, const std::string& value);
+};
+
+#endif 	    /* !DOTTEXT_H_ */
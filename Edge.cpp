@@ -1,8 +1,10 @@
 #include "Edge.h"
 
-Edge::Edge(std::string id, std::string label):
-    _id(id),
-    _label(label)
+Edge::Edge(StringTable& strings, std::string id, std::string label):
+    _strings(&strings),
+    _id(strings.intern(id)),
+    _label(strings.intern(label)),
+    _weight(-1)
 {
 }
 
@@ -11,14 +13,32 @@ Edge::~Edge()
 
 }
 
-std::string
+const std::string&
 Edge::getLabel()
+{
+    return _strings->lookup(_label);
+}
+
+StringTable::Id
+Edge::getLabelId()
 {
     return _label;
 }
 
-std::string
+const std::string&
 Edge::getId()
 {
-    return _id;
+    return _strings->lookup(_id);
+}
+
+double
+Edge::getWeight()
+{
+    return _weight;
+}
+
+void
+Edge::setWeight(double value)
+{
+    _weight = value;
 }
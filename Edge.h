@@ -11,6 +11,9 @@
 #ifndef   	EDGE_H_
 # define   	EDGE_H_
 
+#include "Accounting.h"
+#include "StringTable.h"
+
 #include <string>
 
 /**
@@ -20,25 +23,50 @@ class Edge {
 public:
     /**
      * Constructor.
+     * @param strings The table the id and label are interned in.
      * @param id The unique name the edge points to.
      * @param label The label to use for the edge.
      */
-    Edge(std::string id="-1", std::string label="");
+    Edge(StringTable& strings, std::string id="-1", std::string label="");
     ~Edge();
 
+    /**
+     * Edge objects are allocated through Accounting so their memory can be
+     * counted under EdgeMemory.
+     */
+    static void* operator new(std::size_t size) { return Accounting::allocate(Accounting::EdgeMemory, size); }
+    static void operator delete(void* object, std::size_t size) { Accounting::release(Accounting::EdgeMemory, object, size); }
+
     /**
      * @return the label associated with the edge.
      */
-    std::string getLabel();
+    const std::string& getLabel();
+    /**
+     * @return the interned label, as held by the StringTable.
+     */
+    StringTable::Id getLabelId();
     /**
      * @return the unique name of the node the edge points to.
      */
-    std::string getId();
+    const std::string& getId();
+    /**
+     * @return the number of times the edge was taken in the profile, or
+     * -1 if it is not known.
+     */
+    double getWeight();
+    /**
+     * @param value The number of times the edge was taken.
+     */
+    void setWeight(double value);
 private:
-    // Stores the unique name of the node the edge points to.
-    std::string _id;
-    // Stores the label associated with the edge.
-    std::string _label;
+    // Stores the table the strings of the edge are interned in.
+    StringTable* _strings;
+    // Stores the interned unique name of the node the edge points to.
+    StringTable::Id _id;
+    // Stores the interned label associated with the edge.
+    StringTable::Id _label;
+    // Stores the profiled execution count of the edge.
+    double _weight;
 };
 
 #endif 	    /* !EDGE_H_ */
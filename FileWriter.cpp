@@ -0,0 +1,336 @@
+#include "FileWriter.h"
+#include "Accounting.h"
+
+#include <sched.h>
+
+// The times a waiting thread yields before parking, since the other side
+// is usually about to get to it.
+static const unsigned int SpinAttempts = 64;
+
+FileWriter::FileWriter() :
+    _journal(NULL),
+    _queue(NULL),
+    _running(false),
+    _stopping(false),
+    _queued(0),
+    _written(0),
+    _writerWaiting(false),
+    _producerWaiting(false)
+{
+    pthread_mutex_init(&_lock, NULL);
+    pthread_cond_init(&_writerWake, NULL);
+    pthread_cond_init(&_producerWake, NULL);
+}
+
+FileWriter::~FileWriter()
+{
+    stop();
+    pthread_cond_destroy(&_producerWake);
+    pthread_cond_destroy(&_writerWake);
+    pthread_mutex_destroy(&_lock);
+}
+
+void
+FileWriter::setQueueDepth(unsigned int depth)
+{
+    stop();
+    if (depth > 0) {
+        _queue = new SpscQueue<File*>(depth);
+    }
+}
+
+void
+FileWriter::setCompression(OutputFile::Compression compression, int level)
+{
+    flush();
+    _file.setCompression(compression, level);
+}
+
+OutputFile::Compression
+FileWriter::getCompression()
+{
+    return _file.getCompression();
+}
+
+std::string
+FileWriter::getSuffix()
+{
+    return _file.getSuffix();
+}
+
+void
+FileWriter::setJournal(Journal* journal)
+{
+    flush();
+    _journal = journal;
+}
+
+void
+FileWriter::beginUnit(const std::string& unit)
+{
+    endUnit();
+    _unit = unit;
+    if (_journal != NULL) {
+        _journal->recordStart(unit);
+    }
+}
+
+void
+FileWriter::endUnit()
+{
+    if (_unit.empty()) {
+        return;
+    }
+    File* end = new File;
+    end->unit = _unit;
+    end->endsUnit = true;
+    _unit.clear();
+    submit(end);
+}
+
+void
+FileWriter::write(const std::string& path, std::string& content)
+{
+    File* file = new File;
+    file->path = path;
+    file->content.swap(content);
+    file->unit = _unit;
+    file->endsUnit = false;
+    Accounting::allocated(Accounting::WriteMemory, file->content.capacity());
+    submit(file);
+}
+
+void
+FileWriter::submit(File* file)
+{
+    if (_queue == NULL) {
+        writeFile(file);
+        return;
+    }
+
+    // The thread is only started once there is something to write.
+    if (!_running) {
+        _stopping = false;
+        _running = pthread_create(&_thread, NULL, &FileWriter::run, this) == 0;
+        if (!_running) {
+            writeFile(file);
+            return;
+        }
+    }
+
+    __sync_fetch_and_add(&_queued, 1);
+    unsigned int attempts = 0;
+    while (!_queue->tryPush(file)) {
+        if (attempts++ < SpinAttempts) {
+            sched_yield();
+        } else {
+            park(_producerWaiting, _producerWake, &FileWriter::isFull);
+        }
+    }
+    wake(_writerWaiting, _writerWake);
+}
+
+void
+FileWriter::flush()
+{
+    unsigned int attempts = 0;
+    while (isBusy()) {
+        if (attempts++ < SpinAttempts) {
+            sched_yield();
+        } else {
+            park(_producerWaiting, _producerWake, &FileWriter::isBusy);
+        }
+    }
+    // Everything the writer did is visible from here on.
+    __sync_synchronize();
+}
+
+std::vector<std::string>
+FileWriter::takeFailures()
+{
+    flush();
+    std::vector<std::string> failures;
+    failures.swap(_failures);
+    return failures;
+}
+
+void*
+FileWriter::run(void* writer)
+{
+    FileWriter* self = static_cast<FileWriter*>(writer);
+    unsigned int attempts = 0;
+    for (;;) {
+        File* file;
+        if (self->_queue->tryPop(file)) {
+            // The slot is free: a producer waiting for room can render
+            // the next file while this one is written.
+            self->wake(self->_producerWaiting, self->_producerWake);
+            self->writeFile(file);
+            __sync_fetch_and_add(&self->_written, 1);
+            self->wake(self->_producerWaiting, self->_producerWake);
+            attempts = 0;
+        } else if (self->_stopping) {
+            // Checked after the queue came up empty, and nothing is
+            // queued once stopping is set.
+            if (self->_queue->empty()) {
+                break;
+            }
+        } else if (attempts++ < SpinAttempts) {
+            sched_yield();
+        } else {
+            self->park(self->_writerWaiting, self->_writerWake, &FileWriter::isIdle);
+        }
+    }
+    return NULL;
+}
+
+void
+FileWriter::writeFile(File* file)
+{
+    if (file->endsUnit) {
+        // A unit with a file missing is left to be done again.
+        if (_journal != NULL && _failedUnit != file->unit) {
+            _journal->recordDone(file->unit);
+        }
+        delete file;
+        return;
+    }
+
+    if (_journal != NULL) {
+        _journal->recordWriting(file->unit);
+    }
+    _file.open(file->path.c_str());
+    _file.write(file->content.data(), file->content.length());
+    _file.close();
+    if (_journal != NULL) {
+        _journal->recordWriting("");
+    }
+    if (_file.fail()) {
+        _failures.push_back(file->path + _file.getSuffix());
+        _failedUnit = file->unit;
+    } else if (_journal != NULL && !file->unit.empty()) {
+        _journal->recordFile(file->unit, file->path + _file.getSuffix(), _file.getHash());
+    }
+    Accounting::released(Accounting::WriteMemory, file->content.capacity());
+    delete file;
+}
+
+void
+FileWriter::stop()
+{
+    if (_running) {
+        flush();
+        _stopping = true;
+        wake(_writerWaiting, _writerWake);
+        pthread_join(_thread, NULL);
+        _running = false;
+    }
+    delete _queue;
+    _queue = NULL;
+}
+
+void
+FileWriter::park(volatile bool& waiting, pthread_cond_t& condition,
+                 bool (FileWriter::*blocked)())
+{
+    pthread_mutex_lock(&_lock);
+    waiting = true;
+    // Either the other side sees waiting set once it has made progress,
+    // or this sees the progress, so a wake up can't be missed.  Holding
+    // the lock until the wait starts covers the rest.
+    __sync_synchronize();
+    if ((this->*blocked)()) {
+        pthread_cond_wait(&condition, &_lock);
+    }
+    waiting = false;
+    pthread_mutex_unlock(&_lock);
+}
+
+void
+FileWriter::wake(volatile bool& waiting, pthread_cond_t& condition)
+{
+    __sync_synchronize();
+    if (waiting) {
+        pthread_mutex_lock(&_lock);
+        pthread_cond_signal(&condition);
+        pthread_mutex_unlock(&_lock);
+    }
+}
+
+bool
+FileWriter::isIdle()
+{
+    return _queue->empty() && !_stopping;
+}
+
+bool
+FileWriter::isFull()
+{
+    return _queue->full();
+}
+
+bool
+FileWriter::isBusy()
+{
+    return _written != _queued;
+}
+
+QueuedFile::QueuedFile(FileWriter& writer) :
+    std::ostream(NULL),
+    _writer(writer),
+    _open(false)
+{
+    rdbuf(&_buffer);
+}
+
+QueuedFile::~QueuedFile()
+{
+    close();
+}
+
+void
+QueuedFile::open(const char* path)
+{
+    close();
+    clear();
+    _path = path;
+    _buffer.data.clear();
+    _open = true;
+}
+
+void
+QueuedFile::close()
+{
+    if (_open) {
+        _writer.write(_path, _buffer.data);
+        _open = false;
+    }
+}
+
+bool
+QueuedFile::is_open()
+{
+    return _open;
+}
+
+std::string
+QueuedFile::getSuffix()
+{
+    return _writer.getSuffix();
+}
+
+QueuedFile::Buffer::int_type
+QueuedFile::Buffer::overflow(int_type c)
+{
+    if (c != traits_type::eof()) {
+        data.push_back(traits_type::to_char_type(c));
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize
+QueuedFile::Buffer::xsputn(const char* value, std::streamsize length)
+{
+    data.append(value, length);
+    return length;
+}
@@ -0,0 +1,250 @@
+/*
+** FileWriter.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	FILEWRITER_H_
+# define   	FILEWRITER_H_
+
+#include "Journal.h"
+#include "OutputFile.h"
+#include "SpscQueue.h"
+
+#include <pthread.h>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/**
+ * Writes whole files on a dedicated thread, so that compressing and
+ * writing one graph overlaps with building the next.
+ *
+ * Files are handed over complete, through an SpscQueue of a fixed depth.
+ * With a depth of 2, one file is being written while the next is rendered
+ * into memory: plain double buffering.  A producer finding the queue full
+ * waits for the writer, so at most depth files are held in memory at
+ * once.  With a depth of 0 files are written on the calling thread, as
+ * they are handed over.
+ *
+ * Handing files over never takes a lock.  Only a thread left waiting, the
+ * writer with nothing to write or the producer with no room, parks on a
+ * condition variable after a few yields, to be woken by the other side.
+ *
+ * Only one thread may hand files over.
+ *
+ * With a Journal, the files handed over are grouped in units: each file
+ * written is recorded for its unit, and the unit is recorded as done once
+ * its last file is written, unless one of them failed.
+ */
+class FileWriter {
+public:
+    /**
+     * Constructor, writes files on the calling thread until a queue depth
+     * is set.
+     */
+    FileWriter();
+    /**
+     * Destructor, writes out everything queued and stops the thread.
+     */
+    ~FileWriter();
+
+    /**
+     * Sets the number of files that may wait to be written.  Waits for
+     * everything already queued to be written first.
+     * @param depth The depth of the queue, or 0 to write on the calling
+     * thread.
+     */
+    void setQueueDepth(unsigned int depth);
+    /**
+     * Sets the compression of the files handed over from now on.  Waits
+     * for everything already queued to be written first.
+     */
+    void setCompression(OutputFile::Compression compression, int level = -1);
+    /**
+     * @return The compression applied, after falling back for formats
+     * that weren't built in.
+     */
+    OutputFile::Compression getCompression();
+    /**
+     * @return The suffix appended to the names of files written.
+     */
+    std::string getSuffix();
+
+    /**
+     * Sets the journal the files written and the units done are recorded
+     * in.  Waits for everything already queued to be written first.
+     * @param journal The journal, or NULL to record nothing.
+     */
+    void setJournal(Journal* journal);
+    /**
+     * Ends the current unit, if any, then records a unit as started and
+     * makes the files handed over from now on part of it.
+     */
+    void beginUnit(const std::string& unit);
+    /**
+     * Ends the current unit, which is recorded as done once its files are
+     * written.
+     */
+    void endUnit();
+
+    /**
+     * Hands over a file to write, replacing any existing file.  Waits
+     * while the queue is full.
+     * @param path The name of the file, without compression suffix.
+     * @param content The content of the file, which is taken, leaving
+     * content empty.
+     */
+    void write(const std::string& path, std::string& content);
+    /**
+     * Waits until every file handed over has been written.
+     */
+    void flush();
+    /**
+     * Returns the names of the files that couldn't be written since last
+     * asked, once they have all been attempted.
+     */
+    std::vector<std::string> takeFailures();
+private:
+    /**
+     * A file waiting to be written.
+     */
+    struct File {
+        std::string path;
+        std::string content;
+        // The unit the file is part of.
+        std::string unit;
+        // true if this isn't a file but marks the end of unit.
+        bool endsUnit;
+    };
+
+    /**
+     * The writer thread: writes files as they are queued until stopped.
+     * @param writer The FileWriter the thread works for.
+     */
+    static void* run(void* writer);
+    /**
+     * Hands over a file or the end of a unit.  Waits while the queue is
+     * full.
+     */
+    void submit(File* file);
+    /**
+     * Writes and frees a file, or records the unit it ends.
+     */
+    void writeFile(File* file);
+    /**
+     * Writes out everything queued and joins the writer thread.
+     */
+    void stop();
+
+    /**
+     * Blocks the calling thread on condition for as long as blocked holds,
+     * flagging it as waiting so the other side knows to wake it.
+     */
+    void park(volatile bool& waiting, pthread_cond_t& condition,
+              bool (FileWriter::*blocked)());
+    /**
+     * Wakes the thread parked on condition, if waiting says there is one.
+     * Called once what it waits for has changed.
+     */
+    void wake(volatile bool& waiting, pthread_cond_t& condition);
+    /**
+     * @return true while the writer has nothing to do.
+     */
+    bool isIdle();
+    /**
+     * @return true while the queue has no room.
+     */
+    bool isFull();
+    /**
+     * @return true while files handed over aren't all written.
+     */
+    bool isBusy();
+
+    FileWriter(const FileWriter&);
+    FileWriter& operator=(const FileWriter&);
+
+    // Only touched by the thread writing files, once started.
+    OutputFile _file;
+    std::vector<std::string> _failures;
+    Journal* _journal;
+    // The last unit a file failed to be written for.
+    std::string _failedUnit;
+
+    // The unit files are handed over for, by the producer.
+    std::string _unit;
+
+    SpscQueue<File*>* _queue;
+    pthread_t _thread;
+    bool _running;
+    volatile bool _stopping;
+    // Counts of files handed over and written, to wait for the queue to
+    // drain.
+    volatile unsigned long _queued;
+    volatile unsigned long _written;
+
+    // Where a side that has to wait parks: the writer on _writerWake
+    // until there is a file or it is stopped, the producer on
+    // _producerWake until there is room or everything is written.
+    pthread_mutex_t _lock;
+    pthread_cond_t _writerWake;
+    pthread_cond_t _producerWake;
+    volatile bool _writerWaiting;
+    volatile bool _producerWaiting;
+};
+
+/**
+ * An output stream collecting the content of a file in memory, which is
+ * handed over to a FileWriter when closed.  Has the open and close of
+ * OutputFile, so either can be written to the same way.
+ */
+class QueuedFile : public std::ostream {
+public:
+    /**
+     * Constructor.
+     * @param writer The writer to hand files over to.
+     */
+    QueuedFile(FileWriter& writer);
+    /**
+     * Destructor, hands over the file if one is open.
+     */
+    ~QueuedFile();
+
+    /**
+     * Starts a new file.
+     * @param path The name of the file, without compression suffix.
+     */
+    void open(const char* path);
+    /**
+     * Hands the file over to the writer.
+     */
+    void close();
+    /**
+     * @return true if a file is open.
+     */
+    bool is_open();
+    /**
+     * @return The suffix the writer appends to the names of files.
+     */
+    std::string getSuffix();
+private:
+    /**
+     * Appends everything written to a string, which can be taken without
+     * copying it.
+     */
+    class Buffer : public std::streambuf {
+    public:
+        std::string data;
+    protected:
+        virtual int_type overflow(int_type c);
+        virtual std::streamsize xsputn(const char* data, std::streamsize length);
+    };
+
+    FileWriter& _writer;
+    Buffer _buffer;
+    std::string _path;
+    bool _open;
+};
+
+#endif 	    /* !FILEWRITER_H_ */
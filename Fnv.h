@@ -0,0 +1,48 @@
+/*
+** Fnv.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	FNV_H_
+# define   	FNV_H_
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+
+/**
+ * The 64-bit FNV-1a hash, used wherever RocketShip needs a cheap hash that
+ * stays the same between runs: file contents recorded in the journal,
+ * shard directories and shortened file names, and stable node ids.
+ */
+class Fnv {
+public:
+    /**
+     * The hash of no bytes, to start extend from.
+     */
+    static const uint64_t Empty = 14695981039346656037ULL;
+
+    /**
+     * Extends a hash with more bytes.
+     * @param hash The hash of the bytes so far.
+     * @return The hash of the bytes so far followed by data.
+     */
+    static uint64_t extend(uint64_t hash, const char* data, size_t length)
+    {
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    /**
+     * @return The hash of a string.
+     */
+    static uint64_t hash(const std::string& value)
+    {
+        return extend(Empty, value.data(), value.length());
+    }
+};
+
+#endif 	    /* !FNV_H_ */
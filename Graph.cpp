@@ -0,0 +1,250 @@
+#include "Graph.h"
+#include "Accounting.h"
+#include "Fnv.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdio.h>
+
+const Graph::Index Graph::None;
+
+Graph::Graph(StringTable& strings) :
+    _strings(&strings),
+    _arena(NULL),
+    _bytes(0)
+{
+    reset(0, 0);
+}
+
+Graph::~Graph()
+{
+    release();
+}
+
+void
+Graph::reset(Index nodes, Index edges)
+{
+    release();
+
+    _nodeCapacity = nodes;
+    _edgeCapacity = edges;
+    if (nodes == 0) {
+        return;
+    }
+
+    _bytes = edges * sizeof(double)
+        + nodes * sizeof(uint64_t)
+        + nodes * sizeof(llvm::Instruction*)
+        + nodes * (sizeof(int) + 2 * sizeof(StringTable::Id) + sizeof(unsigned int))
+        + (nodes + 1) * sizeof(Index)
+        + edges * (sizeof(Index) + sizeof(StringTable::Id))
+        + nodes * sizeof(unsigned char);
+    _arena = static_cast<char*>(Accounting::allocate(Accounting::GraphMemory, _bytes));
+
+    char* next = _arena;
+    _edgeWeights = reinterpret_cast<double*>(next);
+    next += edges * sizeof(double);
+    _stableHashes = reinterpret_cast<uint64_t*>(next);
+    next += nodes * sizeof(uint64_t);
+    _instructions = reinterpret_cast<llvm::Instruction**>(next);
+    next += nodes * sizeof(llvm::Instruction*);
+    _ids = reinterpret_cast<int*>(next);
+    next += nodes * sizeof(int);
+    _labels = reinterpret_cast<StringTable::Id*>(next);
+    next += nodes * sizeof(StringTable::Id);
+    _names = reinterpret_cast<StringTable::Id*>(next);
+    next += nodes * sizeof(StringTable::Id);
+    _stableSuffixes = reinterpret_cast<unsigned int*>(next);
+    next += nodes * sizeof(unsigned int);
+    _edgeOffsets = reinterpret_cast<Index*>(next);
+    next += (nodes + 1) * sizeof(Index);
+    _edgeTargets = reinterpret_cast<Index*>(next);
+    next += edges * sizeof(Index);
+    _edgeLabels = reinterpret_cast<StringTable::Id*>(next);
+    next += edges * sizeof(StringTable::Id);
+    _types = reinterpret_cast<unsigned char*>(next);
+
+    _edgeOffsets[0] = 0;
+}
+
+void
+Graph::release()
+{
+    if (_arena != NULL) {
+        Accounting::release(Accounting::GraphMemory, _arena, _bytes);
+    }
+    _arena = NULL;
+    _bytes = 0;
+    _nodeCapacity = 0;
+    _edgeCapacity = 0;
+    _nodeCount = 0;
+    _edgeCount = 0;
+    _stable = false;
+
+    _stableHashes = NULL;
+    _instructions = NULL;
+    _ids = NULL;
+    _labels = NULL;
+    _names = NULL;
+    _stableSuffixes = NULL;
+    _edgeOffsets = NULL;
+    _types = NULL;
+    _edgeWeights = NULL;
+    _edgeTargets = NULL;
+    _edgeLabels = NULL;
+}
+
+void
+Graph::swap(Graph& other)
+{
+    std::swap(_strings, other._strings);
+    std::swap(_arena, other._arena);
+    std::swap(_bytes, other._bytes);
+    std::swap(_nodeCapacity, other._nodeCapacity);
+    std::swap(_edgeCapacity, other._edgeCapacity);
+    std::swap(_nodeCount, other._nodeCount);
+    std::swap(_edgeCount, other._edgeCount);
+    std::swap(_stable, other._stable);
+
+    std::swap(_stableHashes, other._stableHashes);
+    std::swap(_instructions, other._instructions);
+    std::swap(_ids, other._ids);
+    std::swap(_labels, other._labels);
+    std::swap(_names, other._names);
+    std::swap(_stableSuffixes, other._stableSuffixes);
+    std::swap(_edgeOffsets, other._edgeOffsets);
+    std::swap(_types, other._types);
+    std::swap(_edgeWeights, other._edgeWeights);
+    std::swap(_edgeTargets, other._edgeTargets);
+    std::swap(_edgeLabels, other._edgeLabels);
+}
+
+Graph::Index
+Graph::addNode(int id, int type, StringTable::Id label, StringTable::Id name,
+               llvm::Instruction* instruction)
+{
+    if (_nodeCount == _nodeCapacity) {
+        return None;
+    }
+
+    Index node = _nodeCount++;
+    _ids[node] = id;
+    _types[node] = static_cast<unsigned char>(type);
+    _labels[node] = label;
+    _names[node] = name;
+    _instructions[node] = instruction;
+    _stableHashes[node] = 0;
+    _stableSuffixes[node] = 0;
+    _edgeOffsets[node + 1] = _edgeCount;
+    return node;
+}
+
+void
+Graph::addEdge(int target, StringTable::Id label, double weight)
+{
+    if (_nodeCount == 0 || _edgeCount == _edgeCapacity) {
+        return;
+    }
+
+    Index edge = _edgeCount++;
+    _edgeTargets[edge] = static_cast<Index>(target);
+    _edgeLabels[edge] = label;
+    _edgeWeights[edge] = weight;
+    _edgeOffsets[_nodeCount] = _edgeCount;
+}
+
+void
+Graph::finish()
+{
+    // Edges are compacted in place as unresolved ones are dropped, so
+    // each node's range is rewritten as it is walked.
+    Index kept = 0;
+    Index edge = 0;
+    for (Index node = 0; node < _nodeCount; node++) {
+        Index end = _edgeOffsets[node + 1];
+        _edgeOffsets[node] = kept;
+        for (; edge < end; edge++) {
+            Index target = find(static_cast<int>(_edgeTargets[edge]));
+            if (target == None) {
+                continue;
+            }
+            _edgeTargets[kept] = target;
+            _edgeLabels[kept] = _edgeLabels[edge];
+            _edgeWeights[kept] = _edgeWeights[edge];
+            kept++;
+        }
+    }
+    if (_edgeOffsets != NULL) {
+        _edgeOffsets[_nodeCount] = kept;
+    }
+    _edgeCount = kept;
+}
+
+Graph::Index
+Graph::find(int id) const
+{
+    const int* begin = _ids;
+    const int* end = _ids + _nodeCount;
+    const int* found = std::lower_bound(begin, end, id);
+    if (found == end || *found != id) {
+        return None;
+    }
+    return static_cast<Index>(found - begin);
+}
+
+void
+Graph::assignStableIds()
+{
+    // The id of a node is a hash of its label and of how many nodes with
+    // the same label come before it, so inserting or removing a node
+    // only changes the ids of nodes sharing its label, not of every node
+    // after it.
+    std::map<StringTable::Id, unsigned int> occurrences;
+    std::set<std::pair<uint64_t, unsigned int> > assigned;
+
+    for (Index node = 0; node < _nodeCount; node++) {
+        const std::string& label = getLabel(node);
+        unsigned int occurrence = occurrences[_labels[node]]++;
+        char bytes[sizeof(occurrence)];
+        for (unsigned int i = 0; i < sizeof(occurrence); i++) {
+            bytes[i] = static_cast<char>((occurrence >> (i * 8)) & 0xff);
+        }
+        uint64_t hash = Fnv::extend(Fnv::hash(label), bytes, sizeof(bytes));
+
+        // A collision within one function is unlikely, but would merge
+        // two nodes, so it gets a suffix.
+        unsigned int suffix = 0;
+        while (!assigned.insert(std::pair<uint64_t, unsigned int>(hash, suffix)).second) {
+            suffix++;
+        }
+        _stableHashes[node] = hash;
+        _stableSuffixes[node] = suffix;
+    }
+    _stable = true;
+}
+
+void
+Graph::writeDotId(std::ostream& out, Index node) const
+{
+    if (!_stable) {
+        out << _ids[node];
+        return;
+    }
+
+    char buffer[32];
+    sprintf(buffer, "n%016llx", static_cast<unsigned long long>(_stableHashes[node]));
+    out << buffer;
+    if (_stableSuffixes[node] > 0) {
+        out << "_" << _stableSuffixes[node];
+    }
+}
+
+std::string
+Graph::getDotId(Index node) const
+{
+    std::ostringstream id;
+    writeDotId(id, node);
+    return id.str();
+}
@@ -0,0 +1,210 @@
+/*
+** Graph.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	GRAPH_H_
+# define   	GRAPH_H_
+
+#include "StringTable.h"
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <stdint.h>
+
+namespace llvm {
+    class Instruction;
+}
+
+/**
+ * The displayed part of a function graph in a flat form, built once the
+ * Node and Block objects have been linked up and read by everything that
+ * writes the graph out.
+ *
+ * Node fields are held as parallel arrays indexed by node position, and
+ * the edges leaving each node are a contiguous range of the edge arrays
+ * (compressed sparse rows), with edges pointing at node positions rather
+ * than ids.  All arrays live in a single allocation, counted under
+ * GraphMemory, which is sized exactly when the graph is reset and freed in
+ * one step when it is released.
+ *
+ * A graph is built by reset, then addNode for every node in order, each
+ * followed by addEdge for the edges leaving it, then finish.
+ *
+ * The graph is a cache for emission, not a replacement for the Node and
+ * Block objects: those are still built in full, and copied into the graph
+ * before they are freed, so the peak memory of a function is higher with
+ * it, not lower.  What it buys is a compact, contiguous form for the
+ * emitters, the slicer and the layout to walk.
+ */
+class Graph {
+public:
+    /**
+     * The position of a node or an edge in the graph.
+     */
+    typedef unsigned int Index;
+    /**
+     * Returned for a node that isn't in the graph.
+     */
+    static const Index None = static_cast<Index>(-1);
+
+    /**
+     * Constructor, creates an empty graph.
+     * @param strings The table the labels and names of the nodes and
+     * edges added are interned in.
+     */
+    Graph(StringTable& strings);
+    /**
+     * Destructor, frees the arrays.
+     */
+    ~Graph();
+
+    /**
+     * Frees the current graph and makes room for a new one.
+     * @param nodes The number of nodes the graph will have.
+     * @param edges The number of edges the graph will have.
+     */
+    void reset(Index nodes, Index edges);
+    /**
+     * Frees the arrays of the graph, leaving it empty.
+     */
+    void release();
+    /**
+     * Exchanges the contents of two graphs, along with their string
+     * tables, without copying the arrays.
+     */
+    void swap(Graph& other);
+
+    /**
+     * @return The table the labels and names of the graph are interned
+     * in.
+     */
+    StringTable& getStrings() const { return *_strings; }
+
+    /**
+     * Appends a node.  Nodes must be added in increasing order of id.
+     * @param id The internal id of the node.
+     * @param type The Node::Type of the node.
+     * @param label The interned label of the node.
+     * @param name The interned name of the node, or StringTable::Empty.
+     * @param instruction The instruction the node represents, or NULL.
+     * @return The position of the node, or None if the graph is full.
+     */
+    Index addNode(int id, int type, StringTable::Id label, StringTable::Id name,
+                  llvm::Instruction* instruction);
+    /**
+     * Appends an edge leaving the node added last.
+     * @param target The internal id of the node the edge leads to.
+     * @param label The interned label of the edge.
+     * @param weight The profiled execution count of the edge, or -1.
+     */
+    void addEdge(int target, StringTable::Id label, double weight);
+    /**
+     * Resolves the targets of the edges to node positions, once every
+     * node has been added.  Edges leading to a node that isn't in the
+     * graph are dropped.
+     */
+    void finish();
+
+    /**
+     * @return The number of nodes.
+     */
+    Index size() const { return _nodeCount; }
+    /**
+     * @return The number of edges.
+     */
+    Index getEdgeCount() const { return _edgeCount; }
+    /**
+     * @param id The internal id of a node.
+     * @return The position of the node, or None if it isn't in the graph.
+     */
+    Index find(int id) const;
+
+    int getId(Index node) const { return _ids[node]; }
+    int getType(Index node) const { return _types[node]; }
+    const std::string& getLabel(Index node) const { return _strings->lookup(_labels[node]); }
+    const std::string& getName(Index node) const { return _strings->lookup(_names[node]); }
+    llvm::Instruction* getInstruction(Index node) const { return _instructions[node]; }
+    /**
+     * @return The interned label and name of a node, to copy it into
+     * another graph.
+     */
+    StringTable::Id getLabelId(Index node) const { return _labels[node]; }
+    StringTable::Id getNameId(Index node) const { return _names[node]; }
+    /**
+     * Replaces the label of a node, to shorten it for display.  Stable ids
+     * already assigned stay as they are.
+     */
+    void setLabel(Index node, StringTable::Id label) { _labels[node] = label; }
+    /**
+     * @return The position of the first edge leaving a node.
+     */
+    Index getEdgesBegin(Index node) const { return _edgeOffsets[node]; }
+    /**
+     * @return The position after the last edge leaving a node.
+     */
+    Index getEdgesEnd(Index node) const { return _edgeOffsets[node + 1]; }
+    /**
+     * @return The position of the node an edge leads to.
+     */
+    Index getEdgeTarget(Index edge) const { return _edgeTargets[edge]; }
+    const std::string& getEdgeLabel(Index edge) const { return _strings->lookup(_edgeLabels[edge]); }
+    StringTable::Id getEdgeLabelId(Index edge) const { return _edgeLabels[edge]; }
+    double getEdgeWeight(Index edge) const { return _edgeWeights[edge]; }
+
+    /**
+     * Gives every node an id derived from its label and the number of
+     * nodes with the same label before it, so ids stay the same between
+     * runs unless the nodes change.  A node whose label changes gets a new
+     * id, so a diff shows it as removed and added rather than changed.
+     */
+    void assignStableIds();
+    /**
+     * Writes the id to use in a DOT file for a node: its stable id once
+     * assigned, its internal id before.
+     * @param out The stream to write to.
+     * @param node The position of the node.
+     */
+    void writeDotId(std::ostream& out, Index node) const;
+    /**
+     * @return The id writeDotId would write.
+     */
+    std::string getDotId(Index node) const;
+
+    /**
+     * @return The number of bytes held by the arrays.
+     */
+    size_t getBytes() const { return _bytes; }
+private:
+    Graph(const Graph&);
+    Graph& operator=(const Graph&);
+
+    StringTable* _strings;
+    // The single allocation holding every array, and its size.
+    char* _arena;
+    size_t _bytes;
+    Index _nodeCapacity;
+    Index _edgeCapacity;
+    Index _nodeCount;
+    Index _edgeCount;
+    bool _stable;
+
+    // Node fields.  Wider fields come first so every array is aligned.
+    uint64_t* _stableHashes;
+    llvm::Instruction** _instructions;
+    int* _ids;
+    StringTable::Id* _labels;
+    StringTable::Id* _names;
+    unsigned int* _stableSuffixes;
+    // _edgeOffsets[n] to _edgeOffsets[n + 1] are the edges leaving node n.
+    Index* _edgeOffsets;
+    unsigned char* _types;
+    // Edge fields.  Targets hold internal node ids until finish.
+    double* _edgeWeights;
+    Index* _edgeTargets;
+    StringTable::Id* _edgeLabels;
+};
+
+#endif 	    /* !GRAPH_H_ */
@@ -0,0 +1,447 @@
+#include "GraphBuilder.h"
+
+#include "llvm/Instructions.h"
+
+#include "Accounting.h"
+#include "LabelRenderer.h"
+
+#include <set>
+#include <sstream>
+#include <stdlib.h>
+#include <sys/time.h>
+
+using namespace llvm;
+
+/**
+ * Collects every block reachable from the supplied block.
+ * @param entry The block to start from.
+ * @param followUnwind false to not follow the unwind edges of invokes.
+ * @param reached Receives the blocks reached, including entry.
+ */
+static void
+collectReachable(BasicBlock* entry, bool followUnwind, std::set<BasicBlock*>& reached)
+{
+    std::vector<BasicBlock*> pending;
+    pending.push_back(entry);
+    reached.insert(entry);
+
+    while (!pending.empty()) {
+        BasicBlock* bblock = pending.back();
+        pending.pop_back();
+
+        TerminatorInst* terminator = bblock->getTerminator();
+        if (terminator == NULL) {
+            continue;
+        }
+        for (unsigned int i = 0; i < terminator->getNumSuccessors(); i++) {
+            // Successor 1 of an invoke is its unwind destination.
+            if (!followUnwind && i == 1 && isa<InvokeInst>(terminator)) {
+                continue;
+            }
+            if (reached.insert(terminator->getSuccessor(i)).second) {
+                pending.push_back(terminator->getSuccessor(i));
+            }
+        }
+    }
+}
+
+/**
+ * @return The current wall clock time in milliseconds.
+ */
+static double
+currentMillis()
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec * 1000.0 + now.tv_usec / 1000.0;
+}
+
+GraphBuilder::Options::Options() :
+    maxInstructions(0),
+    maxNodes(0),
+    maxMillis(0),
+    unwind(KeepUnwind),
+    profile(NULL),
+    coldThreshold(0),
+    summarizeBlocks(false)
+{
+}
+
+GraphBuilder::GraphBuilder(const Options& options) :
+    _options(options),
+    _strings(NULL),
+    _nodeId(0),
+    _startNodeId(-1),
+    _displayedNodes(0),
+    _buildStart(0)
+{
+    _statistics = Statistics();
+}
+
+std::string
+GraphBuilder::getFunctionLabel(const Function& function)
+{
+    std::string functionLabel = function.getName();
+    std::string demangledLabel = LabelRenderer::getDemangledName(functionLabel);
+
+    if (demangledLabel == functionLabel ||
+        demangledLabel.length() == 0) {
+        functionLabel = function.getReturnType()->getDescription() + " " + functionLabel;
+        functionLabel = functionLabel + "(";
+        for (Function::const_arg_iterator arg = function.arg_begin();
+             arg != function.arg_end();
+             arg++) {
+            if (arg != function.arg_begin()) {
+                functionLabel = functionLabel + ", ";
+            }
+            functionLabel = functionLabel + arg->getType()->getDescription() + " " + std::string(arg->getName());
+        }
+        functionLabel = functionLabel + ")";
+    } else {
+        functionLabel = demangledLabel;
+    }
+
+    return functionLabel;
+}
+
+std::string
+GraphBuilder::build(const Function& function, Graph& graph)
+{
+    // LLVM 2.7 has no const accessors for the blocks and instructions
+    // of a function, but nothing here changes them.
+    Function& F = const_cast<Function&>(function);
+
+    // Everything is reset per function.  Labels are interned in the
+    // table of the graph, which the nodes are copied into.
+    _strings = &graph.getStrings();
+    _nodeId = 0;
+    _startNodeId = -1;
+    _statistics = Statistics();
+    _degradeReason.clear();
+    _displayedNodes = 0;
+    _buildStart = currentMillis();
+    release();
+    _blockSummaries.clear();
+    graph.release();
+
+    std::string functionLabel = getFunctionLabel(function);
+
+    if (_options.maxInstructions > 0) {
+        unsigned int instructions = 0;
+        for (Function::iterator bblock = F.begin();
+             bblock != F.end();
+             bblock++) {
+            instructions += bblock->size();
+        }
+        if (instructions > _options.maxInstructions) {
+            std::ostringstream reason;
+            reason << instructions << " instructions, over the budget of "
+                   << _options.maxInstructions;
+            _degradeReason = reason.str();
+            return functionLabel;
+        }
+    }
+
+    // Cold blocks all share a single block holding only the elided
+    // marker, so edges into any of them resolve to that marker.
+    pBlock coldBlock;
+
+    // Exception paths are the blocks reachable from the entry, but only
+    // by way of an unwind edge.  Unreachable blocks aren't among them.
+    // Collapsed, they share a single marker block like cold blocks;
+    // dropped, they aren't mapped at all, so unwind edges find nothing to
+    // point to and are left out.
+    std::set<BasicBlock*> exceptional;
+    pBlock exceptionBlock;
+    if (_options.unwind != KeepUnwind && !F.isDeclaration()) {
+        std::set<BasicBlock*> normal;
+        collectReachable(F.begin(), false, normal);
+        collectReachable(F.begin(), true, exceptional);
+        for (std::set<BasicBlock*>::iterator it = normal.begin();
+             it != normal.end();
+             it++) {
+            exceptional.erase(*it);
+        }
+    }
+
+    // Each block in the function needs to be processed and added to
+    // the mapping.
+    for (Function::iterator bblock = F.begin();
+         bblock != F.end();
+         bblock++) {
+        if (exceptional.count(bblock) > 0) {
+            if (_options.unwind == DropUnwind) {
+                continue;
+            }
+            if (exceptionBlock == NULL) {
+                exceptionBlock = Accounting::share(new Block(*_strings, _nodeId++, "exception"));
+                pNode node(Accounting::share(new Node(*_strings, _nodeId++, Node::ELIDED)));
+                node->setNodeLabel("exception exit");
+                exceptionBlock->appendNode(node);
+                _blockList.push_back(exceptionBlock);
+            }
+            _blocks.insert(std::pair<BasicBlock*, pBlock>(bblock, exceptionBlock));
+            continue;
+        }
+
+        if (bblock != F.begin() && isCold(bblock)) {
+            if (coldBlock == NULL) {
+                coldBlock = Accounting::share(new Block(*_strings, _nodeId++, "cold"));
+                pNode node(Accounting::share(new Node(*_strings, _nodeId++, Node::ELIDED)));
+                node->setNodeLabel("cold paths elided");
+                coldBlock->appendNode(node);
+                _blockList.push_back(coldBlock);
+            }
+            _blocks.insert(std::pair<BasicBlock*, pBlock>(bblock, coldBlock));
+            continue;
+        }
+
+        pBlock block(Accounting::share(new Block(*_strings, _nodeId++, bblock->getName())));
+        _blocks.insert(std::pair<BasicBlock*, pBlock>(bblock, block));
+        _blockList.push_back(block);
+
+        if (bblock == F.begin()) {
+            pNode node(Accounting::share(new Node(*_strings, _nodeId++)));
+            block->appendNode(node);
+            node->setNodeLabel(functionLabel);
+            node->setNodeType(Node::START);
+            _startNodeId = node->getNodeId();
+        }
+        processBlock(bblock, block);
+        if (!_degradeReason.empty()) {
+            release();
+            return functionLabel;
+        }
+    }
+
+    // Each block needs to process its contained nodes and we need to
+    // keep a local copy of each node for later processing.  Blocks are
+    // walked in function order (not _blocks order, which depends on
+    // where the BasicBlocks happened to be allocated) so the emitted
+    // file is the same on every run.  The budgets are checked before
+    // every block; since _resolved lets each chain of blocks be walked
+    // only once, no single block can run long past them.
+    for (std::vector<pBlock>::iterator it = _blockList.begin();
+         it != _blockList.end();
+         it++) {
+        if (exceedsBudget()) {
+            release();
+            return functionLabel;
+        }
+        (*it)->processNodes(_blocks, _resolved);
+        Nodes nodes = (*it)->getNodes();
+        for (Nodes::iterator node = nodes.begin();
+             node != nodes.end();
+             node++) {
+            _pnodes.push_back(*node);
+        }
+    }
+
+    if (_options.profile != NULL) {
+        applyProfile();
+    }
+
+    freeze(graph);
+
+    return functionLabel;
+}
+
+void
+GraphBuilder::freeze(Graph& graph)
+{
+    // The level of detail graphs need to know where each block leads,
+    // which can't be worked out once the blocks are gone.
+    if (_options.summarizeBlocks) {
+        for (BlockMap::iterator it = _blocks.begin();
+             it != _blocks.end();
+             it++) {
+            BlockSummary summary;
+            summary.id = it->second->getId();
+            summary.label = it->second->getLabel();
+            summary.entry = it->second->findEdge(it->first, _blocks, _resolved);
+            _blockSummaries.insert(std::pair<BasicBlock*, BlockSummary>(it->first, summary));
+        }
+    }
+
+    // Sized exactly up front, so the graph is a single allocation.
+    Graph::Index nodes = 0;
+    Graph::Index edges = 0;
+    for (Nodes::iterator it = _pnodes.begin();
+         it != _pnodes.end();
+         it++) {
+        if ((*it) != NULL && (*it)->getNodeLabel().length() > 0) {
+            nodes++;
+            edges += (*it)->getNodeEdges().size();
+        }
+    }
+
+    graph.reset(nodes, edges);
+    for (Nodes::iterator it = _pnodes.begin();
+         it != _pnodes.end();
+         it++) {
+        if ((*it) == NULL || (*it)->getNodeLabel().length() == 0) {
+            continue;
+        }
+
+        // If a node doesn't have any edges to follow (remember, this
+        // is a directed graph), it must be an end node.
+        std::vector<Edge*> nodeEdges = (*it)->getNodeEdges();
+        Node::Type type = (*it)->getNodeType();
+        if (nodeEdges.size() == 0 && type != Node::ELIDED) {
+            type = Node::END;
+        }
+        graph.addNode((*it)->getNodeId(), type, (*it)->getNodeLabelId(),
+                       (*it)->getNodeNameId(), (*it)->getInstruction());
+
+        for (std::vector<Edge*>::iterator edge = nodeEdges.begin();
+             edge != nodeEdges.end();
+             edge++) {
+            // Edges hold the id of the node they lead to as text.
+            const std::string& target = (*edge)->getId();
+            char* end;
+            long value = strtol(target.c_str(), &end, 10);
+            if (target.empty() || *end != '\0') {
+                continue;
+            }
+            graph.addEdge(static_cast<int>(value), (*edge)->getLabelId(), (*edge)->getWeight());
+        }
+    }
+    graph.finish();
+    graph.assignStableIds();
+
+    // Nothing reads the nodes and blocks once the graph is frozen, so
+    // they are freed before anything is written.
+    release();
+}
+
+void
+GraphBuilder::release()
+{
+    _blocks.clear();
+    _blockList.clear();
+    _pnodes.clear();
+    _resolved.clear();
+}
+
+bool
+GraphBuilder::isCold(BasicBlock* bblock)
+{
+    if (_options.profile == NULL || _options.coldThreshold == 0) {
+        return false;
+    }
+
+    // Blocks the profile has no data for are always kept.
+    double count = _options.profile->getExecutionCount(bblock);
+    return count != ProfileInfo::MissingValue && count < _options.coldThreshold;
+}
+
+void
+GraphBuilder::applyProfile()
+{
+    // Edges leaving a block carry the label of the successor they lead
+    // to (true/false, case values, ...) and get the weight of that CFG
+    // edge.  Every other edge stays within its block and is taken as
+    // often as the block executes.
+    for (Nodes::iterator it = _pnodes.begin();
+         it != _pnodes.end();
+         it++) {
+        if ((*it) == NULL || (*it)->getInstruction() == NULL) {
+            continue;
+        }
+
+        BasicBlock* parent = (*it)->getInstruction()->getParent();
+        std::map<std::string, BasicBlock*> successors = (*it)->getBlockEdges();
+        std::vector<Edge*> edges = (*it)->getNodeEdges();
+
+        for (std::vector<Edge*>::iterator edge = edges.begin();
+             edge != edges.end();
+             edge++) {
+            std::map<std::string, BasicBlock*>::iterator successor =
+                successors.find((*edge)->getLabel());
+            double weight;
+            if (successor != successors.end()) {
+                weight = _options.profile->getEdgeWeight(ProfileInfo::getEdge(parent, successor->second));
+            } else {
+                weight = _options.profile->getExecutionCount(parent);
+            }
+
+            if (weight != ProfileInfo::MissingValue) {
+                (*edge)->setWeight(weight);
+            }
+        }
+    }
+}
+
+void
+GraphBuilder::processBlock(BasicBlock* bblock, pBlock block)
+{
+    // Create a node for each instruction in the block and append it
+    // to the block.
+    for (BasicBlock::iterator instruction = bblock->begin();
+         instruction != bblock->end();
+         instruction++) {
+        pNode node(Accounting::share(new Node(*_strings, _nodeId++)));
+        block->appendNode(node);
+        processInstruction(instruction, node);
+        if (exceedsBudget()) {
+            return;
+        }
+    }
+}
+
+bool
+GraphBuilder::exceedsBudget()
+{
+    if (!_degradeReason.empty()) {
+        return true;
+    }
+    // Labels interned once the table is full come out empty, so the
+    // graph can't be trusted.
+    if (_strings->isFull()) {
+        _degradeReason = "too many distinct labels in the string table";
+        return true;
+    }
+    // Called after every instruction, so the common case of no budget
+    // returns straight away and the reason is only built once exceeded.
+    if (_options.maxNodes == 0 && _options.maxMillis == 0) {
+        return false;
+    }
+
+    if (_options.maxNodes > 0 && _displayedNodes > _options.maxNodes) {
+        std::ostringstream reason;
+        reason << "more than " << _options.maxNodes << " nodes";
+        _degradeReason = reason.str();
+        return true;
+    }
+    if (_options.maxMillis > 0 && currentMillis() - _buildStart > _options.maxMillis) {
+        std::ostringstream reason;
+        reason << "took more than " << _options.maxMillis << " ms";
+        _degradeReason = reason.str();
+        return true;
+    }
+    return false;
+}
+
+void
+GraphBuilder::processInstruction(Instruction* instruction, pNode node)
+{
+    // Assign the instruction and generate the node label.
+    node->setInstruction(instruction);
+    node->setNodeLabel(LabelRenderer::render(instruction));
+    if (node->getNodeLabel().length() > 0) {
+        _displayedNodes++;
+    }
+
+    _statistics.instructions++;
+    if (isa<CallInst>(instruction) || isa<InvokeInst>(instruction)) {
+        _statistics.calls++;
+    } else if (SwitchInst* switchInstruction = dyn_cast<SwitchInst>(instruction)) {
+        std::set<BasicBlock*> destinations;
+        for (unsigned int i = 0; i < switchInstruction->getNumSuccessors(); i++) {
+            destinations.insert(switchInstruction->getSuccessor(i));
+        }
+        if (destinations.size() > _statistics.maxSwitchFanOut) {
+            _statistics.maxSwitchFanOut = destinations.size();
+        }
+    }
+}
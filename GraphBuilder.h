@@ -0,0 +1,211 @@
+/*
+** GraphBuilder.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	GRAPHBUILDER_H_
+# define   	GRAPHBUILDER_H_
+
+#include "Block.h"
+#include "Graph.h"
+#include "Node.h"
+
+#include "llvm/Function.h"
+#include "llvm/Analysis/ProfileInfo.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Builds the Graph of a single function.  This is the core of RocketShip:
+ * it needs no pass manager, reads no command line options and touches no
+ * files, so tools can call it directly on modules they already have
+ * loaded.  The RocketShip pass is a wrapper writing its graphs out.
+ *
+ * A builder only keeps state for the function being built, so one
+ * builder can build any number of functions in turn.  Strings are
+ * interned in the StringTable of the graph built, so builders given
+ * graphs with separate tables share nothing of their own, and clearing
+ * one table can't invalidate the ids of another.  Builders can run on
+ * separate threads, even sharing a table, as long as no table is cleared
+ * while in use, with two process-wide exceptions: instructions are
+ * labelled through the LabelRenderer tables, which must not be changed
+ * while any builder runs, and allocations are counted in the Accounting
+ * totals, which every thread adds to.
+ */
+class GraphBuilder {
+public:
+    /**
+     * How the exception paths of invoke instructions are drawn.  Blocks
+     * only reachable through the unwind destination of an invoke (landing
+     * pads, cleanups, rethrows) are either kept, all replaced by a single
+     * "exception exit" node, or left out along with the unwind edges.
+     */
+    enum UnwindMode {
+        KeepUnwind,
+        CollapseUnwind,
+        DropUnwind
+    };
+
+    /**
+     * What to build.  The defaults build the full graph without limits.
+     */
+    struct Options {
+        Options();
+
+        // Functions with more instructions than this aren't built; those
+        // growing more displayed nodes or taking longer than this many
+        // milliseconds are abandoned part way.  0 means unlimited.
+        unsigned int maxInstructions;
+        unsigned int maxNodes;
+        unsigned int maxMillis;
+        UnwindMode unwind;
+        // The execution profile to label edges with, or NULL.
+        llvm::ProfileInfo* profile;
+        // With a profile, blocks executed fewer times than this are
+        // replaced by a single "cold paths elided" node.
+        unsigned int coldThreshold;
+        // Whether to keep a BlockSummary of every block.
+        bool summarizeBlocks;
+    };
+
+    /**
+     * A block of the function, as seen once the graph is built.
+     */
+    struct BlockSummary {
+        // The internal id of the Block.
+        unsigned int id;
+        // The label of the Block.
+        std::string label;
+        // The internal id of the first displayed node reached from the
+        // block, or -1.
+        int entry;
+    };
+    typedef std::map<llvm::BasicBlock*, BlockSummary> BlockSummaries;
+
+    /**
+     * Figures gathered from the instructions while building.
+     */
+    struct Statistics {
+        // The number of instructions processed.
+        unsigned int instructions;
+        // The number of call and invoke instructions.
+        unsigned int calls;
+        // The most distinct destinations of any switch instruction.
+        unsigned int maxSwitchFanOut;
+    };
+
+    /**
+     * Constructor.
+     * @param options What to build.
+     */
+    GraphBuilder(const Options& options = Options());
+
+    /**
+     * Builds the graph of a function, replacing the contents of graph.  If
+     * the function goes over budget, or the string table of graph is
+     * full, graph is left empty and getDegradeReason says why.
+     * Instructions are only read.
+     * @param function The function to build the graph of.
+     * @param graph Receives the displayed nodes and edges, with stable ids.
+     * @return The label for the start node of the function.
+     */
+    std::string build(const llvm::Function& function, Graph& graph);
+
+    /**
+     * @return Why the last function built went over budget, or an empty
+     * string if it didn't.
+     */
+    const std::string& getDegradeReason() const { return _degradeReason; }
+    /**
+     * @return The internal id of the start node of the last function
+     * built, or -1 if it has none.
+     */
+    int getStartNodeId() const { return _startNodeId; }
+    /**
+     * @return The figures gathered for the last function built.
+     */
+    const Statistics& getStatistics() const { return _statistics; }
+    /**
+     * @return The summary of every block of the last function built, when
+     * Options::summarizeBlocks is set.  Blocks left out of the graph
+     * have no summary.
+     */
+    const BlockSummaries& getBlockSummaries() const { return _blockSummaries; }
+
+    /**
+     * @return The label of the start node of a function: its demangled
+     * name, or its signature if it isn't a C++ symbol.
+     */
+    static std::string getFunctionLabel(const llvm::Function& function);
+private:
+    /**
+     * Generates the nodes for a block.  This processes a single block
+     * at a time.
+     * @param bblock The LLVM representation of the block to process.
+     * @param block The internal representation of the block.
+     */
+    void processBlock(llvm::BasicBlock* bblock, pBlock block);
+    /**
+     * Populates node data based on the supplied instruction.
+     * @param instruction The LLVM representation of the instruction to process.
+     * @param node The internal representation of a node to track.
+     */
+    void processInstruction(llvm::Instruction* instruction, pNode node);
+    /**
+     * Checks the node and time budgets of the function being built,
+     * setting _degradeReason once either is exceeded.
+     * @return true if the function is over budget.
+     */
+    bool exceedsBudget();
+    /**
+     * Determines whether a block executed fewer times than the cold
+     * threshold in the profile.
+     * @param bblock The block to check.
+     */
+    bool isCold(llvm::BasicBlock* bblock);
+    /**
+     * Annotates every edge of the current nodes with the number of times
+     * it was taken in the profile.
+     */
+    void applyProfile();
+    /**
+     * Copies the displayed nodes and their edges into graph, with stable
+     * ids, and frees the nodes and blocks they came from.  Both are held
+     * at once while copying, which adds the graph to the peak memory of
+     * the build.
+     */
+    void freeze(Graph& graph);
+    /**
+     * Frees the nodes and blocks of the function being built.
+     */
+    void release();
+
+    Options _options;
+    // The table of the graph being built, which every label is interned in.
+    StringTable* _strings;
+    // The nodes of the function, in function order.
+    Nodes _pnodes;
+    // The Block of every BasicBlock.  Only used for lookups, never
+    // iterated for output, since the order of pointer keys changes from
+    // run to run.
+    BlockMap _blocks;
+    // The blocks in the order they appear in the function.
+    std::vector<pBlock> _blockList;
+    // The first displayed node reached from each block, as resolved so far.
+    ResolvedEdges _resolved;
+    // The next id to use for a node or block.
+    int _nodeId;
+    int _startNodeId;
+    std::string _degradeReason;
+    // The number of nodes with a label built so far.
+    unsigned int _displayedNodes;
+    // When building started, in milliseconds.
+    double _buildStart;
+    Statistics _statistics;
+    BlockSummaries _blockSummaries;
+};
+
+#endif 	    /* !GRAPHBUILDER_H_ */
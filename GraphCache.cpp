@@ -0,0 +1,85 @@
+#include "GraphCache.h"
+
+GraphCache::GraphCache(size_t maxBytes) :
+    _maxBytes(maxBytes),
+    _bytes(0)
+{
+}
+
+bool
+GraphCache::lookup(const std::string& module, const std::string& function, std::string& graph)
+{
+    std::map<Key, Entries::iterator>::iterator found = _index.find(Key(module, function));
+    if (found == _index.end()) {
+        return false;
+    }
+
+    // Moving the entry to the front doesn't invalidate the iterator
+    // held by the index.
+    _entries.splice(_entries.begin(), _entries, found->second);
+    graph = found->second->graph;
+    return true;
+}
+
+void
+GraphCache::insert(const std::string& module, const std::string& function, const std::string& graph)
+{
+    std::map<Key, Entries::iterator>::iterator found = _index.find(Key(module, function));
+    if (found != _index.end()) {
+        erase(found->second);
+    }
+
+    Entry entry;
+    entry.key = Key(module, function);
+    entry.graph = graph;
+    size_t size = getSize(entry);
+    if (size > _maxBytes) {
+        return;
+    }
+
+    while (_bytes + size > _maxBytes && !_entries.empty()) {
+        erase(--_entries.end());
+    }
+
+    _entries.push_front(entry);
+    _index.insert(std::pair<Key, Entries::iterator>(entry.key, _entries.begin()));
+    _bytes += size;
+}
+
+void
+GraphCache::invalidate(const std::string& module)
+{
+    // Keys sort by module first, so the module's entries are adjacent.
+    std::map<Key, Entries::iterator>::iterator it = _index.lower_bound(Key(module, ""));
+    while (it != _index.end() && it->first.first == module) {
+        Entries::iterator entry = it->second;
+        it++;
+        erase(entry);
+    }
+}
+
+size_t
+GraphCache::size()
+{
+    return _entries.size();
+}
+
+size_t
+GraphCache::getBytes()
+{
+    return _bytes;
+}
+
+size_t
+GraphCache::getSize(const Entry& entry)
+{
+    return entry.key.first.length() + entry.key.second.length() + entry.graph.length();
+}
+
+void
+GraphCache::erase(Entries::iterator entry)
+{
+    _bytes -= getSize(*entry);
+    _index.erase(entry->key);
+    _entries.erase(entry);
+}
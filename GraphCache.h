@@ -0,0 +1,87 @@
+/*
+** GraphCache.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	GRAPHCACHE_H_
+# define   	GRAPHCACHE_H_
+
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+
+/**
+ * Holds rendered function graphs, keyed by module and function, up to a
+ * total size.  Once full, the least recently used graphs are evicted to
+ * make room.  All graphs of a module can be dropped at once when the
+ * module changes.
+ */
+class GraphCache {
+public:
+    /**
+     * Constructor, creates an empty cache.
+     * @param maxBytes The most bytes of graph text (and keys) to hold.
+     */
+    GraphCache(size_t maxBytes);
+
+    /**
+     * Looks up a graph, making it the most recently used.
+     * @param module The module the function belongs to.
+     * @param function The name of the function.
+     * @param graph Receives the graph if it was found.
+     * @return true if the graph was found.
+     */
+    bool lookup(const std::string& module, const std::string& function, std::string& graph);
+    /**
+     * Adds or replaces a graph, evicting others as needed.  A graph
+     * larger than the whole cache isn't held.
+     * @param module The module the function belongs to.
+     * @param function The name of the function.
+     * @param graph The rendered graph.
+     */
+    void insert(const std::string& module, const std::string& function, const std::string& graph);
+    /**
+     * Drops every graph of a module.
+     * @param module The module whose graphs are out of date.
+     */
+    void invalidate(const std::string& module);
+
+    /**
+     * @return The number of graphs held.
+     */
+    size_t size();
+    /**
+     * @return The number of bytes held.
+     */
+    size_t getBytes();
+private:
+    typedef std::pair<std::string, std::string> Key;
+
+    /**
+     * A cached graph.
+     */
+    struct Entry {
+        Key key;
+        std::string graph;
+    };
+    // Entries, most recently used first.
+    typedef std::list<Entry> Entries;
+
+    /**
+     * @return The number of bytes an entry accounts for.
+     */
+    static size_t getSize(const Entry& entry);
+    /**
+     * Removes an entry.
+     */
+    void erase(Entries::iterator entry);
+
+    size_t _maxBytes;
+    size_t _bytes;
+    Entries _entries;
+    std::map<Key, Entries::iterator> _index;
+};
+
+#endif 	    /* !GRAPHCACHE_H_ */
@@ -0,0 +1,253 @@
+#include "GraphDiff.h"
+
+#include <algorithm>
+#include <ctype.h>
+
+// The attributes added to highlight each kind of change.
+static const char* AddedStyle = "color=green fontcolor=green";
+static const char* ChangedStyle = "color=orange fontcolor=orange";
+static const char* RemovedStyle = "color=red fontcolor=red style=dashed";
+
+void
+GraphDiff::readPrevious(std::istream& in)
+{
+    read(in, _previous);
+}
+
+void
+GraphDiff::readCurrent(std::istream& in)
+{
+    read(in, _current);
+}
+
+bool
+GraphDiff::isChanged()
+{
+    return getChangedNodes() > 0 || getChangedEdges() > 0;
+}
+
+unsigned int
+GraphDiff::getChangedNodes()
+{
+    unsigned int changed = 0;
+    for (std::map<std::string, std::string>::iterator it = _current.nodes.begin();
+         it != _current.nodes.end();
+         it++) {
+        std::map<std::string, std::string>::iterator previous = _previous.nodes.find(it->first);
+        if (previous == _previous.nodes.end() || previous->second != it->second) {
+            changed++;
+        }
+    }
+    for (std::map<std::string, std::string>::iterator it = _previous.nodes.begin();
+         it != _previous.nodes.end();
+         it++) {
+        if (_current.nodes.find(it->first) == _current.nodes.end()) {
+            changed++;
+        }
+    }
+    return changed;
+}
+
+unsigned int
+GraphDiff::getChangedEdges()
+{
+    unsigned int changed = 0;
+    for (std::map<EdgeKey, std::string>::iterator it = _current.edges.begin();
+         it != _current.edges.end();
+         it++) {
+        std::map<EdgeKey, std::string>::iterator previous = _previous.edges.find(it->first);
+        if (previous == _previous.edges.end() || previous->second != it->second) {
+            changed++;
+        }
+    }
+    for (std::map<EdgeKey, std::string>::iterator it = _previous.edges.begin();
+         it != _previous.edges.end();
+         it++) {
+        if (_current.edges.find(it->first) == _current.edges.end()) {
+            changed++;
+        }
+    }
+    return changed;
+}
+
+void
+GraphDiff::write(std::ostream& out)
+{
+    for (std::vector<std::string>::iterator id = _current.nodeOrder.begin();
+         id != _current.nodeOrder.end();
+         id++) {
+        std::string& attributes = _current.nodes[*id];
+        std::map<std::string, std::string>::iterator previous = _previous.nodes.find(*id);
+        if (previous == _previous.nodes.end()) {
+            writeStatement(out, *id, attributes, AddedStyle);
+        } else if (previous->second != attributes) {
+            writeStatement(out, *id, attributes, ChangedStyle);
+        } else {
+            writeStatement(out, *id, attributes, "");
+        }
+    }
+
+    // An edge whose attributes changed is shown both ways: the old ones
+    // as removed and the new ones as added.  One whose label changed is
+    // a different edge, so it is shown that way as well.
+    for (std::vector<EdgeKey>::iterator key = _current.edgeOrder.begin();
+         key != _current.edgeOrder.end();
+         key++) {
+        std::string& attributes = _current.edges[*key];
+        std::string statement = key->first.first + " -> " + key->first.second;
+        std::map<EdgeKey, std::string>::iterator previous = _previous.edges.find(*key);
+        if (previous == _previous.edges.end()) {
+            writeStatement(out, statement, attributes, AddedStyle);
+        } else if (previous->second != attributes) {
+            writeStatement(out, statement, previous->second, RemovedStyle);
+            writeStatement(out, statement, attributes, AddedStyle);
+        } else {
+            writeStatement(out, statement, attributes, "");
+        }
+    }
+
+    for (std::vector<std::string>::iterator id = _previous.nodeOrder.begin();
+         id != _previous.nodeOrder.end();
+         id++) {
+        if (_current.nodes.find(*id) == _current.nodes.end()) {
+            writeStatement(out, *id, _previous.nodes[*id], RemovedStyle);
+        }
+    }
+    for (std::vector<EdgeKey>::iterator key = _previous.edgeOrder.begin();
+         key != _previous.edgeOrder.end();
+         key++) {
+        if (_current.edges.find(*key) == _current.edges.end()) {
+            writeStatement(out, key->first.first + " -> " + key->first.second,
+                           _previous.edges[*key], RemovedStyle);
+        }
+    }
+}
+
+void
+GraphDiff::read(std::istream& in, Snapshot& snapshot)
+{
+    std::string line;
+    int depth = 0;
+
+    while (std::getline(in, line)) {
+        std::string::size_type position = 0;
+
+        // Expanded callees are written as clusters; only the function's
+        // own statements are compared.
+        if (line.compare(0, 9, "subgraph ") == 0) {
+            depth++;
+            continue;
+        }
+        if (line.compare(0, 1, "}") == 0) {
+            if (depth > 0) {
+                depth--;
+            }
+            continue;
+        }
+        if (depth > 0 || line.compare(0, 8, "digraph ") == 0) {
+            continue;
+        }
+
+        std::string from = readIdentifier(line, position);
+        if (from.empty()) {
+            continue;
+        }
+        while (position < line.length() && line[position] == ' ') {
+            position++;
+        }
+
+        std::string to;
+        if (line.compare(position, 2, "->") == 0) {
+            position += 2;
+            while (position < line.length() && line[position] == ' ') {
+                position++;
+            }
+            to = readIdentifier(line, position);
+            if (to.empty()) {
+                continue;
+            }
+            while (position < line.length() && line[position] == ' ') {
+                position++;
+            }
+        }
+
+        // Labels may contain brackets, so the attributes run to the last
+        // ']' on the line.
+        std::string attributes;
+        std::string::size_type end = line.rfind(']');
+        if (position < line.length() && line[position] == '[' &&
+            end != std::string::npos && end > position) {
+            attributes = line.substr(position + 1, end - position - 1);
+        }
+
+        if (to.empty()) {
+            if (snapshot.nodes.insert(std::pair<std::string, std::string>(from, attributes)).second) {
+                snapshot.nodeOrder.push_back(from);
+            }
+        } else {
+            EdgeKey key(EdgeEnds(from, to), readLabel(attributes));
+            if (snapshot.edges.insert(std::pair<EdgeKey, std::string>(key, attributes)).second) {
+                snapshot.edgeOrder.push_back(key);
+            }
+        }
+    }
+
+    // Edges into clusters lead to nodes that weren't read.
+    std::vector<EdgeKey> kept;
+    for (std::vector<EdgeKey>::iterator key = snapshot.edgeOrder.begin();
+         key != snapshot.edgeOrder.end();
+         key++) {
+        if (snapshot.nodes.find(key->first.first) != snapshot.nodes.end() &&
+            snapshot.nodes.find(key->first.second) != snapshot.nodes.end()) {
+            kept.push_back(*key);
+        } else {
+            snapshot.edges.erase(*key);
+        }
+    }
+    snapshot.edgeOrder.swap(kept);
+}
+
+std::string
+GraphDiff::readIdentifier(const std::string& line, std::string::size_type& position)
+{
+    std::string::size_type start = position;
+    while (position < line.length() &&
+           (isalnum(static_cast<unsigned char>(line[position])) || line[position] == '_')) {
+        position++;
+    }
+    return line.substr(start, position - start);
+}
+
+std::string
+GraphDiff::readLabel(const std::string& attributes)
+{
+    std::string::size_type start = attributes.find("label=\"");
+    if (start == std::string::npos) {
+        return "";
+    }
+    start += 7;
+
+    std::string::size_type end = start;
+    while (end < attributes.length() && attributes[end] != '"') {
+        // Skip over escaped quotes and backslashes.
+        if (attributes[end] == '\\') {
+            end++;
+        }
+        end++;
+    }
+    return attributes.substr(start, std::min(end, attributes.length()) - start);
+}
+
+void
+GraphDiff::writeStatement(std::ostream& out, const std::string& statement,
+                          const std::string& attributes, const std::string& extra)
+{
+    out << statement << " [" << attributes;
+    if (!extra.empty()) {
+        if (!attributes.empty()) {
+            out << " ";
+        }
+        out << extra;
+    }
+    out << "]\n";
+}
@@ -0,0 +1,107 @@
+/*
+** GraphDiff.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	GRAPHDIFF_H_
+# define   	GRAPHDIFF_H_
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Compares two versions of a function graph as written by RocketShip and
+ * writes the newer version with what changed highlighted: added nodes and
+ * edges in green, nodes whose attributes changed in orange, and removed
+ * nodes and edges in red (dashed).
+ *
+ * Graphs are read back from the DOT statements RocketShip emits, one per
+ * line: "id [attributes]" for nodes and "from -> to[attributes]" for
+ * edges.  Nodes are matched by id, so the ids have to be stable between
+ * runs.  RocketShip derives them from node labels, so a node whose label
+ * changed shows as removed and added rather than changed.  Edges are
+ * matched by their ends and label, so that several edges between the same
+ * nodes (the cases of a switch, say) are told apart.  Clusters of expanded
+ * callees are skipped, along with the edges leading into them.
+ */
+class GraphDiff {
+public:
+    /**
+     * Reads the previous version of the graph.
+     * @param in The DOT text of the previous graph.
+     */
+    void readPrevious(std::istream& in);
+    /**
+     * Reads the current version of the graph.
+     * @param in The DOT text of the current graph.
+     */
+    void readCurrent(std::istream& in);
+
+    /**
+     * @return true if any node or edge was added, removed or changed.
+     */
+    bool isChanged();
+    /**
+     * @return The number of nodes added, removed or changed.
+     */
+    unsigned int getChangedNodes();
+    /**
+     * @return The number of edges added, removed or changed.
+     */
+    unsigned int getChangedEdges();
+
+    /**
+     * Writes the statements of the current graph followed by those only
+     * in the previous graph, highlighted as described above.  The
+     * enclosing "digraph name { ... }" is left to the caller.
+     * @param out The stream to write to.
+     */
+    void write(std::ostream& out);
+private:
+    typedef std::pair<std::string, std::string> EdgeEnds;
+    /**
+     * Identifies an edge: its ends and its label.
+     */
+    typedef std::pair<EdgeEnds, std::string> EdgeKey;
+
+    /**
+     * The nodes and edges of one version of the graph, with their
+     * attributes as written in the file.
+     */
+    struct Snapshot {
+        std::vector<std::string> nodeOrder;
+        std::map<std::string, std::string> nodes;
+        std::vector<EdgeKey> edgeOrder;
+        std::map<EdgeKey, std::string> edges;
+    };
+
+    /**
+     * Parses the DOT text into a snapshot.
+     */
+    static void read(std::istream& in, Snapshot& snapshot);
+    /**
+     * Reads a DOT identifier starting at position, advancing past it.
+     * @return The identifier, empty if there isn't one at position.
+     */
+    static std::string readIdentifier(const std::string& line, std::string::size_type& position);
+    /**
+     * @return The value of the label attribute, still escaped, or an
+     * empty string if there is none.
+     */
+    static std::string readLabel(const std::string& attributes);
+    /**
+     * Writes a node or edge statement with extra attributes appended.
+     */
+    static void writeStatement(std::ostream& out, const std::string& statement,
+                               const std::string& attributes, const std::string& extra);
+
+    Snapshot _previous;
+    Snapshot _current;
+};
+
+#endif 	    /* !GRAPHDIFF_H_ */
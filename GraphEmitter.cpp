@@ -0,0 +1,44 @@
+#include "GraphEmitter.h"
+#include "Node.h"
+
+GraphEmitter::GraphEmitter(std::ostream& out) :
+    _out(out)
+{
+}
+
+GraphEmitter::~GraphEmitter()
+{
+}
+
+void
+GraphEmitter::emitNodes(const Graph& graph, const std::vector<GraphEmitter*>& emitters)
+{
+    // Nodes are the outer loop so each one is read once, however many
+    // formats it is written in.
+    for (Graph::Index node = 0; node < graph.size(); node++) {
+        for (std::vector<GraphEmitter*>::const_iterator it = emitters.begin();
+             it != emitters.end();
+             it++) {
+            (*it)->emitNode(graph, node);
+        }
+    }
+}
+
+const char*
+GraphEmitter::getTypeName(int type)
+{
+    switch (type) {
+    case Node::START:
+        return "start";
+    case Node::ACTIVITY:
+        return "activity";
+    case Node::DECISION:
+        return "decision";
+    case Node::END:
+        return "end";
+    case Node::ELIDED:
+        return "elided";
+    default:
+        return "unknown";
+    }
+}
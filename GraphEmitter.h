@@ -0,0 +1,68 @@
+/*
+** GraphEmitter.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	GRAPHEMITTER_H_
+# define   	GRAPHEMITTER_H_
+
+#include "Graph.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Writes a finished function Graph to a stream in some file format.
+ *
+ * A graph is written by beginGraph, then emitNode for every node in order,
+ * then endGraph.  Each call writes straight to the stream, so nothing is
+ * held back between nodes and several emitters can be fed from a single
+ * walk over the graph with emitNodes.
+ */
+class GraphEmitter {
+public:
+    /**
+     * Constructor.
+     * @param out The stream to write to.
+     */
+    GraphEmitter(std::ostream& out);
+    virtual ~GraphEmitter();
+
+    /**
+     * Writes whatever comes before the nodes.
+     * @param identifier The sanitized identifier of the function.
+     * @param label The label to display for the function.
+     */
+    virtual void beginGraph(const std::string& identifier, const std::string& label) = 0;
+    /**
+     * Writes a node and the edges leaving it.
+     * @param graph The graph being written.
+     * @param node The position of the node.
+     */
+    virtual void emitNode(const Graph& graph, Graph::Index node) = 0;
+    /**
+     * Writes whatever comes after the nodes.
+     */
+    virtual void endGraph() = 0;
+
+    /**
+     * Feeds every node of a graph to each of the emitters, in a single
+     * pass over the graph.
+     * @param graph The graph to write.
+     * @param emitters The emitters to write it with.
+     */
+    static void emitNodes(const Graph& graph, const std::vector<GraphEmitter*>& emitters);
+    /**
+     * @return The name of a Node::Type, e.g. "decision".
+     */
+    static const char* getTypeName(int type);
+protected:
+    std::ostream& _out;
+private:
+    GraphEmitter(const GraphEmitter&);
+    GraphEmitter& operator=(const GraphEmitter&);
+};
+
+#endif 	    /* !GRAPHEMITTER_H_ */
@@ -0,0 +1,103 @@
+#include "GraphMLEmitter.h"
+
+#include <stdint.h>
+
+GraphMLEmitter::GraphMLEmitter(std::ostream& out) :
+    GraphEmitter(out)
+{
+}
+
+void
+GraphMLEmitter::beginGraph(const std::string& identifier, const std::string& label)
+{
+    _out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+         << "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n"
+         << "<key id=\"glabel\" for=\"graph\" attr.name=\"label\" attr.type=\"string\"/>\n"
+         << "<key id=\"label\" for=\"node\" attr.name=\"label\" attr.type=\"string\"/>\n"
+         << "<key id=\"type\" for=\"node\" attr.name=\"type\" attr.type=\"string\"/>\n"
+         << "<key id=\"elabel\" for=\"edge\" attr.name=\"label\" attr.type=\"string\"/>\n"
+         << "<key id=\"weight\" for=\"edge\" attr.name=\"weight\" attr.type=\"long\"/>\n";
+    _out << "<graph id=\"";
+    writeEscaped(_out, identifier);
+    _out << "\" edgedefault=\"directed\">\n";
+    _out << "<data key=\"glabel\">";
+    writeEscaped(_out, label);
+    _out << "</data>\n";
+}
+
+void
+GraphMLEmitter::emitNode(const Graph& graph, Graph::Index node)
+{
+    _out << "<node id=\"";
+    graph.writeDotId(_out, node);
+    _out << "\"><data key=\"type\">" << getTypeName(graph.getType(node))
+         << "</data><data key=\"label\">";
+    writeEscaped(_out, graph.getLabel(node));
+    _out << "</data></node>\n";
+
+    for (Graph::Index edge = graph.getEdgesBegin(node);
+         edge < graph.getEdgesEnd(node);
+         edge++) {
+        _out << "<edge source=\"";
+        graph.writeDotId(_out, node);
+        _out << "\" target=\"";
+        graph.writeDotId(_out, graph.getEdgeTarget(edge));
+        _out << "\">";
+        if (graph.getEdgeLabel(edge).length() > 0) {
+            _out << "<data key=\"elabel\">";
+            writeEscaped(_out, graph.getEdgeLabel(edge));
+            _out << "</data>";
+        }
+        if (graph.getEdgeWeight(edge) >= 0) {
+            _out << "<data key=\"weight\">"
+                 << static_cast<uint64_t>(graph.getEdgeWeight(edge)) << "</data>";
+        }
+        _out << "</edge>\n";
+    }
+}
+
+void
+GraphMLEmitter::endGraph()
+{
+    _out << "</graph>\n</graphml>\n";
+}
+
+void
+GraphMLEmitter::writeEscaped(std::ostream& out, const std::string& value)
+{
+    std::string::size_type start = 0;
+    for (std::string::size_type i = 0; i < value.length(); i++) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        const char* escaped;
+        switch (c) {
+        case '&':
+            escaped = "&amp;";
+            break;
+        case '<':
+            escaped = "&lt;";
+            break;
+        case '>':
+            escaped = "&gt;";
+            break;
+        case '"':
+            escaped = "&quot;";
+            break;
+        case '\n':
+            escaped = "&#10;";
+            break;
+        case '\t':
+            escaped = "&#9;";
+            break;
+        default:
+            if (c >= 0x20) {
+                continue;
+            }
+            escaped = " ";
+        }
+
+        out.write(value.data() + start, i - start);
+        out << escaped;
+        start = i + 1;
+    }
+    out.write(value.data() + start, value.length() - start);
+}
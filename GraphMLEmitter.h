@@ -0,0 +1,40 @@
+/*
+** GraphMLEmitter.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	GRAPHMLEMITTER_H_
+# define   	GRAPHMLEMITTER_H_
+
+#include "GraphEmitter.h"
+
+/**
+ * Writes a graph as a GraphML document, for tools such as yEd, Gephi and
+ * networkx.  Nodes carry "label" and "type" data, edges "label" and, when
+ * profiled, "weight".  Each edge is written right after the node it
+ * leaves, which GraphML allows.
+ */
+class GraphMLEmitter : public GraphEmitter {
+public:
+    /**
+     * Constructor.
+     * @param out The stream to write to.
+     */
+    GraphMLEmitter(std::ostream& out);
+
+    virtual void beginGraph(const std::string& identifier, const std::string& label);
+    virtual void emitNode(const Graph& graph, Graph::Index node);
+    virtual void endGraph();
+
+    /**
+     * Writes text escaped for use in XML content and attribute values.
+     * Control characters other than newlines and tabs, which XML 1.0
+     * doesn't allow, become spaces.
+     * @param out The stream to write to.
+     * @param value The text to escape.
+     */
+    static void writeEscaped(std::ostream& out, const std::string& value);
+};
+
+#endif 	    /* !GRAPHMLEMITTER_H_ */
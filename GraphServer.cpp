@@ -0,0 +1,317 @@
+#include "GraphServer.h"
+#include "DotText.h"
+#include "OutputPaths.h"
+
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/Function.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace llvm;
+
+// The longest request accepted, to bound what a misbehaving client can
+// make the server buffer.
+static const size_t MaxRequestLength = 64 * 1024;
+// How long a client has to send its request and read its reply.
+static const int ClientTimeoutSeconds = 5;
+// The most modules loaded by the server kept at once.
+static const size_t MaxLoadedModules = 8;
+
+/**
+ * Writes all of data to a socket.
+ * @return true on success.
+ */
+static bool
+writeAll(int socket, const std::string& data)
+{
+    size_t written = 0;
+    while (written < data.length()) {
+        ssize_t result = write(socket, data.data() + written, data.length() - written);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return false;
+        }
+        written += result;
+    }
+    return true;
+}
+
+GraphServer::GraphServer(rocketship::RocketShip& renderer, size_t cacheBytes) :
+    _renderer(renderer),
+    _cache(cacheBytes),
+    _context(NULL),
+    _requests(0)
+{
+}
+
+GraphServer::~GraphServer()
+{
+    _renderer.resetCalleeGraphs();
+    for (std::map<std::string, LoadedModule>::iterator it = _modules.begin();
+         it != _modules.end();
+         it++) {
+        unload(it->second);
+    }
+}
+
+bool
+GraphServer::run(const std::string& socketPath, Module& module, std::string& error)
+{
+    struct sockaddr_un address;
+    if (socketPath.length() >= sizeof(address.sun_path)) {
+        error = "socket path too long: " + socketPath;
+        return false;
+    }
+
+    // The module the pass was run on is already loaded.
+    LoadedModule initial;
+    initial.module = &module;
+    getVersion(module.getModuleIdentifier(), initial.version);
+    initial.owned = false;
+    initial.lastUsed = 0;
+    _modules.insert(std::pair<std::string, LoadedModule>(module.getModuleIdentifier(), initial));
+    _context = &module.getContext();
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        error = strerror(errno);
+        return false;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    unlink(socketPath.c_str());
+    if (bind(listener, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, 16) != 0) {
+        error = strerror(errno);
+        close(listener);
+        return false;
+    }
+
+    // A client hanging up before reading its reply must not kill the
+    // server.
+    signal(SIGPIPE, SIG_IGN);
+
+    bool running = true;
+    while (running) {
+        int connection = accept(listener, NULL, NULL);
+        if (connection < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = strerror(errno);
+            break;
+        }
+
+        // Requests are served one at a time, so a client that stalls is
+        // timed out rather than left to hold up every other.
+        struct timeval timeout;
+        timeout.tv_sec = ClientTimeoutSeconds;
+        timeout.tv_usec = 0;
+        setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        std::string request;
+        char buffer[4096];
+        bool timedOut = false;
+        while (request.find('\n') == std::string::npos &&
+               request.length() < MaxRequestLength) {
+            ssize_t length = read(connection, buffer, sizeof(buffer));
+            if (length < 0 && errno == EINTR) {
+                continue;
+            }
+            if (length < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                timedOut = true;
+            }
+            if (length <= 0) {
+                break;
+            }
+            request.append(buffer, length);
+        }
+        request = request.substr(0, request.find_first_of("\r\n"));
+        _requests++;
+
+        std::string reply;
+        if (timedOut) {
+            reply = "error: timed out waiting for the request\n";
+        } else if (request == "quit") {
+            running = false;
+            reply = "ok\n";
+        } else {
+            reply = handle(request);
+        }
+        writeAll(connection, reply);
+        close(connection);
+    }
+
+    close(listener);
+    unlink(socketPath.c_str());
+    return !running;
+}
+
+std::string
+GraphServer::handle(const std::string& request)
+{
+    // Paths may contain spaces but symbol names don't, so the function
+    // is whatever follows the last space.
+    std::string::size_type separator = request.rfind(' ');
+    if (separator == std::string::npos || separator == 0 ||
+        separator + 1 == request.length()) {
+        return "error: expected \"<bitcode file> <function>\"\n";
+    }
+    std::string path = request.substr(0, separator);
+    std::string name = request.substr(separator + 1);
+
+    std::string error;
+    Module* module = getModule(path, error);
+    if (module == NULL) {
+        return "error: " + error + "\n";
+    }
+
+    std::string graph;
+    if (_cache.lookup(path, name, graph)) {
+        return graph;
+    }
+
+    Function* function = findFunction(module, name);
+    if (function == NULL) {
+        return "error: no function " + name + " in " + path + "\n";
+    }
+
+    graph = _renderer.renderFunction(*function);
+    _cache.insert(path, name, graph);
+    return graph;
+}
+
+bool
+GraphServer::FileVersion::operator==(const FileVersion& other) const
+{
+    return seconds == other.seconds && nanoseconds == other.nanoseconds &&
+        size == other.size;
+}
+
+bool
+GraphServer::getVersion(const std::string& path, FileVersion& version)
+{
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0) {
+        return false;
+    }
+    // A rebuild within the same second keeps st_mtime, so the
+    // nanoseconds and size are compared too.
+    version.seconds = status.st_mtim.tv_sec;
+    version.nanoseconds = status.st_mtim.tv_nsec;
+    version.size = status.st_size;
+    return true;
+}
+
+Module*
+GraphServer::getModule(const std::string& path, std::string& error)
+{
+    FileVersion version;
+    bool readable = getVersion(path, version);
+    std::map<std::string, LoadedModule>::iterator loaded = _modules.find(path);
+    if (loaded != _modules.end()) {
+        // A module whose file can't be read any more (or never could,
+        // like one read from stdin) keeps being served as it is.
+        if (!readable || version == loaded->second.version) {
+            loaded->second.lastUsed = _requests;
+            return loaded->second.module;
+        }
+        _cache.invalidate(path);
+        // Rendered callees may point into the module being replaced.
+        _renderer.resetCalleeGraphs();
+        unload(loaded->second);
+        _modules.erase(loaded);
+    }
+
+    MemoryBuffer* buffer = MemoryBuffer::getFile(path.c_str(), &error);
+    if (buffer == NULL) {
+        return NULL;
+    }
+    Module* module = ParseBitcodeFile(buffer, *_context, &error);
+    delete buffer;
+    if (module == NULL) {
+        return NULL;
+    }
+
+    LoadedModule entry;
+    entry.module = module;
+    entry.version = version;
+    entry.owned = true;
+    entry.lastUsed = _requests;
+    _modules.insert(std::pair<std::string, LoadedModule>(path, entry));
+    evict();
+    return module;
+}
+
+Function*
+GraphServer::findFunction(Module* module, const std::string& name)
+{
+    Function* function = module->getFunction(name);
+    if (function != NULL) {
+        return function;
+    }
+
+    // Graph files are named by the sanitized identifier, shortened if
+    // too long, which is what a client browsing them has at hand.
+    for (Module::iterator it = module->begin();
+         it != module->end();
+         it++) {
+        std::string identifier = DotText::sanitizeIdentifier(it->getName());
+        if (identifier == name || OutputPaths::getFileName(identifier) == name) {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+void
+GraphServer::evict()
+{
+    // The module the pass was run on isn't the server's to free, so only
+    // the ones it loaded count.
+    size_t owned = 0;
+    std::map<std::string, LoadedModule>::iterator oldest = _modules.end();
+    for (std::map<std::string, LoadedModule>::iterator it = _modules.begin();
+         it != _modules.end();
+         it++) {
+        if (!it->second.owned) {
+            continue;
+        }
+        owned++;
+        if (oldest == _modules.end() || it->second.lastUsed < oldest->second.lastUsed) {
+            oldest = it;
+        }
+    }
+    if (owned <= MaxLoadedModules) {
+        return;
+    }
+
+    _cache.invalidate(oldest->first);
+    // Rendered callees may point into the module being unloaded.
+    _renderer.resetCalleeGraphs();
+    unload(oldest->second);
+    _modules.erase(oldest);
+}
+
+void
+GraphServer::unload(LoadedModule& loaded)
+{
+    if (loaded.owned) {
+        delete loaded.module;
+    }
+    loaded.module = NULL;
+}
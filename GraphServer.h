@@ -0,0 +1,130 @@
+/*
+** GraphServer.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	GRAPHSERVER_H_
+# define   	GRAPHSERVER_H_
+
+#include "GraphCache.h"
+#include "RocketShip.h"
+
+#include "llvm/Module.h"
+
+#include <map>
+#include <string>
+#include <sys/types.h>
+#include <time.h>
+
+/**
+ * Answers requests for single function graphs over a Unix socket, keeping
+ * the modules asked about loaded and the rendered graphs in a GraphCache
+ * between requests.
+ *
+ * Each connection carries one request, a line holding the path of a
+ * bitcode file and the name of a function separated by a space:
+ *     /path/to/module.bc _ZN3foo3barEv
+ * The reply is the DOT text of the graph, or a line starting with "error:",
+ * after which the connection is closed.  A request of "quit" stops the
+ * server.  A client that doesn't finish its request within a few seconds
+ * is dropped, so it can't hold up the others.
+ *
+ * A module is reloaded, and its cached graphs dropped, whenever the
+ * modification time or the size of its file changes.  Only the modules
+ * used last are kept loaded, so memory doesn't grow with every module
+ * ever asked about.
+ */
+class GraphServer {
+public:
+    /**
+     * Constructor.
+     * @param renderer The pass used to render graphs.
+     * @param cacheBytes The most bytes of rendered graphs to keep.
+     */
+    GraphServer(rocketship::RocketShip& renderer, size_t cacheBytes);
+    /**
+     * Destructor, frees the modules the server loaded.
+     */
+    ~GraphServer();
+
+    /**
+     * Serves requests until asked to quit.
+     * @param socketPath The path of the socket to listen on.  Any existing
+     * file at the path is replaced.
+     * @param module The module the pass was run on, served without being
+     * loaded again until its file changes.
+     * @param error Receives the reason the server couldn't start.
+     * @return false if the socket couldn't be set up.
+     */
+    bool run(const std::string& socketPath, llvm::Module& module, std::string& error);
+private:
+    /**
+     * What tells versions of a file apart: its modification time, to the
+     * nanosecond, and its size.
+     */
+    struct FileVersion {
+        FileVersion() : seconds(0), nanoseconds(0), size(0) {}
+        bool operator==(const FileVersion& other) const;
+
+        time_t seconds;
+        long nanoseconds;
+        off_t size;
+    };
+
+    /**
+     * A module held by the server.
+     */
+    struct LoadedModule {
+        llvm::Module* module;
+        // The version of the file when it was loaded.
+        FileVersion version;
+        // Whether the server loaded the module and has to free it.
+        bool owned;
+        // When the module was last asked about, in requests served.
+        unsigned long lastUsed;
+    };
+
+    /**
+     * @param version Receives the version of a file.
+     * @return false if the file can't be read.
+     */
+    static bool getVersion(const std::string& path, FileVersion& version);
+
+    /**
+     * Produces the reply to a single request.
+     */
+    std::string handle(const std::string& request);
+    /**
+     * Returns the module for a bitcode file, loading or reloading it as
+     * needed.
+     * @param path The path of the bitcode file.
+     * @param error Receives the reason the module couldn't be loaded.
+     * @return The module, or NULL on error.
+     */
+    llvm::Module* getModule(const std::string& path, std::string& error);
+    /**
+     * Finds a function by its name or by its sanitized identifier.
+     * @return The function, or NULL if the module has no such function.
+     */
+    llvm::Function* findFunction(llvm::Module* module, const std::string& name);
+    /**
+     * Frees a module if the server owns it.
+     */
+    void unload(LoadedModule& loaded);
+    /**
+     * Unloads the module used longest ago, if more than the most kept
+     * are loaded.
+     */
+    void evict();
+
+    rocketship::RocketShip& _renderer;
+    GraphCache _cache;
+    std::map<std::string, LoadedModule> _modules;
+    // The context new modules are loaded into.
+    llvm::LLVMContext* _context;
+    // The number of requests served, to order modules by last use.
+    unsigned long _requests;
+};
+
+#endif 	    /* !GRAPHSERVER_H_ */
@@ -0,0 +1,173 @@
+#include "GraphSlicer.h"
+#include "Node.h"
+
+#include <algorithm>
+
+void
+GraphSlicer::slice(const Graph& graph, Graph::Index start,
+                   const std::vector<Graph::Index>& sources,
+                   const std::vector<Graph::Index>* sinks,
+                   Graph& slice)
+{
+    Graph::Index nodes = graph.size();
+
+    // Both directions of the edges, kept the way the graph keeps its own.
+    std::vector<Graph::Index> successorOffsets(nodes + 1, 0);
+    std::vector<Graph::Index> successors;
+    successors.reserve(graph.getEdgeCount());
+    std::vector<Graph::Index> predecessorOffsets(nodes + 1, 0);
+    for (Graph::Index node = 0; node < nodes; node++) {
+        for (Graph::Index edge = graph.getEdgesBegin(node);
+             edge < graph.getEdgesEnd(node);
+             edge++) {
+            successors.push_back(graph.getEdgeTarget(edge));
+            predecessorOffsets[graph.getEdgeTarget(edge) + 1]++;
+        }
+        successorOffsets[node + 1] = successors.size();
+    }
+
+    std::vector<bool> kept;
+    reach(successorOffsets, successors, sources, NULL, kept);
+    if (sinks != NULL) {
+        for (Graph::Index node = 0; node < nodes; node++) {
+            predecessorOffsets[node + 1] += predecessorOffsets[node];
+        }
+        std::vector<Graph::Index> predecessors(successors.size());
+        std::vector<Graph::Index> filled(predecessorOffsets.begin(), predecessorOffsets.end() - 1);
+        for (Graph::Index node = 0; node < nodes; node++) {
+            for (Graph::Index edge = successorOffsets[node];
+                 edge < successorOffsets[node + 1];
+                 edge++) {
+                predecessors[filled[successors[edge]]++] = node;
+            }
+        }
+
+        std::vector<bool> reaching;
+        reach(predecessorOffsets, predecessors, *sinks, NULL, reaching);
+        for (Graph::Index node = 0; node < nodes; node++) {
+            kept[node] = kept[node] && reaching[node];
+        }
+    }
+    if (start != Graph::None) {
+        kept[start] = true;
+    }
+
+    // Sources the start node doesn't lead to within the slice are entered
+    // through a single elided node after the start node.
+    std::vector<Graph::Index> entered;
+    if (start != Graph::None) {
+        std::vector<bool> connected;
+        reach(successorOffsets, successors, std::vector<Graph::Index>(1, start), &kept, connected);
+        for (std::vector<Graph::Index>::const_iterator it = sources.begin();
+             it != sources.end();
+             it++) {
+            if (kept[*it] && !connected[*it]) {
+                entered.push_back(*it);
+            }
+        }
+    }
+    std::sort(entered.begin(), entered.end());
+    entered.erase(std::unique(entered.begin(), entered.end()), entered.end());
+
+    // Elided nodes take ids after every node of the graph, so they are
+    // added after them and keep ids in order.
+    int nextId = 0;
+    Graph::Index keptNodes = 0;
+    Graph::Index keptEdges = 0;
+    Graph::Index elided = 0;
+    for (Graph::Index node = 0; node < nodes; node++) {
+        nextId = std::max(nextId, graph.getId(node) + 1);
+        if (!kept[node]) {
+            continue;
+        }
+        keptNodes++;
+        bool leaves = false;
+        for (Graph::Index edge = successorOffsets[node];
+             edge < successorOffsets[node + 1];
+             edge++) {
+            if (kept[successors[edge]]) {
+                keptEdges++;
+            } else {
+                leaves = true;
+            }
+        }
+        // The start node's way into the entered sources stands for all
+        // it leads to.
+        if (leaves && !(node == start && !entered.empty())) {
+            elided++;
+        }
+    }
+    if (!entered.empty()) {
+        elided++;
+    }
+
+    slice.reset(keptNodes + elided, keptEdges + elided + entered.size());
+    StringTable::Id label = slice.getStrings().intern("paths elided");
+    int enteringId = entered.empty() ? -1 : nextId++;
+    std::vector<int> leaving;
+    for (Graph::Index node = 0; node < nodes; node++) {
+        if (!kept[node]) {
+            continue;
+        }
+        slice.addNode(graph.getId(node), graph.getType(node), graph.getLabelId(node),
+                      graph.getNameId(node), graph.getInstruction(node));
+        bool leaves = false;
+        for (Graph::Index edge = graph.getEdgesBegin(node);
+             edge < graph.getEdgesEnd(node);
+             edge++) {
+            Graph::Index target = graph.getEdgeTarget(edge);
+            if (kept[target]) {
+                slice.addEdge(graph.getId(target), graph.getEdgeLabelId(edge),
+                              graph.getEdgeWeight(edge));
+            } else {
+                leaves = true;
+            }
+        }
+        if (leaves && !(node == start && enteringId >= 0)) {
+            slice.addEdge(nextId, StringTable::Empty, -1);
+            leaving.push_back(nextId++);
+        }
+        if (node == start && enteringId >= 0) {
+            slice.addEdge(enteringId, StringTable::Empty, -1);
+        }
+    }
+
+    if (enteringId >= 0) {
+        slice.addNode(enteringId, Node::ELIDED, label, StringTable::Empty, NULL);
+        for (std::vector<Graph::Index>::iterator it = entered.begin(); it != entered.end(); it++) {
+            slice.addEdge(graph.getId(*it), StringTable::Empty, -1);
+        }
+    }
+    for (std::vector<int>::iterator it = leaving.begin(); it != leaving.end(); it++) {
+        slice.addNode(*it, Node::ELIDED, label, StringTable::Empty, NULL);
+    }
+    slice.finish();
+    slice.assignStableIds();
+}
+
+void
+GraphSlicer::reach(const std::vector<Graph::Index>& offsets,
+                   const std::vector<Graph::Index>& neighbours,
+                   const std::vector<Graph::Index>& from,
+                   const std::vector<bool>* within,
+                   std::vector<bool>& reached)
+{
+    reached.assign(offsets.size() - 1, false);
+    std::vector<Graph::Index> pending;
+    for (std::vector<Graph::Index>::const_iterator it = from.begin(); it != from.end(); it++) {
+        if (!reached[*it]) {
+            reached[*it] = true;
+            pending.push_back(*it);
+        }
+    }
+    while (!pending.empty()) {
+        Graph::Index node = pending.back();
+        pending.pop_back();
+        for (Graph::Index n = offsets[node]; n < offsets[node + 1]; n++) {
+            if (!reached[neighbours[n]] && (within == NULL || (*within)[neighbours[n]])) {
+                reached[neighbours[n]] = true;
+                pending.push_back(neighbours[n]);
+            }
+        }
+    }
+}
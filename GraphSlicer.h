@@ -0,0 +1,63 @@
+/*
+** GraphSlicer.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	GRAPHSLICER_H_
+# define   	GRAPHSLICER_H_
+
+#include "Graph.h"
+
+#include <vector>
+
+/**
+ * Cuts a Graph down to the paths through a few nodes of interest, such as
+ * the calls to a lock or an allocator, so that what is written and laid
+ * out scales with the slice rather than with the function.
+ *
+ * The slice holds every node on a path from one of the sources to one of
+ * the sinks: the nodes reachable from a source that can also reach a
+ * sink.  Without sinks, everything reachable from a source is kept.  Each
+ * needs a single pass over the graph's edges, forward from the sources and
+ * backward from the sinks.
+ *
+ * The start node is always kept.  What was left out shows as elided
+ * nodes: a node with edges to nodes left out gets one edge to a "paths
+ * elided" node instead, and sources the start node doesn't lead to in the
+ * slice are reached from it through one.
+ */
+class GraphSlicer {
+public:
+    /**
+     * Slices a graph.
+     * @param graph The graph to slice.
+     * @param start The position of the start node, or Graph::None.
+     * @param sources The positions of the nodes the paths start at.
+     * @param sinks The positions of the nodes the paths end at, or NULL to
+     * keep everything reachable from the sources.
+     * @param slice Receives the slice, with stable ids.  Kept nodes keep
+     * their internal id.  It must use the string table of graph, since
+     * labels are copied over as ids.
+     */
+    static void slice(const Graph& graph, Graph::Index start,
+                      const std::vector<Graph::Index>& sources,
+                      const std::vector<Graph::Index>* sinks,
+                      Graph& slice);
+private:
+    /**
+     * Marks every node reachable from the given nodes.
+     * @param offsets The neighbours of node n are neighbours[offsets[n]]
+     * to neighbours[offsets[n + 1]].
+     * @param from The nodes to start from, which are marked too.
+     * @param within The only nodes that may be reached, or NULL for all.
+     * @param reached Receives true for every node reached.
+     */
+    static void reach(const std::vector<Graph::Index>& offsets,
+                      const std::vector<Graph::Index>& neighbours,
+                      const std::vector<Graph::Index>& from,
+                      const std::vector<bool>* within,
+                      std::vector<bool>& reached);
+};
+
+#endif 	    /* !GRAPHSLICER_H_ */
@@ -0,0 +1,319 @@
+#include "Journal.h"
+#include "Fnv.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// The journal and record written by the crash handler.  The record is
+// cleared while it is being replaced.
+static volatile int crashFile = -1;
+static const char* volatile crashRecord = NULL;
+static volatile size_t crashLength = 0;
+// The record written instead when the thread writing files crashes.
+static const char* volatile writingRecord = NULL;
+static volatile size_t writingLength = 0;
+static pthread_t writingThread;
+
+// The signals a crashing function dies of, and what handled them before
+// the journal was opened.
+static const int CrashSignals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+static const int CrashSignalCount = sizeof(CrashSignals) / sizeof(CrashSignals[0]);
+static struct sigaction previousActions[CrashSignalCount];
+
+/**
+ * Records the current unit as crashed, then hands the signal on to the
+ * handler there was before, which runs as soon as this one returns.
+ * Only uses functions safe in a signal handler.
+ */
+static void
+recordCrash(int signal)
+{
+    const char* record = crashRecord;
+    size_t length = crashLength;
+    const char* writing = writingRecord;
+    if (writing != NULL && pthread_equal(pthread_self(), writingThread)) {
+        record = writing;
+        length = writingLength;
+    }
+    if (crashFile >= 0 && record != NULL) {
+        ssize_t written = write(crashFile, record, length);
+        (void)written;
+    }
+    for (int i = 0; i < CrashSignalCount; i++) {
+        if (CrashSignals[i] == signal) {
+            sigaction(signal, &previousActions[i], NULL);
+        }
+    }
+    raise(signal);
+}
+
+/**
+ * Splits a record into its tab separated fields.
+ */
+static std::vector<std::string>
+splitRecord(const std::string& record)
+{
+    std::vector<std::string> fields;
+    std::string::size_type start = 0;
+    for (;;) {
+        std::string::size_type end = record.find('\t', start);
+        if (end == std::string::npos) {
+            fields.push_back(record.substr(start));
+            return fields;
+        }
+        fields.push_back(record.substr(start, end - start));
+        start = end + 1;
+    }
+}
+
+/**
+ * Reads a hash written as 16 hex digits.
+ * @return false if text isn't one.
+ */
+static bool
+parseHash(const std::string& text, uint64_t& hash)
+{
+    if (text.length() != 16) {
+        return false;
+    }
+    hash = 0;
+    for (std::string::size_type i = 0; i < text.length(); i++) {
+        char digit = text[i];
+        unsigned int value;
+        if (digit >= '0' && digit <= '9') {
+            value = digit - '0';
+        } else if (digit >= 'a' && digit <= 'f') {
+            value = digit - 'a' + 10;
+        } else {
+            return false;
+        }
+        hash = hash << 4 | value;
+    }
+    return true;
+}
+
+Journal::Journal() :
+    _file(-1)
+{
+}
+
+Journal::~Journal()
+{
+    close();
+}
+
+bool
+Journal::open(const std::string& path, bool resume, std::string& error)
+{
+    close();
+    _units.clear();
+
+    int flags = O_WRONLY | O_CREAT | O_APPEND;
+    bool torn = false;
+    if (resume) {
+        torn = !load(path);
+    } else {
+        flags |= O_TRUNC;
+    }
+    _file = ::open(path.c_str(), flags, 0644);
+    if (_file < 0) {
+        error = strerror(errno);
+        return false;
+    }
+
+    // A record torn by a kill is ended, so the next one starts a line.
+    if (torn) {
+        append("\n");
+    }
+
+    crashFile = _file;
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &recordCrash;
+    sigemptyset(&action.sa_mask);
+    for (int i = 0; i < CrashSignalCount; i++) {
+        sigaction(CrashSignals[i], &action, &previousActions[i]);
+    }
+    return true;
+}
+
+void
+Journal::close()
+{
+    if (_file < 0) {
+        return;
+    }
+    for (int i = 0; i < CrashSignalCount; i++) {
+        sigaction(CrashSignals[i], &previousActions[i], NULL);
+    }
+    crashFile = -1;
+    crashRecord = NULL;
+    writingRecord = NULL;
+    ::close(_file);
+    _file = -1;
+}
+
+void
+Journal::recordStart(const std::string& unit)
+{
+    if (_file < 0) {
+        return;
+    }
+    append("start\t" + unit + "\n");
+
+    crashRecord = NULL;
+    _crashRecord = "crash\t" + unit + "\n";
+    crashLength = _crashRecord.length();
+    crashRecord = _crashRecord.c_str();
+}
+
+void
+Journal::recordWriting(const std::string& unit)
+{
+    if (_file < 0) {
+        return;
+    }
+    writingRecord = NULL;
+    if (unit.empty()) {
+        return;
+    }
+    _writingRecord = "crash\t" + unit + "\n";
+    writingLength = _writingRecord.length();
+    writingThread = pthread_self();
+    __sync_synchronize();
+    writingRecord = _writingRecord.c_str();
+}
+
+void
+Journal::recordFile(const std::string& unit, const std::string& path, uint64_t hash)
+{
+    if (_file < 0) {
+        return;
+    }
+    char digits[17];
+    sprintf(digits, "%016llx", static_cast<unsigned long long>(hash));
+    append("file\t" + unit + "\t" + digits + "\t" + path + "\n");
+}
+
+void
+Journal::recordDone(const std::string& unit)
+{
+    if (_file < 0) {
+        return;
+    }
+    append("done\t" + unit + "\n");
+}
+
+bool
+Journal::isFinished(const std::string& unit) const
+{
+    std::map<std::string, Unit>::const_iterator it = _units.find(unit);
+    if (it == _units.end() || !it->second.done || it->second.crashed) {
+        return false;
+    }
+    for (std::map<std::string, uint64_t>::const_iterator file = it->second.files.begin();
+         file != it->second.files.end();
+         file++) {
+        uint64_t hash;
+        if (!hashFile(file->first, hash) || hash != file->second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+Journal::hasCrashed(const std::string& unit) const
+{
+    std::map<std::string, Unit>::const_iterator it = _units.find(unit);
+    return it != _units.end() && it->second.crashed;
+}
+
+std::vector<std::string>
+Journal::getFiles(const std::string& unit) const
+{
+    std::vector<std::string> files;
+    std::map<std::string, Unit>::const_iterator it = _units.find(unit);
+    if (it != _units.end()) {
+        for (std::map<std::string, uint64_t>::const_iterator file = it->second.files.begin();
+             file != it->second.files.end();
+             file++) {
+            files.push_back(file->first);
+        }
+    }
+    return files;
+}
+
+bool
+Journal::hashFile(const std::string& path, uint64_t& hash)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == NULL) {
+        return false;
+    }
+    hash = Fnv::Empty;
+    char buffer[64 * 1024];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        hash = Fnv::extend(hash, buffer, length);
+    }
+    bool read = !ferror(file);
+    fclose(file);
+    return read;
+}
+
+bool
+Journal::load(const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == NULL) {
+        return true;
+    }
+    std::string content;
+    char buffer[64 * 1024];
+    size_t length;
+    while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        content.append(buffer, length);
+    }
+    fclose(file);
+
+    // Only whole lines count: a torn last record is left out.
+    std::string::size_type start = 0;
+    std::string::size_type end;
+    while ((end = content.find('\n', start)) != std::string::npos) {
+        std::vector<std::string> fields = splitRecord(content.substr(start, end - start));
+        start = end + 1;
+        if (fields.size() < 2) {
+            continue;
+        }
+
+        Unit& unit = _units[fields[1]];
+        if (fields[0] == "start") {
+            // A unit started again is judged by its latest attempt.
+            unit = Unit();
+        } else if (fields[0] == "file" && fields.size() == 4) {
+            uint64_t hash;
+            if (parseHash(fields[2], hash)) {
+                unit.files[fields[3]] = hash;
+            }
+        } else if (fields[0] == "done") {
+            unit.done = true;
+        } else if (fields[0] == "crash") {
+            unit.crashed = true;
+        }
+    }
+    return start == content.length();
+}
+
+void
+Journal::append(const std::string& record)
+{
+    // O_APPEND makes the single write land whole at the end, whichever
+    // thread makes it.
+    ssize_t written = write(_file, record.data(), record.length());
+    (void)written;
+}
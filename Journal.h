@@ -0,0 +1,146 @@
+/*
+** Journal.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	JOURNAL_H_
+# define   	JOURNAL_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * A progress journal, so that a long batch run that gets killed can be
+ * resumed where it stopped instead of starting over.
+ *
+ * Work is done in units (a function, or a whole module), each named by
+ * a string without tabs or newlines.  A unit is recorded as started
+ * before any of it is done, then every file it wrote with the hash of
+ * its bytes on disk, then done once its last file has been written.  If
+ * the process crashes, the unit the crashing thread was working on is
+ * recorded as crashed on the way down: the unit a file was being written
+ * for on the thread writing files, the last unit started on any other.
+ *
+ * The journal is a text file with a record per line, only ever appended
+ * to.  Each record goes out in a single write, so records can be added
+ * from the pass and the writer thread alike, and a run killed half way
+ * leaves at most the last line torn, which is ignored.
+ *
+ * What the journal knows about units is read when it is opened and is
+ * not changed by the records added afterwards: it describes the earlier
+ * runs.
+ */
+class Journal {
+public:
+    /**
+     * Constructor, creates a closed journal that records nothing.
+     */
+    Journal();
+    /**
+     * Destructor, closes the journal.
+     */
+    ~Journal();
+
+    /**
+     * Opens a journal.  While it is open, the process crashing records
+     * the current unit as crashed.
+     * @param path The name of the journal file.
+     * @param resume true to read the records already there and add to
+     * them, false to start an empty journal.
+     * @param error Receives the reason the file couldn't be opened.
+     * @return true if the journal is open.
+     */
+    bool open(const std::string& path, bool resume, std::string& error);
+    /**
+     * Closes the journal, leaving crashes to the handlers there were
+     * before.
+     */
+    void close();
+    /**
+     * @return true if the journal is open.
+     */
+    bool isOpen() const { return _file >= 0; }
+
+    /**
+     * Records that a unit is starting, and makes it the current unit.
+     */
+    void recordStart(const std::string& unit);
+    /**
+     * Makes a unit the one the calling thread writes files for, so that a
+     * crash on this thread is blamed on it rather than on the last unit
+     * started.  Nothing is written to the journal.
+     * @param unit The unit, or an empty string once done writing.
+     */
+    void recordWriting(const std::string& unit);
+    /**
+     * Records a file a unit wrote.
+     * @param path The name of the file, as written.
+     * @param hash The OutputFile hash of the bytes written.
+     */
+    void recordFile(const std::string& unit, const std::string& path, uint64_t hash);
+    /**
+     * Records that a unit and all of its files are done.
+     */
+    void recordDone(const std::string& unit);
+
+    /**
+     * @return true if an earlier run finished a unit, and every file it
+     * wrote is still there with the same content.  Reads the files.
+     */
+    bool isFinished(const std::string& unit) const;
+    /**
+     * @return true if an earlier run crashed in a unit, and it hasn't
+     * been done since.
+     */
+    bool hasCrashed(const std::string& unit) const;
+    /**
+     * @return The files an earlier run recorded for a unit, by name.
+     */
+    std::vector<std::string> getFiles(const std::string& unit) const;
+
+    /**
+     * Hashes a file the way OutputFile hashes what it writes.
+     * @param hash Receives the hash.
+     * @return false if the file can't be read.
+     */
+    static bool hashFile(const std::string& path, uint64_t& hash);
+private:
+    /**
+     * What the earlier runs recorded about a unit.
+     */
+    struct Unit {
+        Unit() : done(false), crashed(false) {}
+
+        bool done;
+        bool crashed;
+        // The files written, by name, with their hash.
+        std::map<std::string, uint64_t> files;
+    };
+
+    /**
+     * Reads the records of the earlier runs.
+     * @return false if the last record is torn.
+     */
+    bool load(const std::string& path);
+    /**
+     * Adds a record to the file in a single write.
+     */
+    void append(const std::string& record);
+
+    Journal(const Journal&);
+    Journal& operator=(const Journal&);
+
+    int _file;
+    std::map<std::string, Unit> _units;
+    // The record written if the process crashes, prepared in advance
+    // since a signal handler can't build it.
+    std::string _crashRecord;
+    // The same, for a crash while writing files.
+    std::string _writingRecord;
+};
+
+#endif 	    /* !JOURNAL_H_ */
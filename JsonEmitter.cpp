@@ -0,0 +1,96 @@
+#include "JsonEmitter.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+JsonEmitter::JsonEmitter(std::ostream& out) :
+    GraphEmitter(out),
+    _nodeWritten(false)
+{
+}
+
+void
+JsonEmitter::beginGraph(const std::string& identifier, const std::string& label)
+{
+    _nodeWritten = false;
+    _out << "{\"graph\": \"";
+    writeEscaped(_out, identifier);
+    _out << "\", \"label\": \"";
+    writeEscaped(_out, label);
+    _out << "\", \"nodes\": [\n";
+}
+
+void
+JsonEmitter::emitNode(const Graph& graph, Graph::Index node)
+{
+    if (_nodeWritten) {
+        _out << ",\n";
+    }
+    _nodeWritten = true;
+
+    _out << "{\"id\": \"";
+    graph.writeDotId(_out, node);
+    _out << "\", \"type\": \"" << getTypeName(graph.getType(node))
+         << "\", \"label\": \"";
+    writeEscaped(_out, graph.getLabel(node));
+    _out << "\", \"edges\": [";
+
+    for (Graph::Index edge = graph.getEdgesBegin(node);
+         edge < graph.getEdgesEnd(node);
+         edge++) {
+        if (edge != graph.getEdgesBegin(node)) {
+            _out << ", ";
+        }
+        _out << "{\"to\": \"";
+        graph.writeDotId(_out, graph.getEdgeTarget(edge));
+        _out << "\", \"label\": \"";
+        writeEscaped(_out, graph.getEdgeLabel(edge));
+        _out << "\"";
+        if (graph.getEdgeWeight(edge) >= 0) {
+            _out << ", \"weight\": " << static_cast<uint64_t>(graph.getEdgeWeight(edge));
+        }
+        _out << "}";
+    }
+    _out << "]}";
+}
+
+void
+JsonEmitter::endGraph()
+{
+    _out << "\n]}\n";
+}
+
+void
+JsonEmitter::writeEscaped(std::ostream& out, const std::string& value)
+{
+    // Runs of characters that need no escaping are written in one go.
+    std::string::size_type start = 0;
+    for (std::string::size_type i = 0; i < value.length(); i++) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (c != '"' && c != '\\' && c >= 0x20) {
+            continue;
+        }
+
+        out.write(value.data() + start, i - start);
+        start = i + 1;
+        switch (c) {
+        case '"':
+            out << "\\\"";
+            break;
+        case '\\':
+            out << "\\\\";
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        case '\t':
+            out << "\\t";
+            break;
+        default:
+            char escaped[8];
+            sprintf(escaped, "\\u%04x", c);
+            out << escaped;
+        }
+    }
+    out.write(value.data() + start, value.length() - start);
+}
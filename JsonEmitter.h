@@ -0,0 +1,46 @@
+/*
+** JsonEmitter.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	JSONEMITTER_H_
+# define   	JSONEMITTER_H_
+
+#include "GraphEmitter.h"
+
+/**
+ * Writes a graph as a JSON object:
+ *     {"graph": "main", "label": "int main()", "nodes": [
+ *     {"id": "n...", "type": "decision", "label": "x < 3", "edges": [
+ *         {"to": "n...", "label": "true", "weight": 12}, ...]},
+ *     ...
+ *     ]}
+ * Edges are nested in the node they leave, so each node is complete as
+ * soon as it is written.  "weight" is only present on profiled edges.
+ */
+class JsonEmitter : public GraphEmitter {
+public:
+    /**
+     * Constructor.
+     * @param out The stream to write to.
+     */
+    JsonEmitter(std::ostream& out);
+
+    virtual void beginGraph(const std::string& identifier, const std::string& label);
+    virtual void emitNode(const Graph& graph, Graph::Index node);
+    virtual void endGraph();
+
+    /**
+     * Writes text as the contents of a JSON string, escaping quotes,
+     * backslashes and control characters.
+     * @param out The stream to write to.
+     * @param value The text to escape.
+     */
+    static void writeEscaped(std::ostream& out, const std::string& value);
+private:
+    // Whether a node has been written since beginGraph.
+    bool _nodeWritten;
+};
+
+#endif 	    /* !JSONEMITTER_H_ */
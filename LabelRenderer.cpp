@@ -0,0 +1,528 @@
+#include "LabelRenderer.h"
+#include "Accounting.h"
+
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/Intrinsics.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+#include <demangle.h>
+}
+
+using namespace llvm;
+
+/**
+ * Bounds on how far getValueName walks an operand tree before
+ * abbreviating the rest as "...".
+ */
+static const unsigned int MaxValueNameDepth = 32;
+static const unsigned int MaxValueNameOperands = 256;
+
+/**
+ * The built in renderers, one overload per kind of instruction with
+ * specific handling.  renderAs<Class> picks the overload for the most
+ * specific base of Class at compile time, so every cast instruction uses
+ * the CastInst overload, both comparisons the CmpInst one, and anything
+ * without an overload the Instruction one.
+ */
+static std::string
+renderLabel(Instruction* instruction)
+{
+    return LabelRenderer::getDefaultLabel(instruction);
+}
+
+// Comparison instructions are not displayed at all.  The
+// conditional branch instructions link to the comparison
+// instruction associated.  The decision node for a
+// conditional branch then displays the actual comparison
+// being made.
+static std::string
+renderLabel(CmpInst*)
+{
+    return "";
+}
+
+// Allocation instructions are currently not displayed.
+// In the future, this should probably be modified to show
+// what memory is being allocated for each "thing".
+static std::string
+renderLabel(AllocaInst*)
+{
+    return "";
+}
+
+// Bitcast instructions cast from type A to type B but
+// guarantee there is no change in the value.  The
+// operation is not necessary to display in the graph.
+static std::string
+renderLabel(CastInst*)
+{
+    return "";
+}
+
+// Load instructions pull a value from memory.  This is
+// inconsequential for every language source except for
+// assembly.
+static std::string
+renderLabel(LoadInst*)
+{
+    return "";
+}
+
+// Binary Operators are things like mul, (s|u)div, etc.
+// These values are assigned or used later, so they do not
+// need explicit display.
+static std::string
+renderLabel(BinaryOperator*)
+{
+    return "";
+}
+
+// GetElementPtrInst references an index in a pointer.
+// This indexing will be referenced by other operations,
+// so it is redundant to display the box.
+static std::string
+renderLabel(GetElementPtrInst*)
+{
+    return "";
+}
+
+static std::string renderLabel(CallInst* instruction);
+
+static std::string
+renderLabel(BranchInst* instruction)
+{
+    // Unconditional branches don't get displayed
+    if (instruction->isConditional()) {
+        return LabelRenderer::getConditionalBranchLabel(instruction);
+    }
+    return "";
+}
+
+static std::string
+renderLabel(InvokeInst* instruction)
+{
+    return LabelRenderer::getInvokeInstLabel(instruction);
+}
+
+static std::string
+renderLabel(SwitchInst* instruction)
+{
+    return LabelRenderer::getSwitchInstLabel(instruction);
+}
+
+static std::string
+renderLabel(StoreInst* instruction)
+{
+    return LabelRenderer::getStoreInstLabel(instruction);
+}
+
+/**
+ * Adapts the overload for Class to the Renderer signature.
+ */
+template <class Class>
+static std::string
+renderAs(Instruction* instruction)
+{
+    return renderLabel(static_cast<Class*>(instruction));
+}
+
+/**
+ * The renderer for each opcode.  Opcodes are numbered contiguously from 1
+ * in the order of Instruction.def, so expanding it in order puts each
+ * entry at the index of its opcode.
+ */
+static LabelRenderer::Renderer renderers[Instruction::OtherOpsEnd] = {
+    NULL,
+#define HANDLE_INST(num, opcode, Class) &renderAs<Class>,
+#include "llvm/Instruction.def"
+};
+
+/**
+ * The renderer for calls to each intrinsic, NULL for intrinsics rendered
+ * as regular calls.
+ */
+static LabelRenderer::Renderer intrinsicRenderers[Intrinsic::num_intrinsics];
+
+static std::string
+renderLabel(CallInst* instruction)
+{
+    Function* callee = instruction->getCalledFunction();
+    if (callee != NULL) {
+        unsigned int intrinsic = callee->getIntrinsicID();
+        if (intrinsic != Intrinsic::not_intrinsic &&
+            intrinsicRenderers[intrinsic] != NULL) {
+            return intrinsicRenderers[intrinsic](instruction);
+        }
+    }
+    return LabelRenderer::getCallInstructionLabel(instruction);
+}
+
+std::string
+LabelRenderer::render(Instruction* instruction)
+{
+    return renderers[instruction->getOpcode()](instruction);
+}
+
+void
+LabelRenderer::registerRenderer(unsigned int opcode, Renderer renderer)
+{
+    // Rebuild the built in entry on demand rather than keeping a
+    // second copy of the table around.
+    if (renderer == NULL) {
+        switch (opcode) {
+#define HANDLE_INST(num, opcode, Class) \
+        case num: renderer = &renderAs<Class>; break;
+#include "llvm/Instruction.def"
+        default:
+            return;
+        }
+    }
+    if (opcode < Instruction::OtherOpsEnd) {
+        renderers[opcode] = renderer;
+    }
+}
+
+void
+LabelRenderer::registerIntrinsicRenderer(unsigned int intrinsic, Renderer renderer)
+{
+    if (intrinsic < Intrinsic::num_intrinsics) {
+        intrinsicRenderers[intrinsic] = renderer;
+    }
+}
+
+std::string
+LabelRenderer::getDefaultLabel(Instruction* instruction)
+{
+    // Default handling is:
+    // <instruction> <operand 1> <operand 2> <operand n>
+    std::string result = instruction->getOpcodeName();
+
+    for (unsigned int i = 0; i < instruction->getNumOperands(); i++) {
+        result = result + " "
+            + std::string(instruction->getOperand(i)->getName());
+    }
+
+    return result;
+}
+
+std::string
+LabelRenderer::getCallInstructionLabel(CallInst* instruction)
+{
+    // A call instruction is the execution of a function.  The final
+    // output format is:
+    // call <function name> (<operand 1>, <operand 2>, <operand 3>)
+    std::string result = instruction->getOpcodeName();
+    std::string calledName = "";
+
+    // Even if we are unable to get the called function, the function
+    // signature can be generated later on.
+    if (instruction->getCalledFunction() != NULL) {
+        calledName = instruction->getCalledFunction()->getName();
+    }
+
+    std::string resultName = getDemangledName(calledName);
+
+    result = result + " " + resultName;
+
+    // Append the arguments from the operands.
+    if (calledName.compare(resultName) == 0 &&
+        instruction->getCalledFunction() != NULL) {
+        result = result + " (";
+
+        for (unsigned int i = 1; i < instruction->getNumOperands(); i++) {
+            if (i != 1) {
+                result = result + ", ";
+            }
+
+            result = result + getValueName(instruction->getOperand(i));
+        }
+
+        result = result + ")";
+    }
+ 
+    return result;
+}
+
+std::string
+LabelRenderer::getSwitchInstLabel(SwitchInst* instruction)
+{
+    // Switch instruction labels are handled solely by getValueName to
+    // determine the appropriate symbol that is checked.
+    std::string label = instruction->getOpcodeName();
+
+    label = label + " " + getValueName(instruction->getCondition());
+
+    return label;
+}
+
+std::string
+LabelRenderer::getStoreInstLabel(StoreInst* instruction)
+{
+    // Assignment/memory storage, uses := to indicate assignment.
+    std::string label = getValueName(instruction->getPointerOperand());
+
+    label = label + " := ";
+
+    label = label + getValueName(instruction->getOperand(0));
+
+    return label;
+}
+
+std::string
+LabelRenderer::getConditionalBranchLabel(BranchInst* instruction)
+{
+    std::string label = instruction->getOpcodeName();
+
+    if (CmpInst *condition = dyn_cast<CmpInst>(instruction->getCondition())) {
+        label = "";
+
+        // Determine the name to use for the first value for comparison
+        label = getValueName(condition->getOperand(0));
+
+        // The comparison predicate is the method in which the two
+        // values are compared. ICMP is integer comparison, FCMP is
+        // floating point comparison.  For the purposes of generating
+        // the graph, the difference between the two is meaningless.
+        // Instead, simply convert the type of comparison to general
+        // C-like comparison operators.
+        switch (condition->getPredicate()) {
+        // Equality comparison
+        case CmpInst::ICMP_EQ:
+        case CmpInst::FCMP_OEQ:
+            label = label + " == ";
+            break;
+        // Inequality comparison
+        case CmpInst::ICMP_NE:
+        case CmpInst::FCMP_ONE:
+            label = label + " != ";
+            break;
+        // Greater than signed/unsigned comparison
+        case CmpInst::ICMP_UGT:
+        case CmpInst::ICMP_SGT:
+        case CmpInst::FCMP_OGT:
+            label = label + " > ";
+            break;
+        // Greater than or equal signed/unsigned comparison
+        case CmpInst::ICMP_UGE:
+        case CmpInst::ICMP_SGE:
+        case CmpInst::FCMP_OGE:
+            label = label + " >= ";
+            break;
+        // Less than signed/unsigned comparison
+        case CmpInst::ICMP_ULT:
+        case CmpInst::ICMP_SLT:
+        case CmpInst::FCMP_OLT:
+            label = label + " < ";
+            break;
+        // Less than or equal signed/unsigned comparison
+        case CmpInst::ICMP_ULE:
+        case CmpInst::ICMP_SLE:
+        case CmpInst::FCMP_OLE:
+            label = label + " <= ";
+            break;
+        // Floating point comparisons that haven't been mapped into
+        // the current model due to them specifying handling of NaN
+        // and Infinity values.  Should decide about these eventually
+        // and add them.
+        case CmpInst::FCMP_FALSE:
+        case CmpInst::FCMP_ORD:
+        case CmpInst::FCMP_UNO:
+        case CmpInst::FCMP_UEQ:
+        case CmpInst::FCMP_UGT:
+        case CmpInst::FCMP_UGE:
+        case CmpInst::FCMP_ULT:
+        case CmpInst::FCMP_ULE:
+        case CmpInst::FCMP_UNE:
+        case CmpInst::FCMP_TRUE:
+            break;
+        default:
+            break;
+        }
+
+        // Add the second value that is being compared against.
+        label = label + getValueName(condition->getOperand(1));
+    }
+
+    return label;
+}
+
+std::string
+LabelRenderer::getInvokeInstLabel(InvokeInst* instruction)
+{
+    // Invoke instructions are identical to call instructions except
+    // that they can result in a branch if an exception is
+    // thrown/stack should unwind, etc.
+    std::string label = "invoke";
+    std::string calledName = "";
+
+    if (instruction->getCalledFunction() != NULL) {
+        calledName = instruction->getCalledFunction()->getName();
+    }
+
+    if (calledName.length() > 0) {
+        char* demangled = cplus_demangle(calledName.c_str(), DMGL_ANSI|DMGL_PARAMS);
+
+        if (demangled != NULL) {
+            size_t size = strlen(demangled) + 1;
+            Accounting::allocated(Accounting::DemanglerMemory, size);
+            label = label + " " + std::string(demangled);
+            Accounting::released(Accounting::DemanglerMemory, size);
+            free(demangled);
+        } else {
+            label = label + " " + std::string(instruction->getCalledFunction()->getName())
+                + "(";
+
+            for (unsigned int i = 1; i < instruction->getNumOperands(); i++) {
+                if (i != 1) {
+                    label = label + ", ";
+                }
+                label = label + getValueName(instruction->getOperand(i));
+            }
+            label = label + ")";
+        }
+    }
+    
+    return label;
+}
+
+std::string
+LabelRenderer::getDemangledName(std::string name)
+{
+    // cplus_demangle returns a NULL pointer if the supplied string
+    // was not a mangled C++ identifier, or a string holding the
+    // demangled symbol.
+    std::string result;
+    char* demangled = cplus_demangle(name.c_str(), DMGL_ANSI|DMGL_PARAMS);
+
+    if (demangled != NULL) {
+        size_t size = strlen(demangled) + 1;
+        Accounting::allocated(Accounting::DemanglerMemory, size);
+        result = std::string(demangled);
+        // cplus_demangle allocates the memory and the caller is
+        // responsible for freeing the char*.
+        Accounting::released(Accounting::DemanglerMemory, size);
+        free(demangled);
+    } else {
+        result = name;
+    }
+
+    return result;
+}
+
+std::string
+LabelRenderer::getValueName(Value* value)
+{
+    unsigned int budget = MaxValueNameOperands;
+    return getValueName(value, 0, budget);
+}
+
+std::string
+LabelRenderer::getValueName(Value* value, unsigned int depth, unsigned int& budget)
+{
+    // Recursively calls itself to resolve the base symbol represented
+    // by value.  This is due to the nature of LLVM having "unlimited"
+    // registers which results in not all Value's having associated
+    // names.  We assume that the first Value in the chain that has a
+    // name is the name we want to use.
+    std::string result;
+
+    // Operand trees can be arbitrarily deep, and shared operands make
+    // the walk exponential in the depth, so give up on anything past
+    // a fixed depth or number of operands visited.
+    if (depth > MaxValueNameDepth || budget == 0) {
+        return "...";
+    }
+    budget--;
+
+    if (value->hasName()) {
+        result = value->getName();
+
+        char* demangled = cplus_demangle(result.c_str(), DMGL_ANSI|DMGL_PARAMS);
+        if (demangled != NULL) {
+            size_t size = strlen(demangled) + 1;
+            Accounting::allocated(Accounting::DemanglerMemory, size);
+            result = std::string(demangled);
+            Accounting::released(Accounting::DemanglerMemory, size);
+            free(demangled);
+        }
+        return result;
+    }
+
+    if (CastInst* castInst = dyn_cast<CastInst>(&*value)) {
+        // Cast instructions get the value name of the base operand
+        result = getValueName(castInst->getOperand(0), depth + 1, budget);
+    }
+    else if (LoadInst* loadInst = dyn_cast<LoadInst>(&*value)) {
+        // Load instructions get the value name of the item pointed to
+        result = getValueName(loadInst->getPointerOperand(), depth + 1, budget);
+    }
+    else if (SExtInst* sextInst = dyn_cast<SExtInst>(&*value)) {
+        // Sign extension instructions get the value name of the base operand.
+        result = getValueName(sextInst->getOperand(0), depth + 1, budget);
+    }
+    else if (ConstantInt* constant = dyn_cast<ConstantInt>(&*value)) {
+        // Constant int values get the integer constant as the name,
+        // in base-10.
+        result = constant->getValue().toString(10, false);
+    }
+    else if (AllocaInst* allocaInst = dyn_cast<AllocaInst>(&*value)) {
+        // Allocation instructions get the string "description" of the type.
+        result = allocaInst->getAllocatedType()->getDescription();
+    }
+    else if (GetElementPtrInst* gepInst = dyn_cast<GetElementPtrInst>(&*value)) {
+        // get element pointer instructions are used for dereferencing
+        // arrays and other index based data structures.  The pointer
+        // operand is used as the name with the value name of the
+        // index is used with C-like syntax:
+        // <pointer>[<index>]
+        std::string value = getValueName(gepInst->getPointerOperand(), depth + 1, budget);
+
+        std::string index = getValueName(gepInst->getOperand(gepInst->getNumIndices()), depth + 1, budget);
+        value = value + "[" + index + "]";
+        result = value;
+    }
+    else if (BinaryOperator* binOp = dyn_cast<BinaryOperator>(&*value)) {
+        // Binary operators are mathematical operations that take two
+        // operands.  
+        switch (binOp->getOpcode()) {
+        case Instruction::SRem:
+            result = getValueName(binOp->getOperand(0), depth + 1, budget) + " % "
+                + getValueName(binOp->getOperand(1), depth + 1, budget);
+            break;
+        case Instruction::Sub:
+            result = getValueName(binOp->getOperand(0), depth + 1, budget) + " - "
+                + getValueName(binOp->getOperand(1), depth + 1, budget);
+            break;
+        case Instruction::Add:
+            result = getValueName(binOp->getOperand(0), depth + 1, budget) + " + "
+                + getValueName(binOp->getOperand(1), depth + 1, budget);
+            break;
+        case Instruction::Mul:
+            result = getValueName(binOp->getOperand(0), depth + 1, budget) + " * "
+                + getValueName(binOp->getOperand(1), depth + 1, budget);
+            break;
+        case Instruction::SDiv:
+            result = getValueName(binOp->getOperand(0), depth + 1, budget) + " / "
+                + getValueName(binOp->getOperand(1), depth + 1, budget);
+            break;
+        default:
+            // An undefined binary operator instruction results in the
+            // operator name and then the two operands it uses.
+            result = binOp->getOpcodeName();
+            result = result + " " + getValueName(binOp->getOperand(0), depth + 1, budget);
+            result = result + " " + getValueName(binOp->getOperand(1), depth + 1, budget);
+        }
+    }
+
+    // If we have not determined a result at this point, use the
+    // description of the value as the identifier.
+    if (result.length() == 0) {
+        result = value->getType()->getDescription();
+    }
+
+    return result;
+}
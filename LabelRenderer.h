@@ -0,0 +1,121 @@
+/*
+** LabelRenderer.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	LABELRENDERER_H_
+# define   	LABELRENDERER_H_
+
+#include "llvm/Instructions.h"
+
+#include <string>
+
+/**
+ * Determines the label to display for each instruction.  Labels are
+ * produced by a renderer function looked up in a table indexed by opcode,
+ * so determining a label costs a single indexed call regardless of the
+ * kind of instruction.  The table is filled in at compile time from
+ * llvm/Instruction.def with the built in renderers, and any entry can be
+ * replaced at runtime to render an instruction kind differently.  Calls to
+ * intrinsics can additionally be given a renderer per intrinsic.
+ *
+ * An empty label means the instruction is not displayed.
+ */
+class LabelRenderer {
+public:
+    /**
+     * A function producing the label for an instruction.
+     */
+    typedef std::string (*Renderer)(llvm::Instruction* instruction);
+
+    /**
+     * Determines the label to display for the supplied instruction.
+     * @param instruction The instruction to determine the label for.
+     */
+    static std::string render(llvm::Instruction* instruction);
+    /**
+     * Replaces the renderer used for every instruction with the supplied
+     * opcode.
+     * @param opcode The opcode (llvm::Instruction::Call, ...) to render.
+     * @param renderer The renderer to use, or NULL to restore the built in
+     * renderer.
+     */
+    static void registerRenderer(unsigned int opcode, Renderer renderer);
+    /**
+     * Sets the renderer used for calls to the supplied intrinsic.  Calls to
+     * intrinsics without a renderer are rendered like any other call.
+     * @param intrinsic The intrinsic (llvm::Intrinsic::memcpy, ...) to render.
+     * @param renderer The renderer to use, or NULL to remove it.
+     */
+    static void registerIntrinsicRenderer(unsigned int intrinsic, Renderer renderer);
+
+    /**
+     * The built in renderers, available for custom renderers to fall back
+     * on.
+     */
+    /**
+     * Determines the appropriate label to display for a call instruction.
+     * @param instruction the call instruction to determine the label for.
+     */
+    static std::string getCallInstructionLabel(llvm::CallInst* instruction);
+    /**
+     * Determines the appropriate label to display for a switch instruction.
+     * @param instruction the switch instruction to determine the label for.
+     */
+    static std::string getSwitchInstLabel(llvm::SwitchInst* instruction);
+    /**
+     * Determines the appropriate label to display for a store isntruction.
+     * @param instruction the store instruction to determine the label for.
+     */
+    static std::string getStoreInstLabel(llvm::StoreInst* instruction);
+    /**
+     * Determines the appropriate label to display for a conditional branch
+     * instruction.
+     * @param instruction the branch instruction to determine the label for.
+     */
+    static std::string getConditionalBranchLabel(llvm::BranchInst* instruction);
+    /**
+     * Determines the appropriate label to display for an invoke instruction.
+     * @param instruction The invoke instruction to determine the label for.
+     */
+    static std::string getInvokeInstLabel(llvm::InvokeInst* instruction);
+    /**
+     * Determines the label for instructions without specific handling:
+     * <instruction> <operand 1> <operand 2> <operand n>
+     * @param instruction The instruction to determine the label for.
+     */
+    static std::string getDefaultLabel(llvm::Instruction* instruction);
+    /**
+     * Converts a mangled (C++) symbol name to the unmangled version if it
+     * is a C++ mangled symbol name.  Otherwise, returns the supplied name
+     * unchanged.
+     * @param name The string to demangle.
+     */
+    static std::string getDemangledName(std::string name);
+    /**
+     * LLVM bytecode typically gets compiled down using temporary
+     * Values (most 'things' derive from Value).  Temporary Values
+     * don't have a name associated with them.  Some operations,
+     * such as sext (sign extend) and load (load data from memory)
+     * and bitcast (convert types) don't alter the fundamental
+     * behavior or stored values.  This traverses the hierarchy
+     * of instructions until it finds a Value with a name.  If 
+     * an instruction that modifies values is encountered, it
+     * returns an empty string.  Operand trees deeper or larger than a
+     * fixed bound are abbreviated as "...".
+     */
+    static std::string getValueName(llvm::Value* value);
+private:
+    /**
+     * Implements getValueName, tracking the depth of the operand tree
+     * walked so far and the number of operands that may still be visited.
+     * @param value The Value to name.
+     * @param depth The number of operands between value and the root.
+     * @param budget The remaining number of operands to visit.
+     */
+    static std::string getValueName(llvm::Value* value, unsigned int depth,
+                                    unsigned int& budget);
+};
+
+#endif 	    /* !LABELRENDERER_H_ */
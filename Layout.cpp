@@ -0,0 +1,242 @@
+#include "Layout.h"
+
+#include <algorithm>
+
+// The space left between two nodes of a layer and between two layers, in
+// points, as Graphviz leaves by default.
+static const double NodeSeparation = 18;
+static const double RankSeparation = 36;
+
+/**
+ * Orders nodes by a key, as std::stable_sort needs.
+ */
+struct KeyOrder {
+    KeyOrder(const std::vector<double>& keys) : keys(keys) {}
+    bool operator()(Graph::Index left, Graph::Index right) const
+    {
+        return keys[left] < keys[right];
+    }
+    const std::vector<double>& keys;
+};
+
+Layout::Layout() :
+    _layerCount(0),
+    _width(0),
+    _height(0)
+{
+}
+
+void
+Layout::compute(const Graph& graph, unsigned int sweeps)
+{
+    release();
+    Graph::Index nodes = graph.size();
+    if (nodes == 0) {
+        return;
+    }
+
+    // Only edges to a later node count; the rest close loops.  Nodes are
+    // visited in order, so every node pointing down to a node has been
+    // placed before it.
+    _layers.assign(nodes, 0);
+    std::vector<Graph::Index> predecessorOffsets(nodes + 1, 0);
+    for (Graph::Index node = 0; node < nodes; node++) {
+        for (Graph::Index edge = graph.getEdgesBegin(node);
+             edge < graph.getEdgesEnd(node);
+             edge++) {
+            Graph::Index target = graph.getEdgeTarget(edge);
+            if (target <= node) {
+                continue;
+            }
+            _layers[target] = std::max(_layers[target], _layers[node] + 1);
+            predecessorOffsets[target + 1]++;
+        }
+        _layerCount = std::max(_layerCount, _layers[node] + 1);
+    }
+
+    // Both directions of the downward edges are kept the same way as the
+    // graph keeps its edges, for the sweeps.
+    std::vector<Graph::Index> successorOffsets(nodes + 1, 0);
+    std::vector<Graph::Index> successors;
+    for (Graph::Index node = 0; node < nodes; node++) {
+        predecessorOffsets[node + 1] += predecessorOffsets[node];
+        for (Graph::Index edge = graph.getEdgesBegin(node);
+             edge < graph.getEdgesEnd(node);
+             edge++) {
+            if (graph.getEdgeTarget(edge) > node) {
+                successors.push_back(graph.getEdgeTarget(edge));
+            }
+        }
+        successorOffsets[node + 1] = successors.size();
+    }
+    std::vector<Graph::Index> predecessors(predecessorOffsets[nodes]);
+    std::vector<Graph::Index> filled(predecessorOffsets.begin(), predecessorOffsets.end() - 1);
+    for (Graph::Index node = 0; node < nodes; node++) {
+        for (Graph::Index edge = successorOffsets[node];
+             edge < successorOffsets[node + 1];
+             edge++) {
+            predecessors[filled[successors[edge]]++] = node;
+        }
+    }
+
+    // Each layer starts out in function order.
+    _layerOffsets.assign(_layerCount + 1, 0);
+    for (Graph::Index node = 0; node < nodes; node++) {
+        _layerOffsets[_layers[node] + 1]++;
+    }
+    for (unsigned int layer = 0; layer < _layerCount; layer++) {
+        _layerOffsets[layer + 1] += _layerOffsets[layer];
+    }
+    _layerNodes.resize(nodes);
+    _orders.resize(nodes);
+    filled.assign(_layerOffsets.begin(), _layerOffsets.end() - 1);
+    for (Graph::Index node = 0; node < nodes; node++) {
+        Graph::Index position = filled[_layers[node]]++;
+        _layerNodes[position] = node;
+        _orders[node] = position - _layerOffsets[_layers[node]];
+    }
+
+    for (unsigned int i = 0; i < sweeps; i++) {
+        if (i % 2 == 0) {
+            sweep(true, predecessorOffsets, predecessors);
+        } else {
+            sweep(false, successorOffsets, successors);
+        }
+    }
+
+    _widths.resize(nodes);
+    _heights.resize(nodes);
+    for (Graph::Index node = 0; node < nodes; node++) {
+        _widths[node] = getLabelWidth(graph.getLabel(node));
+        _heights[node] = getLabelHeight(graph.getLabel(node));
+    }
+    place();
+}
+
+void
+Layout::sweep(bool down, const std::vector<Graph::Index>& offsets,
+              const std::vector<Graph::Index>& neighbours)
+{
+    // Positions are measured from the middle of each layer, so layers of
+    // different widths line up on their centres as they are drawn.
+    std::vector<double> barycenters(_layers.size());
+    for (unsigned int step = 1; step < _layerCount; step++) {
+        unsigned int layer = down ? step : _layerCount - 1 - step;
+        Graph::Index begin = _layerOffsets[layer];
+        Graph::Index end = _layerOffsets[layer + 1];
+
+        for (Graph::Index i = begin; i < end; i++) {
+            Graph::Index node = _layerNodes[i];
+            double sum = 0;
+            for (Graph::Index n = offsets[node]; n < offsets[node + 1]; n++) {
+                Graph::Index neighbour = neighbours[n];
+                unsigned int width = _layerOffsets[_layers[neighbour] + 1] -
+                    _layerOffsets[_layers[neighbour]];
+                sum += _orders[neighbour] - (width - 1) / 2.0;
+            }
+            // Nodes without neighbours on that side stay where they are.
+            unsigned int count = offsets[node + 1] - offsets[node];
+            barycenters[node] = count > 0 ? sum / count : _orders[node] - (end - begin - 1) / 2.0;
+        }
+
+        std::stable_sort(_layerNodes.begin() + begin, _layerNodes.begin() + end,
+                         KeyOrder(barycenters));
+        for (Graph::Index i = begin; i < end; i++) {
+            _orders[_layerNodes[i]] = i - begin;
+        }
+    }
+}
+
+void
+Layout::place()
+{
+    Graph::Index nodes = _layers.size();
+    _xs.resize(nodes);
+    _ys.resize(nodes);
+
+    // Layers are placed from the top down, each centred on x = 0, then
+    // everything is moved so the bounding box starts at the origin.
+    double minX = 0;
+    double maxX = 0;
+    double top = 0;
+    for (unsigned int layer = 0; layer < _layerCount; layer++) {
+        double width = 0;
+        double height = 0;
+        for (Graph::Index i = _layerOffsets[layer]; i < _layerOffsets[layer + 1]; i++) {
+            if (i > _layerOffsets[layer]) {
+                width += NodeSeparation;
+            }
+            width += _widths[_layerNodes[i]];
+            height = std::max(height, _heights[_layerNodes[i]]);
+        }
+
+        double left = -width / 2;
+        for (Graph::Index i = _layerOffsets[layer]; i < _layerOffsets[layer + 1]; i++) {
+            Graph::Index node = _layerNodes[i];
+            _xs[node] = left + _widths[node] / 2;
+            _ys[node] = top + height / 2;
+            left += _widths[node] + NodeSeparation;
+        }
+        minX = std::min(minX, -width / 2);
+        maxX = std::max(maxX, width / 2);
+        top += height;
+        if (layer + 1 < _layerCount) {
+            top += RankSeparation;
+        }
+    }
+
+    _width = maxX - minX;
+    _height = top;
+    for (Graph::Index node = 0; node < nodes; node++) {
+        _xs[node] -= minX;
+        _ys[node] = _height - _ys[node];
+    }
+}
+
+void
+Layout::release()
+{
+    _layerCount = 0;
+    _width = 0;
+    _height = 0;
+    // Swapping with empty vectors actually frees the memory.
+    std::vector<unsigned int>().swap(_layers);
+    std::vector<unsigned int>().swap(_orders);
+    std::vector<Graph::Index>().swap(_layerOffsets);
+    std::vector<Graph::Index>().swap(_layerNodes);
+    std::vector<double>().swap(_widths);
+    std::vector<double>().swap(_heights);
+    std::vector<double>().swap(_xs);
+    std::vector<double>().swap(_ys);
+}
+
+void
+Layout::writePosition(std::ostream& out, Graph::Index node) const
+{
+    // Whole points are plenty, and keep the files small.
+    out << static_cast<long>(_xs[node] + 0.5) << "," << static_cast<long>(_ys[node] + 0.5);
+}
+
+double
+Layout::getLabelWidth(const std::string& label)
+{
+    // About 7 points per character of the longest line, plus the margins,
+    // and never narrower than Graphviz's default node.
+    std::string::size_type longest = 0;
+    std::string::size_type start = 0;
+    while (start <= label.length()) {
+        std::string::size_type end = label.find('\n', start);
+        if (end == std::string::npos) {
+            end = label.length();
+        }
+        longest = std::max(longest, end - start);
+        start = end + 1;
+    }
+    return std::max(54.0, longest * 7.0 + 16);
+}
+
+double
+Layout::getLabelHeight(const std::string& label)
+{
+    return 36 + 14.0 * std::count(label.begin(), label.end(), '\n');
+}
@@ -0,0 +1,122 @@
+/*
+** Layout.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	LAYOUT_H_
+# define   	LAYOUT_H_
+
+#include "Graph.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * A layered (Sugiyama style) layout of a Graph, cheap enough for graphs
+ * Graphviz takes minutes on.
+ *
+ * Nodes are already in function order, which stands in for a topological
+ * order: edges leading to a later node point down, and every other edge is
+ * taken to close a loop and doesn't affect the layering.  Each node sits one
+ * layer below the lowest node with an edge down to it.  Crossings are then
+ * reduced by a fixed number of barycenter sweeps alternating down and up,
+ * each sorting a layer by the mean position of its neighbours in the
+ * layers above or below.  No dummy nodes are added for edges spanning
+ * several layers and crossings are never counted, so every sweep is
+ * O(nodes log nodes + edges).
+ *
+ * Coordinates are in points with the origin at the bottom left, as in the
+ * pos attribute of DOT, and give the centre of each node.
+ */
+class Layout {
+public:
+    /**
+     * Constructor, creates an empty layout.
+     */
+    Layout();
+
+    /**
+     * Lays out a graph, replacing the current layout.
+     * @param graph The graph to lay out.
+     * @param sweeps The number of crossing reduction sweeps to run.
+     */
+    void compute(const Graph& graph, unsigned int sweeps);
+    /**
+     * Frees the layout, leaving it empty.
+     */
+    void release();
+
+    /**
+     * @return The number of nodes laid out.
+     */
+    Graph::Index size() const { return _layers.size(); }
+    /**
+     * @return The number of layers.
+     */
+    unsigned int getLayerCount() const { return _layerCount; }
+    /**
+     * @return The layer of a node, 0 being the top.
+     */
+    unsigned int getLayer(Graph::Index node) const { return _layers[node]; }
+    /**
+     * @return The position of a node within its layer, 0 being the left.
+     */
+    unsigned int getOrder(Graph::Index node) const { return _orders[node]; }
+    double getX(Graph::Index node) const { return _xs[node]; }
+    double getY(Graph::Index node) const { return _ys[node]; }
+    double getNodeWidth(Graph::Index node) const { return _widths[node]; }
+    double getNodeHeight(Graph::Index node) const { return _heights[node]; }
+    /**
+     * @return The size of the bounding box of every node.
+     */
+    double getWidth() const { return _width; }
+    double getHeight() const { return _height; }
+
+    /**
+     * Writes the position of a node as DOT expects it, "x,y".
+     * @param out The stream to write to.
+     * @param node The position of the node in the graph.
+     */
+    void writePosition(std::ostream& out, Graph::Index node) const;
+
+    /**
+     * @return An estimate of the size in points a label is drawn at in
+     * a 14 point font, with the margins Graphviz leaves around it.
+     */
+    static double getLabelWidth(const std::string& label);
+    static double getLabelHeight(const std::string& label);
+private:
+    /**
+     * Sorts the nodes of every layer but the first of a sweep by the
+     * barycenter of their neighbours in the layer before.
+     * @param down true to sweep from the top using the nodes above,
+     * false to sweep from the bottom using the nodes below.
+     * @param offsets The neighbours of node n are neighbours[offsets[n]]
+     * to neighbours[offsets[n + 1]].
+     */
+    void sweep(bool down, const std::vector<Graph::Index>& offsets,
+               const std::vector<Graph::Index>& neighbours);
+    /**
+     * Places the nodes of each layer side by side, centred on a common
+     * axis, with the layers stacked from the top.
+     */
+    void place();
+
+    unsigned int _layerCount;
+    double _width;
+    double _height;
+    std::vector<unsigned int> _layers;
+    std::vector<unsigned int> _orders;
+    // The nodes of layer l are _layerNodes[_layerOffsets[l]] to
+    // _layerNodes[_layerOffsets[l + 1]], left to right.
+    std::vector<Graph::Index> _layerOffsets;
+    std::vector<Graph::Index> _layerNodes;
+    std::vector<double> _widths;
+    std::vector<double> _heights;
+    std::vector<double> _xs;
+    std::vector<double> _ys;
+};
+
+#endif 	    /* !LAYOUT_H_ */
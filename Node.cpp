@@ -1,13 +1,63 @@
 #include "Node.h"
-#include "RocketShip.h"
 
+#include "llvm/ADT/APInt.h"
 #include "llvm/Instructions.h"
 #include "llvm/Support/raw_ostream.h"
 
-Node::Node(int identifier, Type type) :
+#include <algorithm>
+#include <sstream>
+
+/**
+ * Orders case values as unsigned integers, the way they are printed.
+ */
+static bool
+lessUnsigned(const llvm::APInt& left, const llvm::APInt& right)
+{
+    return left.ult(right);
+}
+
+/**
+ * Formats a set of switch case values as a compact, sorted list where
+ * runs of three or more consecutive values are collapsed into a range,
+ * e.g. "1..7, 12".  Values are compared and printed unsigned, whatever
+ * their width, like any other constant in a label.
+ * @param values The case values leading to a single destination.
+ */
+static std::string
+formatCaseValues(std::vector<llvm::APInt> values)
+{
+    std::ostringstream result;
+
+    std::sort(values.begin(), values.end(), lessUnsigned);
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+
+    for (std::vector<llvm::APInt>::size_type i = 0; i < values.size(); i++) {
+        std::vector<llvm::APInt>::size_type end = i;
+        while (end + 1 < values.size() && values[end + 1] == values[end] + 1) {
+            end++;
+        }
+
+        if (i != 0) {
+            result << ", ";
+        }
+        if (end - i >= 2) {
+            result << values[i].toString(10, false) << ".."
+                   << values[end].toString(10, false);
+            i = end;
+        } else {
+            result << values[i].toString(10, false);
+        }
+    }
+
+    return result.str();
+}
+
+Node::Node(StringTable& strings, int identifier, Type type) :
+    _strings(&strings),
     _nodeId(identifier),
     _nodeType(type),
-    _nodeName(""),
+    _nodeName(StringTable::Empty),
+    _nodeLabel(StringTable::Empty),
     _instruction(NULL)
 {
 
@@ -15,7 +65,11 @@ Node::Node(int identifier, Type type) :
 
 Node::~Node()
 {
-
+    for (std::vector<Edge*>::iterator it = _edges.begin();
+         it != _edges.end();
+         it++) {
+        delete *it;
+    }
 }
 
 int
@@ -36,18 +90,36 @@ Node::getNodeEdges()
     return _edges;
 }
 
-std::string
+const std::string&
 Node::getNodeName()
 {
-    return _nodeName;
+    return _strings->lookup(_nodeName);
 }
 
-std::string
+const std::string&
 Node::getNodeLabel()
+{
+    return _strings->lookup(_nodeLabel);
+}
+
+StringTable::Id
+Node::getNodeLabelId()
 {
     return _nodeLabel;
 }
 
+StringTable::Id
+Node::getNodeNameId()
+{
+    return _nodeName;
+}
+
+llvm::Instruction*
+Node::getInstruction()
+{
+    return _instruction;
+}
+
 void
 Node::setNodeId(int value)
 {
@@ -63,13 +135,13 @@ Node::setNodeType(Type value)
 void
 Node::setNodeName(std::string value)
 {
-    _nodeName = value;
+    _nodeName = _strings->intern(value);
 }
 
 void
 Node::setNodeLabel(std::string value)
 {
-    _nodeLabel = value;
+    _nodeLabel = _strings->intern(value);
 }
 
 void
@@ -83,18 +155,10 @@ Node::addNodeEdge(Edge* edge)
 {
     // Edges pointing to the same location are not allowed.  Each edge
     // must have a distinct id.
-    bool found = false;
-    for (std::vector<Edge*>::iterator it = _edges.begin();
-         it != _edges.end();
-         it++) {
-        if ((*it)->getId() == edge->getId()) {
-            found = true;
-            break;
-        }
-    }
-
-    if (!found) {
+    if (_edgeIds.insert(edge->getId()).second) {
         _edges.push_back(edge);
+    } else {
+        delete edge;
     }
 }
 
@@ -105,7 +169,10 @@ Node::removeNodeEdge(Edge* edge)
          it != _edges.end();
          it++) {
         if ((*it)->getId() == edge->getId()) {
+            Edge* removed = *it;
+            _edgeIds.erase(removed->getId());
             _edges.erase(it);
+            delete removed;
             break;
         }
     }
@@ -131,16 +198,36 @@ Node::getBlockEdges()
                 result.insert(std::pair<std::string, llvm::BasicBlock*>("x", Dest));
             }
         }
-        // Get Switch instruction edges
+        // Get Switch instruction edges.  Cases are grouped by
+        // destination so that every destination gets a single edge
+        // labelled with all of the values that lead to it.
         else if (llvm::SwitchInst* instruction = llvm::dyn_cast<llvm::SwitchInst>(&*_instruction)) {
             setNodeType(Node::DECISION);
             llvm::BasicBlock *defaultDest = instruction->getDefaultDest();
-            result.insert(std::pair<std::string, llvm::BasicBlock*>("default",defaultDest));
+            std::vector<llvm::BasicBlock*> destinations;
+            std::map<llvm::BasicBlock*, std::vector<llvm::APInt> > values;
+
+            destinations.push_back(defaultDest);
+            values[defaultDest];
 
-            for (unsigned int i = instruction->getNumSuccessors() - 1; i > 0; i--) {
+            for (unsigned int i = 1; i < instruction->getNumCases(); i++) {
                 llvm::BasicBlock* destination = instruction->getSuccessor(i);
-                std::string label = rocketship::RocketShip::getValueName(instruction->getCaseValue(i));
-                result.insert(std::pair<std::string, llvm::BasicBlock*>(label, destination));
+                llvm::ConstantInt* value = instruction->getCaseValue(i);
+
+                if (values.find(destination) == values.end()) {
+                    destinations.push_back(destination);
+                }
+                values[destination].push_back(value->getValue());
+            }
+
+            for (std::vector<llvm::BasicBlock*>::iterator it = destinations.begin();
+                 it != destinations.end();
+                 it++) {
+                std::string label = formatCaseValues(values[*it]);
+                if (*it == defaultDest) {
+                    label = label.length() > 0 ? "default, " + label : "default";
+                }
+                result.insert(std::pair<std::string, llvm::BasicBlock*>(label, *it));
             }
         }
         // Get Invoke instruction edges
@@ -11,7 +11,9 @@
 #ifndef   	NODE_H_
 # define   	NODE_H_
 
+#include "Accounting.h"
 #include "Edge.h"
+#include "StringTable.h"
 
 #include "llvm/BasicBlock.h"
 
@@ -19,6 +21,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 
 class Node;
 typedef boost::shared_ptr<Node> pNode;
@@ -37,18 +40,30 @@ public:
         START, /** begins a graph */
         ACTIVITY, /** indicates an operation that occurs */
         DECISION, /** indicates a branch in processing */
-        END /** indicates the end of a graph */
+        END, /** indicates the end of a graph */
+        ELIDED /** stands in for part of the graph that was left out */
     };
 
     /**
      * Constructor.
+     * @param strings The table the name and label are interned in.
      * @param identifier The unique integer id to associate with the
      * node.
      * @param type The type of node the object represents.
      */
-    Node(int identifier = 0, Type type = ACTIVITY);
+    Node(StringTable& strings, int identifier = 0, Type type = ACTIVITY);
+    /**
+     * Destructor, frees the edges leading from the node.
+     */
     ~Node();
 
+    /**
+     * Node objects are allocated through Accounting so their memory can be
+     * counted under NodeMemory.
+     */
+    static void* operator new(std::size_t size) { return Accounting::allocate(Accounting::NodeMemory, size); }
+    static void operator delete(void* object, std::size_t size) { Accounting::release(Accounting::NodeMemory, object, size); }
+
     /**
      * Data retrieval methods
      */
@@ -68,11 +83,22 @@ public:
     /**
      * @return the label assigned to the node.
      */
-    std::string getNodeLabel();
+    const std::string& getNodeLabel();
     /**
      * @return the name assigned to the node.
      */
-    std::string getNodeName();
+    const std::string& getNodeName();
+    /**
+     * @return the interned label and name, as held by the table the
+     * node was given.
+     */
+    StringTable::Id getNodeLabelId();
+    StringTable::Id getNodeNameId();
+    /**
+     * @return the instruction the node represents, or NULL if it doesn't
+     * represent one.
+     */
+    llvm::Instruction* getInstruction();
 
     /**
      * Data setting methods
@@ -99,15 +125,24 @@ public:
     void setNodeLabel(std::string value);
     void setInstruction(llvm::Instruction* instruction);
     
+    /**
+     * @return the table the strings of the node are interned in, for
+     * the edges leading from it.
+     */
+    StringTable& getStrings() { return *_strings; }
+
     /**
      * Add an edge leading from the node.  Each edge from the node
-     * must lead to a distinct node (e.g., no duplicates).
+     * must lead to a distinct node (e.g., no duplicates).  The node
+     * takes ownership of the edge, and frees it straight away if it is
+     * a duplicate.
      * @param edge The edge to add to the node.
      */
     void addNodeEdge(Edge* edge);
     /**
-     * Remove an edge leading from the node.
-     * @param edge The edge to remove.
+     * Remove and free the edge leading from the node to the same node as
+     * the supplied one, which may be that edge itself.
+     * @param edge An edge leading to the node to disconnect.
      */
     void removeNodeEdge(Edge* edge);
     /**
@@ -118,18 +153,26 @@ public:
      */
     std::map<std::string, llvm::BasicBlock*> getBlockEdges();
 private:
+    // Stores the table the strings of the node are interned in
+    StringTable* _strings;
     // Stores the associated unique id
     int _nodeId;
     // Stores the node type
     Type _nodeType;
-    // Stores the node name
-    std::string _nodeName;
-    // Stores the node label
-    std::string _nodeLabel;
-    // Stores each Edge leading from the node.
+    // Stores the interned node name
+    StringTable::Id _nodeName;
+    // Stores the interned node label
+    StringTable::Id _nodeLabel;
+    // Stores each Edge leading from the node, owned by the node.
     std::vector<Edge*> _edges;
+    // Stores the id each Edge leads to, for rejecting duplicates
+    // without scanning _edges.
+    std::set<std::string> _edgeIds;
 
     llvm::Instruction* _instruction;
+
+    Node(const Node&);
+    Node& operator=(const Node&);
 };
 
 #endif 	    /* !NODE_H_ */
@@ -0,0 +1,289 @@
+#include "OutputFile.h"
+#include "Fnv.h"
+
+#include <sstream>
+#include <unistd.h>
+
+const size_t OutputFile::Buffer::BufferSize;
+
+OutputFile::OutputFile(Compression compression, int level) :
+    std::ostream(NULL)
+{
+    rdbuf(&_buffer);
+    setCompression(compression, level);
+}
+
+OutputFile::~OutputFile()
+{
+    close();
+}
+
+void
+OutputFile::setCompression(Compression compression, int level)
+{
+    // Formats that weren't built in fall back to plain output.
+#ifndef ROCKETSHIP_HAVE_ZLIB
+    if (compression == GZIP) {
+        compression = NONE;
+    }
+#endif
+#ifndef ROCKETSHIP_HAVE_ZSTD
+    if (compression == ZSTD) {
+        compression = NONE;
+    }
+#endif
+    _compression = compression;
+    _level = level;
+}
+
+OutputFile::Compression
+OutputFile::getCompression()
+{
+    return _compression;
+}
+
+std::string
+OutputFile::getSuffix()
+{
+    switch (_compression) {
+    case GZIP:
+        return ".gz";
+    case ZSTD:
+        return ".zst";
+    case NONE:
+    default:
+        return "";
+    }
+}
+
+void
+OutputFile::open(const char* path)
+{
+    close();
+    clear();
+
+    // The process id keeps concurrent runs writing the same file apart.
+    std::ostringstream temporaryPath;
+    _path = std::string(path) + getSuffix();
+    temporaryPath << _path << ".tmp." << getpid();
+    _temporaryPath = temporaryPath.str();
+    if (!_buffer.open(_temporaryPath.c_str(), _compression, _level)) {
+        setstate(std::ios_base::failbit);
+    }
+}
+
+void
+OutputFile::close()
+{
+    if (!_buffer.isOpen()) {
+        return;
+    }
+
+    if (!_buffer.close() || bad() ||
+        rename(_temporaryPath.c_str(), _path.c_str()) != 0) {
+        unlink(_temporaryPath.c_str());
+        setstate(std::ios_base::failbit);
+    }
+}
+
+bool
+OutputFile::is_open()
+{
+    return _buffer.isOpen();
+}
+
+uint64_t
+OutputFile::getHash()
+{
+    return _buffer.getHash();
+}
+
+OutputFile::Buffer::Buffer() :
+    _file(NULL),
+    _compression(NONE),
+    _hash(Fnv::Empty)
+{
+#ifdef ROCKETSHIP_HAVE_ZSTD
+    _zstd = NULL;
+#endif
+    setp(_input, _input + BufferSize);
+}
+
+OutputFile::Buffer::~Buffer()
+{
+    close();
+#ifdef ROCKETSHIP_HAVE_ZSTD
+    if (_zstd != NULL) {
+        ZSTD_freeCStream(_zstd);
+    }
+#endif
+}
+
+bool
+OutputFile::Buffer::open(const char* path, Compression compression, int level)
+{
+    _file = fopen(path, "wb");
+    if (_file == NULL) {
+        return false;
+    }
+
+    _compression = compression;
+    _hash = Fnv::Empty;
+    setp(_input, _input + BufferSize);
+
+    switch (_compression) {
+#ifdef ROCKETSHIP_HAVE_ZLIB
+    case GZIP:
+        // A window of 15 + 16 asks zlib for a gzip header and trailer
+        // rather than a raw zlib stream.
+        _zlib.zalloc = Z_NULL;
+        _zlib.zfree = Z_NULL;
+        _zlib.opaque = Z_NULL;
+        if (deflateInit2(&_zlib, level < 0 ? Z_DEFAULT_COMPRESSION : level,
+                         Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            fclose(_file);
+            _file = NULL;
+            return false;
+        }
+        break;
+#endif
+#ifdef ROCKETSHIP_HAVE_ZSTD
+    case ZSTD:
+        // The context is kept between files to avoid reallocating it.
+        if (_zstd == NULL) {
+            _zstd = ZSTD_createCStream();
+        }
+        if (_zstd == NULL ||
+            ZSTD_isError(ZSTD_initCStream(_zstd, level < 0 ? 3 : level))) {
+            fclose(_file);
+            _file = NULL;
+            return false;
+        }
+        break;
+#endif
+    default:
+        break;
+    }
+
+    return true;
+}
+
+bool
+OutputFile::Buffer::close()
+{
+    if (_file == NULL) {
+        return true;
+    }
+
+    bool result = drain(true);
+
+#ifdef ROCKETSHIP_HAVE_ZLIB
+    if (_compression == GZIP) {
+        deflateEnd(&_zlib);
+    }
+#endif
+
+    if (fclose(_file) != 0) {
+        result = false;
+    }
+    _file = NULL;
+    return result;
+}
+
+bool
+OutputFile::Buffer::isOpen()
+{
+    return _file != NULL;
+}
+
+OutputFile::Buffer::int_type
+OutputFile::Buffer::overflow(int_type c)
+{
+    if (_file == NULL || !drain(false)) {
+        return traits_type::eof();
+    }
+
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+        return c;
+    }
+    return traits_type::not_eof(c);
+}
+
+int
+OutputFile::Buffer::sync()
+{
+    if (_file == NULL) {
+        return 0;
+    }
+    return drain(false) ? 0 : -1;
+}
+
+bool
+OutputFile::Buffer::drain(bool finish)
+{
+    size_t length = pptr() - pbase();
+    bool result = true;
+
+    switch (_compression) {
+#ifdef ROCKETSHIP_HAVE_ZLIB
+    case GZIP: {
+        // Keep deflating into the output buffer until zlib stops
+        // filling it (or, when finishing, until the stream has ended).
+        int status;
+        _zlib.next_in = reinterpret_cast<Bytef*>(pbase());
+        _zlib.avail_in = length;
+        do {
+            _zlib.next_out = reinterpret_cast<Bytef*>(_output);
+            _zlib.avail_out = BufferSize;
+            status = deflate(&_zlib, finish ? Z_FINISH : Z_NO_FLUSH);
+            if (status == Z_STREAM_ERROR) {
+                result = false;
+                break;
+            }
+            result = writeOut(_output, BufferSize - _zlib.avail_out) && result;
+        } while (finish ? status != Z_STREAM_END : _zlib.avail_out == 0);
+        break;
+    }
+#endif
+#ifdef ROCKETSHIP_HAVE_ZSTD
+    case ZSTD: {
+        ZSTD_inBuffer input = { pbase(), length, 0 };
+        while (result && input.pos < input.size) {
+            ZSTD_outBuffer output = { _output, BufferSize, 0 };
+            if (ZSTD_isError(ZSTD_compressStream(_zstd, &output, &input))) {
+                result = false;
+                break;
+            }
+            result = writeOut(_output, output.pos);
+        }
+        if (result && finish) {
+            size_t remaining;
+            do {
+                ZSTD_outBuffer output = { _output, BufferSize, 0 };
+                remaining = ZSTD_endStream(_zstd, &output);
+                if (ZSTD_isError(remaining)) {
+                    result = false;
+                    break;
+                }
+                result = writeOut(_output, output.pos);
+            } while (result && remaining > 0);
+        }
+        break;
+    }
+#endif
+    default:
+        result = writeOut(pbase(), length);
+    }
+
+    setp(_input, _input + BufferSize);
+    return result;
+}
+
+bool
+OutputFile::Buffer::writeOut(const char* data, size_t length)
+{
+    _hash = Fnv::extend(_hash, data, length);
+    return length == 0 || fwrite(data, 1, length, _file) == length;
+}
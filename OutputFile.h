@@ -0,0 +1,152 @@
+/*
+** OutputFile.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	OUTPUTFILE_H_
+# define   	OUTPUTFILE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+#ifdef ROCKETSHIP_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef ROCKETSHIP_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+/**
+ * An output file stream that can compress what is written to it on the
+ * fly.  Data passes through a fixed size buffer and is compressed and
+ * written out each time the buffer fills, so memory use does not depend
+ * on the size of the file.
+ *
+ * gzip support requires building with ROCKETSHIP_HAVE_ZLIB and zstd
+ * support with ROCKETSHIP_HAVE_ZSTD.  Asking for a compression that was
+ * not built in writes uncompressed output instead.
+ *
+ * Files are written under a temporary name next to the final one and
+ * renamed into place when closed, so a file is never seen half written,
+ * even by a concurrent run.  A file that couldn't be written in full is
+ * removed, leaving any previous version in place.
+ */
+class OutputFile : public std::ostream {
+public:
+    /**
+     * The supported compression formats.
+     */
+    enum Compression {
+        NONE, /** plain text */
+        GZIP, /** gzip, adds .gz to the filename */
+        ZSTD /** zstd, adds .zst to the filename */
+    };
+
+    /**
+     * Constructor, creates a stream that isn't attached to a file.
+     * @param compression The compression to apply to files opened.
+     * @param level The compression level, or -1 for the library default.
+     */
+    OutputFile(Compression compression = NONE, int level = -1);
+    /**
+     * Destructor, closes the file if one is open.
+     */
+    ~OutputFile();
+
+    /**
+     * Sets the compression applied to files opened from now on.
+     * @param compression The compression to apply.
+     * @param level The compression level, or -1 for the library default.
+     */
+    void setCompression(Compression compression, int level = -1);
+    /**
+     * @return The compression applied to files opened, after falling back
+     * for formats that weren't built in.
+     */
+    Compression getCompression();
+    /**
+     * @return The suffix appended to the names of files opened, e.g. ".gz".
+     */
+    std::string getSuffix();
+
+    /**
+     * Opens a file for writing, which replaces any existing file once
+     * closed.  The suffix for the compression in use is appended to the
+     * name.  The stream's fail bit is set if the file can't be opened.
+     * @param path The name of the file to open, without compression suffix.
+     */
+    void open(const char* path);
+    /**
+     * Flushes and finishes the compressed stream, closes the file and moves
+     * it into place.  The stream's fail bit is set if that fails.
+     */
+    void close();
+    /**
+     * @return true if a file is open.
+     */
+    bool is_open();
+    /**
+     * @return The hash of the bytes of the last file written, compressed
+     * as they are on disk.  Only meaningful once the file is closed.
+     */
+    uint64_t getHash();
+private:
+    /**
+     * The buffer the stream writes into.  Compresses and writes its contents
+     * whenever it fills up, is synced or is closed.
+     */
+    class Buffer : public std::streambuf {
+    public:
+        Buffer();
+        ~Buffer();
+
+        bool open(const char* path, Compression compression, int level);
+        bool close();
+        bool isOpen();
+        uint64_t getHash() { return _hash; }
+    protected:
+        virtual int_type overflow(int_type c);
+        virtual int sync();
+    private:
+        /**
+         * Compresses and writes everything in the put area.
+         * @param finish true to also end the compressed stream.
+         * @return true on success.
+         */
+        bool drain(bool finish);
+        /**
+         * Writes raw bytes to the file.
+         * @return true on success.
+         */
+        bool writeOut(const char* data, size_t length);
+
+        // Size of the uncompressed and compressed buffers.
+        static const size_t BufferSize = 64 * 1024;
+
+        FILE* _file;
+        Compression _compression;
+        // The hash of everything written to the file so far.
+        uint64_t _hash;
+        char _input[BufferSize];
+        char _output[BufferSize];
+#ifdef ROCKETSHIP_HAVE_ZLIB
+        z_stream _zlib;
+#endif
+#ifdef ROCKETSHIP_HAVE_ZSTD
+        ZSTD_CStream* _zstd;
+#endif
+    };
+
+    Buffer _buffer;
+    Compression _compression;
+    int _level;
+    // The name of the file open and the name it is written under.
+    std::string _path;
+    std::string _temporaryPath;
+};
+
+#endif 	    /* !OUTPUTFILE_H_ */
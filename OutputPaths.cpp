@@ -0,0 +1,164 @@
+#include "OutputPaths.h"
+#include "Fnv.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+const std::string::size_type OutputPaths::MaxNameLength;
+
+// The number of characters of a long identifier kept in its file name,
+// enough to tell functions apart when browsing.
+static const std::string::size_type KeptLength = 100;
+
+OutputPaths::OutputPaths() :
+    _depth(0)
+{
+}
+
+void
+OutputPaths::setRoot(const std::string& root)
+{
+    _root = root;
+    // A trailing slash would double up when joining.
+    while (_root.length() > 1 && _root[_root.length() - 1] == '/') {
+        _root.erase(_root.length() - 1);
+    }
+}
+
+void
+OutputPaths::setShardDepth(unsigned int depth)
+{
+    // Each level uses one byte of the 64 bit hash.
+    _depth = depth > 8 ? 8 : depth;
+}
+
+std::string
+OutputPaths::getFileName(const std::string& identifier)
+{
+    if (identifier.length() <= MaxNameLength) {
+        return identifier;
+    }
+
+    char hash[17];
+    sprintf(hash, "%016llx", static_cast<unsigned long long>(getHash(identifier)));
+    return identifier.substr(0, KeptLength) + "_" + hash;
+}
+
+std::string
+OutputPaths::getRelativePath(const std::string& identifier, const std::string& suffix) const
+{
+    return getShard(identifier) + getFileName(identifier) + suffix;
+}
+
+std::string
+OutputPaths::getPath(const std::string& identifier, const std::string& suffix)
+{
+    std::string shard = getShard(identifier);
+    std::string directory = _root.empty() ? shard : _root + "/" + shard;
+    if (!directory.empty()) {
+        makeDirectories(directory);
+    }
+    return directory + getFileName(identifier) + suffix;
+}
+
+std::string
+OutputPaths::getRootPath(const std::string& name)
+{
+    if (_root.empty()) {
+        return name;
+    }
+    makeDirectories(_root);
+    return _root + "/" + name;
+}
+
+std::string
+OutputPaths::getLink(const std::string& from, const std::string& to,
+                     const std::string& suffix) const
+{
+    // Every function is the same number of levels deep, so a link climbs
+    // out of all of them unless both share a directory.
+    std::string fromShard = getShard(from);
+    std::string toShard = getShard(to);
+    if (fromShard == toShard) {
+        return getFileName(to) + suffix;
+    }
+
+    std::string link;
+    for (unsigned int i = 0; i < _depth; i++) {
+        link += "../";
+    }
+    return link + toShard + getFileName(to) + suffix;
+}
+
+void
+OutputPaths::record(const std::string& identifier, const std::string& symbol)
+{
+    if (_recorded.insert(identifier).second) {
+        _manifest.push_back(std::pair<std::string, std::string>(getRelativePath(identifier, ""),
+                                                                symbol));
+    }
+}
+
+void
+OutputPaths::writeManifest(std::ostream& out)
+{
+    for (std::vector<std::pair<std::string, std::string> >::iterator it = _manifest.begin();
+         it != _manifest.end();
+         it++) {
+        out << it->first << "\t" << it->second << "\n";
+    }
+    _manifest.clear();
+    _recorded.clear();
+}
+
+uint64_t
+OutputPaths::getHash(const std::string& identifier)
+{
+    return Fnv::hash(identifier);
+}
+
+std::string
+OutputPaths::getShard(const std::string& identifier) const
+{
+    if (_depth == 0) {
+        return "";
+    }
+
+    // Levels take the hash a byte at a time from the top, so the first
+    // level alone spreads functions evenly.
+    uint64_t hash = getHash(identifier);
+    std::string shard;
+    for (unsigned int i = 0; i < _depth; i++) {
+        char level[4];
+        sprintf(level, "%02x/", static_cast<unsigned int>((hash >> (56 - i * 8)) & 0xff));
+        shard += level;
+    }
+    return shard;
+}
+
+void
+OutputPaths::makeDirectories(const std::string& path)
+{
+    if (_created.count(path) > 0) {
+        return;
+    }
+
+    // Each leading directory is made in turn; ones that already exist,
+    // possibly made by a concurrent run, are fine.
+    for (std::string::size_type slash = path.find('/', 1);
+         ;
+         slash = path.find('/', slash + 1)) {
+        std::string directory = path.substr(0, slash);
+        if (!directory.empty() && _created.count(directory) == 0) {
+            if (mkdir(directory.c_str(), 0777) == 0 || errno == EEXIST) {
+                _created.insert(directory);
+            }
+        }
+        if (slash == std::string::npos) {
+            break;
+        }
+    }
+    _created.insert(path);
+}
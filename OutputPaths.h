@@ -0,0 +1,125 @@
+/*
+** OutputPaths.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	OUTPUTPATHS_H_
+# define   	OUTPUTPATHS_H_
+
+#include <ostream>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Decides where the files of each function go.
+ *
+ * Files are written under a root directory, optionally spread over levels
+ * of shard subdirectories named by two hex digits of a hash of the
+ * function identifier, so no single directory holds more than a few
+ * hundred entries per thousand functions.  Identifiers too long for a
+ * file name are cut short and made unique again with the hash; a manifest
+ * records the full symbol behind every file name.
+ */
+class OutputPaths {
+public:
+    /**
+     * The longest file name used, before the suffixes.  Leaves room for
+     * the longest suffix, compression suffix and temporary file suffix
+     * within NAME_MAX.
+     */
+    static const std::string::size_type MaxNameLength = 200;
+
+    /**
+     * Constructor, places every file in the current directory.
+     */
+    OutputPaths();
+
+    /**
+     * @param root The directory to write under, or an empty string for
+     * the current directory.  It is created on first use.
+     */
+    void setRoot(const std::string& root);
+    /**
+     * @param depth The number of levels of shard subdirectories, at most
+     * 8.
+     */
+    void setShardDepth(unsigned int depth);
+
+    /**
+     * @return The file name for a function, without suffix: the
+     * identifier itself, or its first characters and its hash if it is
+     * longer than MaxNameLength.
+     */
+    static std::string getFileName(const std::string& identifier);
+    /**
+     * @return The path of a file of a function relative to the root, e.g.
+     * "3f/main.dot".
+     * @param identifier The sanitized identifier of the function.
+     * @param suffix Appended to the file name, e.g. ".dot".
+     */
+    std::string getRelativePath(const std::string& identifier, const std::string& suffix) const;
+    /**
+     * Returns the path to open a file of a function at, creating the
+     * directories leading to it.
+     * @param identifier The sanitized identifier of the function.
+     * @param suffix Appended to the file name, e.g. ".dot".
+     */
+    std::string getPath(const std::string& identifier, const std::string& suffix);
+    /**
+     * Returns the path to open a file that isn't a function's at, directly
+     * under the root, creating the root.
+     * @param name The name of the file.
+     */
+    std::string getRootPath(const std::string& name);
+    /**
+     * @return The link from any file of one function to a file of another,
+     * relative to the directory of the first.
+     * @param from The sanitized identifier of the function linking.
+     * @param to The sanitized identifier of the function linked to.
+     * @param suffix Appended to the file name linked to, e.g. ".dot".
+     */
+    std::string getLink(const std::string& from, const std::string& to,
+                        const std::string& suffix) const;
+
+    /**
+     * Notes the symbol a function's files were written for, for the
+     * manifest.  Each identifier is only recorded once.
+     * @param identifier The sanitized identifier of the function.
+     * @param symbol The name of the function in the module.
+     */
+    void record(const std::string& identifier, const std::string& symbol);
+    /**
+     * Writes the manifest: a line per recorded function, holding the
+     * path of its files relative to the root, without suffix, then a tab
+     * and its symbol.  Forgets the recorded functions.
+     * @param out The stream to write to.
+     */
+    void writeManifest(std::ostream& out);
+private:
+    /**
+     * @return The FNV-1a hash of an identifier.
+     */
+    static uint64_t getHash(const std::string& identifier);
+    /**
+     * @return The shard directories of a function, e.g. "3f/a0/", or an
+     * empty string without sharding.
+     */
+    std::string getShard(const std::string& identifier) const;
+    /**
+     * Creates a directory and those leading to it, if they don't exist.
+     */
+    void makeDirectories(const std::string& path);
+
+    std::string _root;
+    unsigned int _depth;
+    // Directories already created, so each is only made once.
+    std::set<std::string> _created;
+    std::set<std::string> _recorded;
+    std::vector<std::pair<std::string, std::string> > _manifest;
+};
+
+#endif 	    /* !OUTPUTPATHS_H_ */
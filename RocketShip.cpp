@@ -4,14 +4,39 @@
 #include "llvm/Module.h"
 #include "llvm/Function.h"
 #include "llvm/Instructions.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ProfileInfo.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include "Accounting.h"
 #include "Node.h"
 #include "Edge.h"
-
+#include "DotEmitter.h"
+#include "DotText.h"
+#include "Fnv.h"
+#include "GraphDiff.h"
+#include "GraphMLEmitter.h"
+#include "GraphServer.h"
+#include "GraphSlicer.h"
+#include "JsonEmitter.h"
+#include "LabelRenderer.h"
+#include "Layout.h"
+#include "OutputFile.h"
+#include "OutputPaths.h"
+#include "SvgEmitter.h"
+
+#include <algorithm>
 #include <vector>
+#include <set>
+#include <deque>
+#include <fnmatch.h>
 #include <fstream>
+#include <iomanip>
+#include <sstream>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 extern "C" {
 #include <demangle.h>
@@ -20,6 +45,341 @@ extern "C" {
 using namespace llvm;
 using namespace rocketship;
 
+/**
+ * When enabled, functions whose graphs are structurally identical to one
+ * that was already emitted (template instantiations, linkonce_odr copies
+ * across modules) are written as a short alias referencing the original
+ * instead of a full copy of the graph.
+ */
+static cl::opt<bool>
+DedupGraphs("rocketship-dedup",
+            cl::desc("Emit structurally identical function graphs once and alias the rest"),
+            cl::init(false));
+// The FNV offset basis the second digest of a canonical graph starts
+// from, so that it is independent of the first.
+static const uint64_t DedupCheckBasis = 0x6c62272e07bb0142ULL;
+
+/**
+ * When enabled, every function also gets a summary graph (level 0) and a
+ * graph with one node per loop or loop-free block (level 1), each linking
+ * into the next, more detailed level.
+ */
+static cl::opt<bool>
+LevelOfDetail("rocketship-lod",
+              cl::desc("Also emit summary and loop level graphs for each function"),
+              cl::init(false));
+
+/**
+ * Direct calls to functions with a body are expanded in place, up to the
+ * given depth of the call graph.  Each callee is expanded at most once per
+ * graph, and expansion stops once the budget of inlined nodes is spent.
+ */
+static cl::opt<unsigned int>
+InlineDepth("rocketship-inline-depth",
+            cl::desc("Expand direct callees into the caller's graph up to this call depth"),
+            cl::init(0));
+static cl::opt<unsigned int>
+InlineNodeBudget("rocketship-inline-budget",
+                 cl::desc("Maximum number of callee nodes expanded into a single graph"),
+                 cl::init(500));
+
+/**
+ * Uses the execution profile of the module (as loaded by -profile-loader)
+ * to label every edge with the number of times it was taken.  Blocks that
+ * executed fewer times than the cold threshold are left out of the graph,
+ * and edges into them lead to a single "cold paths elided" node instead.
+ */
+static cl::opt<bool>
+UseProfile("rocketship-profile",
+           cl::desc("Annotate edges with execution counts from the loaded profile"),
+           cl::init(false));
+static cl::opt<unsigned int>
+ColdThreshold("rocketship-cold-threshold",
+              cl::desc("Elide blocks executed fewer times than this in the profile"),
+              cl::init(0));
+
+/**
+ * Writes size and complexity figures for every function with a body to a
+ * single file per module, computed from the same traversal that builds the
+ * graphs.
+ */
+enum MetricsFormat {
+    NoMetrics,
+    CsvMetrics,
+    JsonMetrics
+};
+static cl::opt<MetricsFormat>
+Metrics("rocketship-metrics",
+        cl::desc("Write per-function metrics for each module"),
+        cl::values(clEnumValN(NoMetrics, "none", "No metrics file"),
+                   clEnumValN(CsvMetrics, "csv", "<module>.metrics.csv"),
+                   clEnumValN(JsonMetrics, "json", "<module>.metrics.json"),
+                   clEnumValEnd),
+        cl::init(NoMetrics));
+
+/**
+ * The formats every function graph is written in, as a comma separated
+ * list.  All of them are written from a single walk over the graph.
+ * Expanded callees are only drawn in DOT, and aliases, levels, diffs and
+ * degraded graphs are always DOT.  SVG is drawn with the built-in layout.
+ */
+enum GraphFormat {
+    DotFormat,
+    JsonFormat,
+    GraphMLFormat,
+    SvgFormat
+};
+static cl::list<GraphFormat>
+Formats("rocketship-format",
+        cl::desc("Formats to write function graphs in (default dot)"),
+        cl::values(clEnumValN(DotFormat, "dot", "<function>.dot"),
+                   clEnumValN(JsonFormat, "json", "<function>.json"),
+                   clEnumValN(GraphMLFormat, "graphml", "<function>.graphml"),
+                   clEnumValN(SvgFormat, "svg", "<function>.svg"),
+                   clEnumValEnd),
+        cl::CommaSeparated);
+
+/**
+ * Compresses graph files as they are written, so that large modules don't
+ * need the full uncompressed output on disk.  Compressed files get a .gz
+ * or .zst suffix, which links between graphs take into account.
+ */
+static cl::opt<OutputFile::Compression>
+Compression("rocketship-compress",
+            cl::desc("Compress the emitted graph files"),
+            cl::values(clEnumValN(OutputFile::NONE, "none", "Plain DOT files"),
+                       clEnumValN(OutputFile::GZIP, "gzip", "<function>.dot.gz"),
+                       clEnumValN(OutputFile::ZSTD, "zstd", "<function>.dot.zst"),
+                       clEnumValEnd),
+            cl::init(OutputFile::NONE));
+static cl::opt<int>
+CompressionLevel("rocketship-compress-level",
+                 cl::desc("Compression level, or -1 for the library default"),
+                 cl::init(-1));
+
+/**
+ * Compresses and writes files on a separate thread, up to this many files
+ * behind the function being built, which waits when the writer falls that
+ * far behind.  0 writes each file as it is finished, on the pass's thread.
+ */
+static cl::opt<unsigned int>
+WriteQueue("rocketship-write-queue",
+           cl::desc("Files that may wait for the writer thread, 0 to write synchronously"),
+           cl::init(2));
+
+/**
+ * Keeps a journal of the progress through each module in
+ * <module>.journal: the functions started and done, and the files written
+ * for them with a hash of their content.  A function that crashes the
+ * compiler is recorded as such on the way down.
+ */
+static cl::opt<bool>
+KeepJournal("rocketship-journal",
+            cl::desc("Record progress through each module in <module>.journal"),
+            cl::init(false));
+
+/**
+ * Picks up from the journal of an earlier run, which is kept on adding
+ * to: finished modules are skipped, and so are finished functions whose
+ * files are still intact and functions that crashed.
+ */
+static cl::opt<bool>
+Resume("rocketship-resume",
+       cl::desc("Skip the work the journal of an earlier run records as done"),
+       cl::init(false));
+
+/**
+ * With -rocketship-resume, processes the functions that crashed an earlier
+ * run again instead of skipping them, say once the pass has been fixed.
+ */
+static cl::opt<bool>
+RetryCrashed("rocketship-retry-crashed",
+             cl::desc("With -rocketship-resume, retry functions that crashed"),
+             cl::init(false));
+
+/**
+ * Counts the memory allocated for nodes, edges, blocks, shared_ptr control
+ * blocks, label strings, the block map, demangler output and files waiting
+ * to be written, and reports the totals and the peak of every function to
+ * stderr once the module has been processed.
+ */
+static cl::opt<bool>
+AccountMemory("rocketship-accounting",
+              cl::desc("Report memory use per function and data structure"),
+              cl::init(false));
+
+/**
+ * Budgets limiting the work spent on a single function.  A function with
+ * more instructions than allowed isn't processed at all; one that grows
+ * more displayed nodes than allowed, or takes longer than allowed, is
+ * abandoned part way.  Either way it is written in a degraded form instead,
+ * and listed with the reason at the end of the module.  0 means unlimited.
+ */
+static cl::opt<unsigned int>
+MaxInstructions("rocketship-max-instructions",
+                cl::desc("Degrade functions with more instructions than this"),
+                cl::init(0));
+static cl::opt<unsigned int>
+MaxNodes("rocketship-max-nodes",
+         cl::desc("Degrade functions whose graphs have more nodes than this"),
+         cl::init(0));
+static cl::opt<unsigned int>
+MaxMillis("rocketship-max-millis",
+          cl::desc("Degrade functions taking longer than this many milliseconds"),
+          cl::init(0));
+enum DegradeMode {
+    DegradeToBlocks,
+    DegradeToStub
+};
+static cl::opt<DegradeMode>
+Degrade("rocketship-degrade",
+        cl::desc("How to render functions over budget"),
+        cl::values(clEnumValN(DegradeToBlocks, "blocks", "One node per basic block"),
+                   clEnumValN(DegradeToStub, "stub", "A single node with the function's size"),
+                   clEnumValEnd),
+        cl::init(DegradeToBlocks));
+
+/**
+ * Compares every function graph against the graph written for it by a
+ * previous run, in the given directory, and writes only the graphs that
+ * changed, with added, changed and removed nodes and edges highlighted.
+ */
+static cl::opt<std::string>
+DiffDirectory("rocketship-diff",
+              cl::desc("Only write graphs that differ from those in this directory"),
+              cl::value_desc("directory"),
+              cl::init(""));
+
+/**
+ * Instead of writing graph files, serves single function graphs over a
+ * Unix socket at the given path, keeping modules loaded and rendered
+ * graphs cached (up to the cache size, in megabytes) between requests.
+ */
+static cl::opt<std::string>
+ServeSocket("rocketship-serve",
+            cl::desc("Serve function graphs over a Unix socket at this path"),
+            cl::value_desc("socket"),
+            cl::init(""));
+static cl::opt<unsigned int>
+ServeCacheSize("rocketship-serve-cache",
+               cl::desc("Megabytes of rendered graphs the server keeps"),
+               cl::init(64));
+
+/**
+ * Controls how the exception paths of invoke instructions are drawn.
+ * Blocks only reachable through the unwind destination of an invoke
+ * (landing pads, cleanups, rethrows) are either kept, all replaced by a
+ * single "exception exit" node, or left out along with the unwind edges.
+ */
+static cl::opt<GraphBuilder::UnwindMode>
+Unwind("rocketship-unwind",
+       cl::desc("How to draw the exception paths of invoke instructions"),
+       cl::values(clEnumValN(GraphBuilder::KeepUnwind, "keep", "Draw exception paths in full"),
+                  clEnumValN(GraphBuilder::CollapseUnwind, "collapse", "Draw a single exception exit node"),
+                  clEnumValN(GraphBuilder::DropUnwind, "drop", "Leave out unwind edges and exception paths"),
+                  clEnumValEnd),
+       cl::init(GraphBuilder::KeepUnwind));
+
+/**
+ * Graphs with more nodes than this are laid out by RocketShip itself, with
+ * every node pinned at its position in the DOT file, since Graphviz's own
+ * layout takes minutes on the largest of them.  0 leaves every layout to
+ * Graphviz.
+ */
+static cl::opt<unsigned int>
+LayoutThreshold("rocketship-layout-threshold",
+                cl::desc("Lay out graphs with more nodes than this without Graphviz (0 for never)"),
+                cl::init(0));
+
+/**
+ * The number of crossing reduction sweeps of the built-in layout.  More
+ * sweeps untangle more edges, each costing about as much as the layering.
+ */
+static cl::opt<unsigned int>
+LayoutSweeps("rocketship-layout-sweeps",
+             cl::desc("Crossing reduction sweeps of the built-in layout"),
+             cl::init(4));
+
+/**
+ * The directory graph, metrics and manifest files are written under,
+ * created if needed.  Defaults to the current directory.
+ */
+static cl::opt<std::string>
+OutputDirectory("rocketship-output-dir",
+                cl::desc("Directory to write graph files under"),
+                cl::init(""));
+
+/**
+ * Cut every graph down to the paths through the nodes matching a shell
+ * wildcard pattern, tried against the label of each node, the name of the
+ * function it calls and the name of its block.  -rocketship-slice-to keeps
+ * the paths from the start node to the matching nodes,
+ * -rocketship-slice-from everything reachable from them, and both
+ * together the paths from one to the other.
+ */
+static cl::opt<std::string>
+SliceTo("rocketship-slice-to",
+        cl::desc("Only emit the paths from the start node to nodes matching a pattern"),
+        cl::value_desc("pattern"),
+        cl::init(""));
+static cl::opt<std::string>
+SliceFrom("rocketship-slice-from",
+          cl::desc("Only emit what is reachable from nodes matching a pattern"),
+          cl::value_desc("pattern"),
+          cl::init(""));
+
+/**
+ * Spreads the files of functions over this many levels of subdirectories
+ * named by a hash of the function, so that modules with tens of thousands
+ * of functions don't end up in one huge directory.
+ */
+static cl::opt<unsigned int>
+ShardDepth("rocketship-shard-depth",
+           cl::desc("Levels of hashed subdirectories to spread graph files over"),
+           cl::init(0));
+
+/**
+ * Labels longer than this many characters have the long symbols in them,
+ * such as demangled template instantiations, replaced by short aliases
+ * (F1, F2, ...), and are cut short if still too long.  0 leaves labels
+ * as they are.
+ */
+static cl::opt<unsigned int>
+LabelBudget("rocketship-label-budget",
+            cl::desc("Longest label to write before aliasing long symbols (0 for no limit)"),
+            cl::init(0));
+
+/**
+ * @return true if function graphs are to be written in the format.
+ */
+static bool
+isFormatSelected(GraphFormat format)
+{
+    if (Formats.empty()) {
+        return format == DotFormat;
+    }
+    return std::find(Formats.begin(), Formats.end(), format) != Formats.end();
+}
+
+/**
+ * Writes the legend of the aliases used in a graph as a single DOT node,
+ * one left aligned line per alias.
+ * @param out The stream to write to.
+ * @param entries The aliases and the symbols they stand for.
+ */
+static void
+writeLegend(std::ostream& out, const SymbolLegend::Entries& entries)
+{
+    out << "rocketship_legend [label=\"";
+    for (SymbolLegend::Entries::const_iterator it = entries.begin();
+         it != entries.end();
+         it++) {
+        DotText::writeEscapedLabel(out, it->first + " = " + it->second);
+        out << "\\l";
+    }
+    out << "\" shape=note]\n";
+}
+
 bool
 RocketShip::runOnModule(Module &M) 
 {
@@ -29,20 +389,174 @@ RocketShip::runOnModule(Module &M)
     /**
      * The moduleIdentifier is used to uniquely identify the chart.
      * Unfortunately, DOT files can't handle any graph names or node
-     * names that contain '.'.  so we just swap it out for '_'.
+     * names that contain '.' (or most other punctuation), so they are
+     * escaped as '_' and their hex code.
      */
-    std::string moduleIdentifier = M.getModuleIdentifier();
-    std::replace(moduleIdentifier.begin(), moduleIdentifier.end(), '.', '_');
+    std::string moduleIdentifier = DotText::sanitizeIdentifier(M.getModuleIdentifier());
 
     Module::iterator funcStart;
 
+    // Function pointers are only meaningful within a module, and aliases
+    // are numbered per module.  Nothing holds an interned string of an
+    // earlier module after this, so the string table starts over.
+    resetCalleeGraphs();
+    _legend.clear();
+    _legend.setBudget(LabelBudget);
+    _moduleMetrics.clear();
+    _memoryPeaks.clear();
+    _degraded.clear();
+    _diffChanged = 0;
+    _diffAdded = 0;
+    _diffUnchanged = 0;
+
+    if (AccountMemory) {
+        Accounting::setEnabled(true);
+        Accounting::resetTotals();
+    }
+
+    if (!ServeSocket.empty()) {
+        // The profile is of this module only, and the server renders the
+        // functions of any module it loads, so it is left out.
+        _profile = NULL;
+        GraphServer server(*this, static_cast<size_t>(ServeCacheSize) * 1024 * 1024);
+        std::string error;
+        if (!server.run(ServeSocket, M, error)) {
+            errs() << "RocketShip: serving on " << ServeSocket << " failed: "
+                   << error << "\n";
+        }
+        return false;
+    }
+
+    if (UseProfile) {
+        _profile = &getAnalysis<ProfileInfo>();
+    }
+
+    _paths.setRoot(OutputDirectory);
+    _paths.setShardDepth(ShardDepth);
+
+    _writer.setQueueDepth(WriteQueue);
+    _writer.setCompression(Compression, CompressionLevel);
+    if (_writer.getCompression() != Compression) {
+        errs() << "RocketShip: requested compression is not built in, "
+               << "writing uncompressed graphs\n";
+    }
+
+    if (KeepJournal || Resume) {
+        std::string path = _paths.getRootPath(moduleIdentifier + ".journal");
+        std::string error;
+        if (!_journal.open(path, Resume, error)) {
+            errs() << "RocketShip: opening " << path << " failed: " << error
+                   << ", not keeping a journal\n";
+        } else if (Resume && isModuleFinished(M)) {
+            errs() << "RocketShip: " << moduleIdentifier
+                   << " was finished by an earlier run\n";
+            _journal.close();
+            return false;
+        }
+        _writer.setJournal(_journal.isOpen() ? &_journal : NULL);
+    }
+
     // processFunction generates an entry in _nodes for each contained
     // node.  Each node has it's edges defined.  This builds out the
     // list of nodes for each function to be emitted at a later time.
     for (funcStart = M.begin();
          funcStart != M.end();
          funcStart++) {
+        if (skipFunction(*funcStart)) {
+            continue;
+        }
+        // Each function is a unit of the journal, ended by the next.
+        _writer.beginUnit("function:" + getFunctionIdentifier(*funcStart));
+
+        if (!AccountMemory) {
+            processFunction(*funcStart);
+            continue;
+        }
+
+        // Peaks are measured from what is live before the function (the
+        // interned strings of earlier functions, mostly), so they reflect
+        // the function's own graph.
+        releaseGraph();
+        long baseline[Accounting::NumCategories];
+        long baselineTotal = 0;
+        for (int i = 0; i < Accounting::NumCategories; i++) {
+            baseline[i] = Accounting::getLive(static_cast<Accounting::Category>(i));
+            baselineTotal += baseline[i];
+        }
+        Accounting::resetPeaks();
+
         processFunction(*funcStart);
+        releaseGraph();
+
+        if (!funcStart->isDeclaration()) {
+            MemoryPeak peak;
+            peak.identifier = getFunctionIdentifier(*funcStart);
+            peak.total = Accounting::getPeakTotal() - baselineTotal;
+            for (int i = 0; i < Accounting::NumCategories; i++) {
+                peak.categories[i] =
+                    Accounting::getPeak(static_cast<Accounting::Category>(i)) - baseline[i];
+            }
+            _memoryPeaks.push_back(peak);
+        }
+    }
+
+    // The files covering the module as a whole are done last, so a
+    // module is finished once they are.
+    _writer.beginUnit("module");
+
+    // The manifest maps the file names, shortened or sharded, back to
+    // the functions they are for.
+    QueuedFile manifest(_writer);
+    manifest.open(_paths.getRootPath(moduleIdentifier + ".manifest").c_str());
+    _paths.writeManifest(manifest);
+    manifest.close();
+
+    if (!_legend.getEntries().empty()) {
+        QueuedFile legend(_writer);
+        legend.open(_paths.getRootPath(moduleIdentifier + ".legend").c_str());
+        const SymbolLegend::Entries& entries = _legend.getEntries();
+        for (SymbolLegend::Entries::const_iterator it = entries.begin();
+             it != entries.end();
+             it++) {
+            legend << it->first << "\t" << it->second << "\n";
+        }
+        legend.close();
+    }
+
+    if (Metrics != NoMetrics) {
+        emitMetrics(moduleIdentifier);
+    }
+
+    // Everything must be on disk before the pass returns, and failures
+    // are only known once the writer got to them.
+    _writer.endUnit();
+    std::vector<std::string> failures = _writer.takeFailures();
+    for (std::vector<std::string>::iterator it = failures.begin();
+         it != failures.end();
+         it++) {
+        errs() << "RocketShip: writing " << *it << " failed\n";
+    }
+    _writer.setJournal(NULL);
+    _journal.close();
+
+    if (AccountMemory) {
+        emitMemoryReport(moduleIdentifier);
+    }
+
+    if (!DiffDirectory.empty()) {
+        errs() << "RocketShip diff of " << moduleIdentifier << " against "
+               << DiffDirectory << ": " << _diffChanged << " changed, "
+               << _diffAdded << " new, " << _diffUnchanged << " unchanged\n";
+    }
+
+    if (!_degraded.empty()) {
+        errs() << "RocketShip degraded " << _degraded.size() << " function(s) in "
+               << moduleIdentifier << ":\n";
+        for (std::vector<std::pair<std::string, std::string> >::iterator it = _degraded.begin();
+             it != _degraded.end();
+             it++) {
+            errs() << "  " << it->first << ": " << it->second << "\n";
+        }
     }
 
     // Return false to indicate that we didn't alter the AST or module
@@ -50,603 +564,979 @@ RocketShip::runOnModule(Module &M)
     return false;
 }
 
+void
+RocketShip::getAnalysisUsage(AnalysisUsage &AU) const
+{
+    if (LevelOfDetail) {
+        AU.addRequired<LoopInfo>();
+    }
+    if (UseProfile) {
+        AU.addRequired<ProfileInfo>();
+    }
+    AU.setPreservesAll();
+}
+
 void
 RocketShip::processFunction(Function &F) {
-    // Everything is reset per function.  Ideally we would just make
-    // this a per-function pass, but extended feature plans make
-    // applying this at the module level a better idea.
-    _nodeId = 0;
-    _blockId = 0;
-    _blocks.clear();
-    _pnodes.clear();
-    
-    std::vector<BasicBlock*> blockList;
-
-    std::string functionLabel = F.getName();
-    std::string demangledLabel = getDemangledName(functionLabel);
-
-    if (demangledLabel == functionLabel ||
-        demangledLabel.length() == 0) {
-        functionLabel = F.getReturnType()->getDescription() + " " + functionLabel;
-        functionLabel = functionLabel + "(";
-        for (Function::arg_iterator arg = F.arg_begin();
-             arg != F.arg_end();
-             arg++) {
-            if (arg != F.arg_begin()) {
-                functionLabel = functionLabel + ", ";
-            }
-            functionLabel = functionLabel + arg->getType()->getDescription() + " " + std::string(arg->getName());
-        }
-        functionLabel = functionLabel + ")";
-    } else {
-        functionLabel = demangledLabel;
+    std::string functionLabel = buildGraph(F);
+
+    // Generates the function name and filename/output stream.
+    std::string functionIdentifier = getFunctionIdentifier(F);
+
+    // Whatever was built of a function over budget is thrown away in
+    // favour of a cheap rendering straight from the CFG.
+    if (!_degradeReason.empty()) {
+        std::string reason = _degradeReason;
+        releaseGraph();
+        _paths.record(functionIdentifier, F.getName());
+        _degraded.push_back(std::pair<std::string, std::string>(functionIdentifier, reason));
+        addDegradedMetrics(F, functionIdentifier, reason);
+        _outputFile.open(_paths.getPath(functionIdentifier, ".dot").c_str());
+        emitDegraded(F, functionIdentifier, functionLabel, reason, _outputFile);
+        _outputFile.close();
+        return;
     }
 
-    // Each block in the function needs to be processed and added to
-    // the mapping.
-    for (Function::iterator bblock = F.begin();
-         bblock != F.end();
-         bblock++) {
-        pBlock block(new Block(_nodeId++, bblock->getName()));
-        _blocks.insert(std::pair<BasicBlock*, pBlock>(bblock, block));
-        blockList.push_back(bblock);
+    if (Metrics != NoMetrics && !F.isDeclaration()) {
+        _functionMetrics.identifier = functionIdentifier;
+        countGraphMetrics();
+        _moduleMetrics.push_back(_functionMetrics);
+    }
+
+    // Metrics are of the whole function; everything written is of the
+    // slice.  A function with nothing to slice from or to gets no files.
+    if (!sliceGraph()) {
+        releaseGraph();
+        return;
+    }
+    _paths.record(functionIdentifier, F.getName());
 
-        if (bblock == F.begin()) {
-            pNode node(new Node(_nodeId++));
-            block->appendNode(node);
-            node->setNodeLabel(functionLabel);
-            node->setNodeType(Node::START);
+    // In diff mode only the function's own graph is compared and
+    // written; aliases, levels and expanded callees are left out.
+    if (!DiffDirectory.empty()) {
+        if (!F.isDeclaration()) {
+            emitDiff(functionIdentifier);
         }
-        processBlock(bblock, block);
+        return;
     }
 
-    // Each block needs to process its contained nodes and we need to
-    // keep a local copy of each node for later processing.
-    for (std::map<BasicBlock*, pBlock>::iterator it = _blocks.begin();
-         it != _blocks.end();
-         it++) {
-        it->second->processNodes(_blocks);
-        Nodes nodes = it->second->getNodes();
-        for (Nodes::iterator node = nodes.begin();
-             node != nodes.end();
-             node++) {
-            _pnodes.push_back(*node);
+    // LoopInfo can only be computed for functions with a body.  Levels
+    // are written for aliases too, ending at the alias graph, which
+    // links on to the original.
+    if (LevelOfDetail && !F.isDeclaration()) {
+        emitLevels(F, getAnalysis<LoopInfo>(F), functionIdentifier, functionLabel);
+    }
+
+    // A graph that has already been emitted under another name only
+    // gets a reference to the original.
+    if (DedupGraphs && !F.isDeclaration()) {
+        std::string canonical = getCanonicalGraph();
+        uint64_t hash = Fnv::hash(canonical);
+        uint64_t check = Fnv::extend(DedupCheckBasis, canonical.data(), canonical.length());
+        EmittedGraphs::iterator original = _emittedGraphs.find(hash);
+        if (original != _emittedGraphs.end() && original->second.check == check) {
+            // A copy of the same name, a linkonce_odr function from an
+            // earlier module, already wrote this graph to the same file.
+            if (original->second.identifier != functionIdentifier) {
+                emitAlias(functionIdentifier, functionLabel, original->second.identifier);
+            }
+            return;
+        }
+        if (original == _emittedGraphs.end()) {
+            EmittedGraph emitted;
+            emitted.check = check;
+            emitted.identifier = functionIdentifier;
+            _emittedGraphs.insert(std::pair<uint64_t, EmittedGraph>(hash, emitted));
         }
     }
 
-    // Generates the function name and filename/output stream.
-    std::string functionIdentifier = F.getName();
-    char* result = cplus_demangle(functionIdentifier.c_str(), DMGL_ANSI|DMGL_PARAMS);
+    _legend.beginGraph();
+    abbreviateLabels(F);
 
-    std::replace(functionIdentifier.begin(), functionIdentifier.end(), '.', '_');
-    _outputFile.open(std::string(functionIdentifier + ".dot").c_str());
+    // Graphs over the threshold are laid out here rather than by
+    // Graphviz.  SVG is always drawn from the built-in layout.
+    Layout layout;
+    bool positioned = LayoutThreshold > 0 && _graph.size() > LayoutThreshold;
+    if (positioned || isFormatSelected(SvgFormat)) {
+        layout.compute(_graph, LayoutSweeps);
+    }
 
-    _outputFile << "digraph " << functionIdentifier << " {\n";
+    // Every selected format is written from the one walk over the
+    // graph, each to its own file.
+    std::vector<GraphEmitter*> emitters;
+    std::ostream* dot = NULL;
+    if (isFormatSelected(DotFormat)) {
+        _outputFile.open(_paths.getPath(functionIdentifier, ".dot").c_str());
+        DotEmitter* emitter = new DotEmitter(_outputFile);
+        if (positioned) {
+            emitter->setLayout(&layout);
+        }
+        emitters.push_back(emitter);
+        dot = &_outputFile;
+    }
+    if (isFormatSelected(JsonFormat)) {
+        _jsonFile.open(_paths.getPath(functionIdentifier, ".json").c_str());
+        emitters.push_back(new JsonEmitter(_jsonFile));
+    }
+    if (isFormatSelected(GraphMLFormat)) {
+        _graphmlFile.open(_paths.getPath(functionIdentifier, ".graphml").c_str());
+        emitters.push_back(new GraphMLEmitter(_graphmlFile));
+    }
+    if (isFormatSelected(SvgFormat)) {
+        _svgFile.open(_paths.getPath(functionIdentifier, ".svg").c_str());
+        emitters.push_back(new SvgEmitter(_svgFile, layout));
+    }
+
+    emitGraph(F, functionIdentifier, functionLabel, emitters, dot);
 
-    // Emit each node to the output stream.  This should be modified
-    // to have the node print itself out by passing in the output
-    // stream rather than calling a separate function
-    for (Nodes::iterator it = _pnodes.begin();
-         it != _pnodes.end();
+    for (std::vector<GraphEmitter*>::iterator it = emitters.begin();
+         it != emitters.end();
          it++) {
-        if ((*it) == NULL) {
-            continue;
-        }
+        delete *it;
+    }
+    _outputFile.close();
+    _jsonFile.close();
+    _graphmlFile.close();
+    _svgFile.close();
+}
 
-        // We only care about nodes with labels since they are what is
-        // actually presented.
-        if ((*it)->getNodeLabel().length() > 0) {
-            emitNode(&(*(*it)));
+bool
+RocketShip::isModuleFinished(Module &M)
+{
+    if (!_journal.isFinished("module")) {
+        return false;
+    }
+    // The files of every function are checked too, not only the manifest.
+    for (Module::iterator it = M.begin(); it != M.end(); it++) {
+        std::string unit = "function:" + getFunctionIdentifier(*it);
+        bool skipped = _journal.hasCrashed(unit) && !RetryCrashed;
+        if (!skipped && !_journal.isFinished(unit)) {
+            return false;
         }
     }
+    return true;
+}
 
-    _outputFile << "}";
-    _outputFile.close();
+bool
+RocketShip::skipFunction(Function &F)
+{
+    if (!Resume || !_journal.isOpen()) {
+        return false;
+    }
+
+    // A function that crashed would most likely crash again.  It is left
+    // without files and the journal keeps it as crashed, unless asked to
+    // try again.
+    std::string functionIdentifier = getFunctionIdentifier(F);
+    std::string unit = "function:" + functionIdentifier;
+    if (_journal.hasCrashed(unit) && !RetryCrashed) {
+        _degraded.push_back(std::pair<std::string, std::string>(
+            functionIdentifier, "crashed an earlier run, skipped"));
+        addDegradedMetrics(F, functionIdentifier, "crashed an earlier run, skipped");
+        return true;
+    }
+
+    // The metrics, the legend and the diff counts of a module cover the
+    // functions processed in the run, so with any of them every function
+    // is processed again.
+    if (Metrics != NoMetrics || LabelBudget > 0 || !DiffDirectory.empty()) {
+        return false;
+    }
+    if (!_journal.isFinished(unit)) {
+        return false;
+    }
+    _paths.record(functionIdentifier, F.getName());
+    return true;
 }
 
-void
-RocketShip::processBlock(BasicBlock* bblock, pBlock block)
+std::string
+RocketShip::renderFunction(Function &F)
 {
-    // Create a node for each instruction in the block and append it
-    // to the block.
-    for (BasicBlock::iterator instruction = bblock->begin();
-         instruction != bblock->end();
-         instruction++) {
-        pNode node(new Node(_nodeId++));
-        block->appendNode(node);
-        processInstruction(instruction, node);
+    std::ostringstream out;
+    std::string functionLabel = buildGraph(F);
+    std::string functionIdentifier = getFunctionIdentifier(F);
+
+    if (!_degradeReason.empty()) {
+        std::string reason = _degradeReason;
+        releaseGraph();
+        emitDegraded(F, functionIdentifier, functionLabel, reason, out);
+    } else if (!sliceGraph()) {
+        out << "digraph " << functionIdentifier << " {\n}";
+    } else {
+        _legend.beginGraph();
+        abbreviateLabels(F);
+        DotEmitter emitter(out);
+        Layout layout;
+        if (LayoutThreshold > 0 && _graph.size() > LayoutThreshold) {
+            layout.compute(_graph, LayoutSweeps);
+            emitter.setLayout(&layout);
+        }
+        std::vector<GraphEmitter*> emitters(1, &emitter);
+        emitGraph(F, functionIdentifier, functionLabel, emitters, &out);
     }
+    releaseGraph();
+    // Nothing holds an id once the graph is rendered, and a server left
+    // to intern for every request would fill the table.
+    _strings.clear();
+
+    return out.str();
 }
 
 void
-RocketShip::processInstruction(Instruction* instruction, pNode node)
+RocketShip::resetCalleeGraphs()
 {
-    // Assign the instruction and generate the node label.
-    node->setInstruction(instruction);
-    node->setNodeLabel(getLabelForNode(instruction));
+    _calleeGraphs.clear();
+    releaseGraph();
+    _strings.clear();
 }
 
-void
-RocketShip::emitNode(Node* node)
+bool
+RocketShip::sliceGraph()
 {
-    /**
-     * This is all kinds of hacky.  The entire processing structure
-     * and internal storage of nodes should be modified, but it'd be
-     * hard to beat the speed of this, seeing as it's O(n).  This
-     * works because of how DOT files are specified.  Node
-     * "definitions" can occur anywhere and "node edge definitions"
-     * can occur anywhere.  In practice, the current model is to
-     * generate the definition of the node, followed by the edges
-     * leading away from the node.
-     */
+    if (SliceTo.empty() && SliceFrom.empty()) {
+        return true;
+    }
 
-    std::string name = node->getNodeName();
-    std::vector<Edge*> edges = node->getNodeEdges();
-    
-    // First, DOT files can't have '.' as identifiers, so all '.'s are
-    // replaced with '_'.
-    std::replace(name.begin(), name.end(), '.', '_');
+    Graph::Index start = _graph.find(_startNodeId);
+    std::vector<Graph::Index> sources;
+    std::vector<Graph::Index> sinks;
+    for (Graph::Index node = 0; node < _graph.size(); node++) {
+        if (!SliceFrom.empty() && matchesNode(SliceFrom, node)) {
+            sources.push_back(node);
+        }
+        if (!SliceTo.empty() && matchesNode(SliceTo, node)) {
+            sinks.push_back(node);
+        }
+    }
+    if (SliceFrom.empty() && start != Graph::None) {
+        sources.push_back(start);
+    }
+    if (sources.empty() || (!SliceTo.empty() && sinks.empty())) {
+        return false;
+    }
 
-    /**
-     * This begins the node definition in the file.  The node
-     * definition includes the identifier (name or id), the label to
-     * display for it and the shape of the node.  The format used is
-     * node_identifier [label="<label>" shape="<shape>"]
-     */ 
-    // If the node has a name assigned to it (in practice, only
-    // functions have names assigned), emit the name, otherwise,
-    // use the node id that was assigned.
-    if (name.length() > 0) {
-        _outputFile << name;
-    } else {
-        _outputFile << node->getNodeId();
-    }
-
-    // Again, nice and hacky.  If a node doesn't have any edges to
-    // follow (remember, this is a directed graph), it must be an end
-    // node.
-    if (edges.size() == 0) {
-        node->setNodeType(Node::END);
-    }
-
-    // Every node has a label, even if that label is an empty string.
-    // This greatly simplifies processing, but requires getNodeLable()
-    // to return an empty string rather than NULL if a label hasn't
-    // been assigned.
-    _outputFile << " [label=\"" << node->getNodeLabel() << "\"";
-    // Emit the shape to draw for the node.  To match the graphs,
-    // start should technically be a filled circle with no name, end
-    // should be a filled circle with a concentric circle with no
-    // name.  The default is box since we don't have a way of knowing
-    // what actual node type it is (makes it easy to add new node
-    // types without needing special handling until it's known).
-    _outputFile << " shape=";
-    switch(node->getNodeType()) {
-    case Node::START:
-        //_outputFile << "circle";
-        _outputFile << "none";
-        break;
-    case Node::END:
-        //_outputFile << "doublecircle";
-        _outputFile << "none";
-        break;
-    case Node::DECISION:
-        _outputFile << "diamond";
-        break;
-    case Node::ACTIVITY:
-    default:
-        _outputFile << "box";
-    }
-
-    _outputFile << "]\n";
-    /**
-     * This ends the node definition portion.  The node will be
-     * displayed in the graph and potentially have edges leading to
-     * it.  At this point, no edges lead away from the node.
-     */
+    Graph slice(_strings);
+    GraphSlicer::slice(_graph, start, sources, SliceTo.empty() ? NULL : &sinks, slice);
+    _graph.swap(slice);
+    return true;
+}
 
-    /**
-     * This begins the node edge definition portion.  
-     */
-    // An entry in the file needs to occur with the following format
-    // for the edges leading away from the node:
-    // node_identifier -> subsequent_node_identifier [label="<label>"]
-    // <label> is the label to apply to the edge, not to a node.
-    for (std::vector<Edge*>::iterator i = edges.begin();
-         i != edges.end();
-         i++) {
-        // Again, output the name or the id associated with the node.
-        // This should theoretically be stored and reused, or linked
-        // to a single call, or something.
-        if (name.length() > 0) {
-            _outputFile << name << " -> ";
-        } else {
-            _outputFile << node->getNodeId() << " -> ";
+bool
+RocketShip::matchesNode(const std::string& pattern, Graph::Index node)
+{
+    if (fnmatch(pattern.c_str(), _graph.getLabel(node).c_str(), 0) == 0) {
+        return true;
+    }
+
+    Instruction* instruction = _graph.getInstruction(node);
+    if (instruction == NULL) {
+        return false;
+    }
+    Function* callee = NULL;
+    if (CallInst* call = dyn_cast<CallInst>(instruction)) {
+        callee = call->getCalledFunction();
+    } else if (InvokeInst* invoke = dyn_cast<InvokeInst>(instruction)) {
+        callee = invoke->getCalledFunction();
+    }
+    if (callee != NULL && fnmatch(pattern.c_str(), std::string(callee->getName()).c_str(), 0) == 0) {
+        return true;
+    }
+    return fnmatch(pattern.c_str(), std::string(instruction->getParent()->getName()).c_str(), 0) == 0;
+}
+
+void
+RocketShip::abbreviateLabels(Function &F)
+{
+    if (_legend.getBudget() == 0) {
+        return;
+    }
+
+    // The symbols worth aliasing are the function's own name, in the
+    // start node, and the names of the functions called.  Demangling
+    // is only repeated for the labels over budget.
+    std::string functionName;
+    for (Graph::Index node = 0; node < _graph.size(); node++) {
+        const std::string& label = _graph.getLabel(node);
+        if (label.length() <= _legend.getBudget()) {
+            continue;
         }
 
-        // Naming conventions of classes fail here.  Edge defines a
-        // toId() method that returns the associated id, whether it is
-        // the unique integer id of the node or a name associated with
-        // it.
-        _outputFile << (*i)->getId();
-        
-        // The label associated with the edge, typically empty but is
-        // currently true/false for edges leading from decision nodes.
-        _outputFile << "[label=\"" << (*i)->getLabel() << "\"]";
+        if (functionName.empty()) {
+            functionName = LabelRenderer::getDemangledName(F.getName());
+        }
+        std::vector<std::string> symbols(1, functionName);
+        Function* callee = NULL;
+        if (CallInst* call = dyn_cast_or_null<CallInst>(_graph.getInstruction(node))) {
+            callee = call->getCalledFunction();
+        } else if (InvokeInst* invoke = dyn_cast_or_null<InvokeInst>(_graph.getInstruction(node))) {
+            callee = invoke->getCalledFunction();
+        }
+        if (callee != NULL) {
+            symbols.push_back(LabelRenderer::getDemangledName(callee->getName()));
+        }
 
-        _outputFile << "\n";
+        _graph.setLabel(node, _strings.intern(_legend.abbreviate(label, symbols)));
     }
 }
 
-std::string
-RocketShip::getCallInstructionLabel(CallInst* instruction)
+void
+RocketShip::emitGraph(Function &F,
+                      std::string functionIdentifier,
+                      std::string functionLabel,
+                      const std::vector<GraphEmitter*>& emitters,
+                      std::ostream* dot)
 {
-    // A call instruction is the execution of a function.  The final
-    // output format is:
-    // call <function name> (<operand 1>, <operand 2>, <operand 3>)
-    std::string result = instruction->getOpcodeName();
-    std::string calledName = "";
+    for (std::vector<GraphEmitter*>::const_iterator it = emitters.begin();
+         it != emitters.end();
+         it++) {
+        (*it)->beginGraph(functionIdentifier, functionLabel);
+    }
+
+    // The graph only holds nodes with labels, since they are what is
+    // actually presented.
+    GraphEmitter::emitNodes(_graph, emitters);
+
+    // Callee expansion rebuilds the member state for each callee, so
+    // it has to come after everything that uses this function's graph.
+    if (dot != NULL && InlineDepth > 0 && !F.isDeclaration()) {
+        std::vector<CallEdge> calls;
+        std::ostringstream entry;
+        entry << getDotId(_startNodeId);
+        collectCalls("", calls);
+        emitCallees(F, entry.str(), calls, *dot);
+    }
 
-    // Even if we are unable to get the called function, the function
-    // signature can be generated later on.
-    if (instruction->getCalledFunction() != NULL) {
-        calledName = instruction->getCalledFunction()->getName();
+    // The legend comes last so it covers the expanded callees too.
+    if (dot != NULL && !_legend.getGraphEntries().empty()) {
+        writeLegend(*dot, _legend.getGraphEntries());
     }
 
-    std::string resultName = getDemangledName(calledName);
+    for (std::vector<GraphEmitter*>::const_iterator it = emitters.begin();
+         it != emitters.end();
+         it++) {
+        (*it)->endGraph();
+    }
+}
 
-    result = result + " " + resultName;
+std::string
+RocketShip::buildGraph(Function &F)
+{
+    GraphBuilder::Options options;
+    options.maxInstructions = MaxInstructions;
+    options.maxNodes = MaxNodes;
+    options.maxMillis = MaxMillis;
+    options.unwind = Unwind;
+    options.profile = _profile;
+    options.coldThreshold = ColdThreshold;
+    options.summarizeBlocks = LevelOfDetail;
+
+    GraphBuilder builder(options);
+    std::string functionLabel = builder.build(F, _graph);
+    _startNodeId = builder.getStartNodeId();
+    _degradeReason = builder.getDegradeReason();
+    _blockSummaries = builder.getBlockSummaries();
+
+    const GraphBuilder::Statistics& statistics = builder.getStatistics();
+    _functionMetrics = FunctionMetrics();
+    _functionMetrics.instructions = statistics.instructions;
+    _functionMetrics.calls = statistics.calls;
+    _functionMetrics.maxSwitchFanOut = statistics.maxSwitchFanOut;
+
+    return functionLabel;
+}
 
-    // Append the arguments from the operands.
-    if (calledName.compare(resultName) == 0 &&
-        instruction->getCalledFunction() != NULL) {
-        result = result + " (";
+void
+RocketShip::releaseGraph()
+{
+    _blockSummaries.clear();
+    _graph.release();
+}
 
-        for (unsigned int i = 1; i < instruction->getNumOperands(); i++) {
-            if (i != 1) {
-                result = result + ", ";
-            }
+std::string
+RocketShip::getDotId(int nodeId)
+{
+    Graph::Index node = _graph.find(nodeId);
+    if (node != Graph::None) {
+        return _graph.getDotId(node);
+    }
+
+    std::ostringstream id;
+    id << nodeId;
+    return id.str();
+}
+
+std::string
+RocketShip::getFunctionIdentifier(Function &F)
+{
+    // DOT files can't have '.' (or most other punctuation) in
+    // identifiers, so they are escaped as '_' and their hex code.
+    return DotText::sanitizeIdentifier(F.getName());
+}
 
-            result = result + getValueName(instruction->getOperand(i));
+void
+RocketShip::collectCalls(std::string prefix, std::vector<CallEdge>& calls)
+{
+    // Only direct calls to functions with a body can be expanded.
+    for (Graph::Index node = 0; node < _graph.size(); node++) {
+        Function* callee = NULL;
+        if (CallInst* call = dyn_cast_or_null<CallInst>(_graph.getInstruction(node))) {
+            callee = call->getCalledFunction();
+        } else if (InvokeInst* invoke = dyn_cast_or_null<InvokeInst>(_graph.getInstruction(node))) {
+            callee = invoke->getCalledFunction();
         }
 
-        result = result + ")";
+        if (callee != NULL && !callee->isDeclaration()) {
+            std::ostringstream caller;
+            caller << prefix;
+            _graph.writeDotId(caller, node);
+            calls.push_back(CallEdge(caller.str(), callee));
+        }
     }
- 
-    return result;
 }
 
-std::string
-RocketShip::getSwitchInstLabel(SwitchInst* instruction)
+RocketShip::CalleeGraph&
+RocketShip::getCalleeGraph(Function* callee)
 {
-    // Switch instruction labels are handled solely by getValueName to
-    // determine the appropriate symbol that is checked.
-    std::string label = instruction->getOpcodeName();
+    std::map<Function*, CalleeGraph>::iterator cached = _calleeGraphs.find(callee);
+    if (cached != _calleeGraphs.end()) {
+        return cached->second;
+    }
+
+    // Node ids restart at 0 for every function, so every node of the
+    // callee is prefixed with its identifier to keep them distinct
+    // from the caller's within the one DOT file.
+    CalleeGraph graph;
+    std::string prefix = getFunctionIdentifier(*callee) + "_";
+    std::ostringstream body;
+    std::ostringstream entry;
+
+    graph.identifier = getFunctionIdentifier(*callee);
+    graph.label = buildGraph(*callee);
+    graph.nodes = 0;
+
+    // A callee over budget is expanded as a single node and not
+    // followed any further.
+    if (!_degradeReason.empty()) {
+        graph.entry = prefix + "degraded";
+        body << graph.entry << " [label=\"";
+        DotText::writeEscapedLabel(body, graph.label + "\nnot expanded: " + _degradeReason);
+        body << "\" shape=note]\n";
+        graph.body = body.str();
+        graph.nodes = 1;
+        releaseGraph();
+        return _calleeGraphs.insert(std::pair<Function*, CalleeGraph>(callee, graph)).first->second;
+    }
 
-    label = label + " " + getValueName(instruction->getCondition());
+    entry << prefix << getDotId(_startNodeId);
+    graph.entry = entry.str();
+
+    // The callee's aliases are kept apart from those of the graph it is
+    // being expanded into, which gets them when the body is included.
+    SymbolLegend::Entries callerLegend = _legend.getGraphEntries();
+    _legend.beginGraph();
+    abbreviateLabels(*callee);
+    graph.legend = _legend.getGraphEntries();
+    _legend.beginGraph();
+    _legend.addGraphEntries(callerLegend);
+
+    DotEmitter emitter(body, prefix);
+    for (Graph::Index node = 0; node < _graph.size(); node++) {
+        emitter.emitNode(_graph, node);
+    }
+    graph.nodes = _graph.size();
+    graph.body = body.str();
+    collectCalls(prefix, graph.calls);
 
-    return label;
+    return _calleeGraphs.insert(std::pair<Function*, CalleeGraph>(callee, graph)).first->second;
 }
 
-std::string
-RocketShip::getStoreInstLabel(StoreInst* instruction)
+void
+RocketShip::emitCallees(Function &F, std::string entry, std::vector<CallEdge> calls,
+                        std::ostream& out)
 {
-    // Assignment/memory storage, uses := to indicate assignment.
-    std::string label = getValueName(instruction->getPointerOperand());
+    // Breadth first over the call graph, so each callee is expanded at
+    // the shallowest depth it is reached from.  Every callee is
+    // expanded at most once; later calls to it (including recursive
+    // calls back into F) just get an edge to the existing copy.
+    std::map<Function*, std::string> entries;
+    std::deque<PendingCall> pending;
+    unsigned int inlinedNodes = 0;
+
+    entries.insert(std::pair<Function*, std::string>(&F, entry));
+    for (std::vector<CallEdge>::iterator call = calls.begin();
+         call != calls.end();
+         call++) {
+        pending.push_back(PendingCall(*call, 1));
+    }
 
-    label = label + " := ";
+    while (!pending.empty()) {
+        PendingCall call = pending.front();
+        pending.pop_front();
 
-    label = label + getValueName(instruction->getOperand(0));
+        std::map<Function*, std::string>::iterator expanded =
+            entries.find(call.first.second);
+        if (expanded != entries.end()) {
+            out << call.first.first << " -> " << expanded->second
+                << " [style=dashed]\n";
+            continue;
+        }
 
-    return label;
+        if (call.second > InlineDepth) {
+            continue;
+        }
+
+        CalleeGraph& graph = getCalleeGraph(call.first.second);
+        if (inlinedNodes + graph.nodes > InlineNodeBudget) {
+            continue;
+        }
+        inlinedNodes += graph.nodes;
+
+        out << "subgraph cluster_" << graph.identifier << " {\n";
+        out << "label=\"";
+        DotText::writeEscapedLabel(out, graph.label);
+        out << "\"\n";
+        out << graph.body;
+        out << "}\n";
+        _legend.addGraphEntries(graph.legend);
+        out << call.first.first << " -> " << graph.entry
+            << " [style=dashed]\n";
+        entries.insert(std::pair<Function*, std::string>(call.first.second, graph.entry));
+
+        for (std::vector<CallEdge>::iterator next = graph.calls.begin();
+             next != graph.calls.end();
+             next++) {
+            pending.push_back(PendingCall(*next, call.second + 1));
+        }
+    }
 }
 
-std::string
-RocketShip::getConditionalBranchLabel(BranchInst* instruction)
+void
+RocketShip::emitAlias(std::string functionIdentifier,
+                      std::string functionLabel,
+                      std::string original)
 {
-    std::string label = instruction->getOpcodeName();
-
-    if (CmpInst *condition = dyn_cast<CmpInst>(instruction->getCondition())) {
-        label = "";
-
-        // Determine the name to use for the first value for comparison
-        label = getValueName(condition->getOperand(0));
-
-        // The comparison predicate is the method in which the two
-        // values are compared. ICMP is integer comparison, FCMP is
-        // floating point comparison.  For the purposes of generating
-        // the graph, the difference between the two is meaningless.
-        // Instead, simply convert the type of comparison to general
-        // C-like comparison operators.
-        switch (condition->getPredicate()) {
-        // Equality comparison
-        case CmpInst::ICMP_EQ:
-        case CmpInst::FCMP_OEQ:
-            label = label + " == ";
-            break;
-        // Inequality comparison
-        case CmpInst::ICMP_NE:
-        case CmpInst::FCMP_ONE:
-            label = label + " != ";
-            break;
-        // Greater than signed/unsigned comparison
-        case CmpInst::ICMP_UGT:
-        case CmpInst::ICMP_SGT:
-        case CmpInst::FCMP_OGT:
-            label = label + " > ";
-            break;
-        // Greater than or equal signed/unsigned comparison
-        case CmpInst::ICMP_UGE:
-        case CmpInst::ICMP_SGE:
-        case CmpInst::FCMP_OGE:
-            label = label + " >= ";
-            break;
-        // Less than signed/unsigned comparison
-        case CmpInst::ICMP_ULT:
-        case CmpInst::ICMP_SLT:
-        case CmpInst::FCMP_OLT:
-            label = label + " < ";
-            break;
-        // Less than or equal signed/unsigned comparison
-        case CmpInst::ICMP_ULE:
-        case CmpInst::ICMP_SLE:
-        case CmpInst::FCMP_OLE:
-            label = label + " <= ";
-            break;
-        // Floating point comparisons that haven't been mapped into
-        // the current model due to them specifying handling of NaN
-        // and Infinity values.  Should decide about these eventually
-        // and add them.
-        case CmpInst::FCMP_FALSE:
-        case CmpInst::FCMP_ORD:
-        case CmpInst::FCMP_UNO:
-        case CmpInst::FCMP_UEQ:
-        case CmpInst::FCMP_UGT:
-        case CmpInst::FCMP_UGE:
-        case CmpInst::FCMP_ULT:
-        case CmpInst::FCMP_ULE:
-        case CmpInst::FCMP_UNE:
-        case CmpInst::FCMP_TRUE:
-            break;
-        default:
-            break;
-        }
-
-        // Add the second value that is being compared against.
-        label = label + getValueName(condition->getOperand(1));
-    }
-
-    return label;
+    // The alias is a single node graph so that anything looking up the
+    // function by name still finds a file, with a link to the graph
+    // that holds the actual content.
+    _outputFile.open(_paths.getPath(functionIdentifier, ".dot").c_str());
+
+    _outputFile << "digraph " << functionIdentifier << " {\n";
+    _outputFile << functionIdentifier << " [label=\"";
+    DotText::writeEscapedLabel(_outputFile, functionLabel + "\nsame graph as " + original);
+    _outputFile << "\" shape=note URL=\"" << _paths.getLink(functionIdentifier, original, ".dot")
+                << _outputFile.getSuffix() << "\"]\n";
+    _outputFile << "}";
+    _outputFile.close();
 }
 
-std::string
-RocketShip::getInvokeInstLabel(InvokeInst* instruction)
+void
+RocketShip::emitDiff(std::string functionIdentifier)
 {
-    // Invoke instructions are identical to call instructions except
-    // that they can result in a branch if an exception is
-    // thrown/stack should unwind, etc.
-    std::string label = "invoke";
-    std::string calledName = "";
+    // The current graph goes through the same text form as the previous
+    // one, so both are compared exactly as they would be written.
+    std::ostringstream current;
+    DotEmitter emitter(current);
+    for (Graph::Index node = 0; node < _graph.size(); node++) {
+        emitter.emitNode(_graph, node);
+    }
 
-    if (instruction->getCalledFunction() != NULL) {
-        calledName = instruction->getCalledFunction()->getName();
+    GraphDiff diff;
+    std::istringstream currentText(current.str());
+    diff.readCurrent(currentText);
+
+    std::string previousPath = DiffDirectory + "/" + _paths.getRelativePath(functionIdentifier, ".dot");
+    std::ifstream previous(previousPath.c_str());
+    if (previous.is_open()) {
+        diff.readPrevious(previous);
+        if (!diff.isChanged()) {
+            _diffUnchanged++;
+            return;
+        }
+        _diffChanged++;
+    } else {
+        _diffAdded++;
     }
 
-    if (calledName.length() > 0) {
-        char* demangled = cplus_demangle(calledName.c_str(), DMGL_ANSI|DMGL_PARAMS);
+    _outputFile.open(_paths.getPath(functionIdentifier, ".dot").c_str());
+    _outputFile << "digraph " << functionIdentifier << " {\n";
+    diff.write(_outputFile);
+    _outputFile << "}";
+    _outputFile.close();
+}
 
-        if (demangled != NULL) {
-            label = label + " " + std::string(demangled);
-            free(demangled);
+void
+RocketShip::emitDegraded(Function &F,
+                         std::string functionIdentifier,
+                         std::string functionLabel,
+                         std::string reason,
+                         std::ostream& out)
+{
+    unsigned int instructions = 0;
+    for (Function::iterator bblock = F.begin();
+         bblock != F.end();
+         bblock++) {
+        instructions += bblock->size();
+    }
+
+    std::ostringstream summary;
+    summary << functionLabel << "\n" << F.size() << " blocks, "
+            << instructions << " instructions\nnot rendered: " << reason;
+
+    out << "digraph " << functionIdentifier << " {\n";
+    out << functionIdentifier << " [label=\"";
+    DotText::writeEscapedLabel(out, summary.str());
+    out << "\" shape=note]\n";
+
+    if (Degrade == DegradeToBlocks && !F.isDeclaration()) {
+        // One node per block, linked by the CFG, which takes a single
+        // pass over the terminators.
+        std::map<BasicBlock*, unsigned int> blockIds;
+        unsigned int blockId = 0;
+        for (Function::iterator bblock = F.begin();
+             bblock != F.end();
+             bblock++) {
+            blockIds.insert(std::pair<BasicBlock*, unsigned int>(bblock, blockId++));
+        }
+
+        out << functionIdentifier << " -> b0\n";
+        for (Function::iterator bblock = F.begin();
+             bblock != F.end();
+             bblock++) {
+            std::ostringstream label;
+            label << std::string(bblock->getName()) << "\n"
+                  << bblock->size() << " instructions";
+            out << "b" << blockIds[bblock] << " [label=\"";
+            DotText::writeEscapedLabel(out, label.str());
+            out << "\" shape=box]\n";
+
+            TerminatorInst* terminator = bblock->getTerminator();
+            if (terminator == NULL) {
+                continue;
+            }
+            for (unsigned int i = 0; i < terminator->getNumSuccessors(); i++) {
+                out << "b" << blockIds[bblock] << " -> b"
+                    << blockIds[terminator->getSuccessor(i)] << "\n";
+            }
+        }
+    }
+
+    out << "}";
+}
+
+void
+RocketShip::emitLevels(Function &F, LoopInfo &loops,
+                       std::string functionIdentifier,
+                       std::string functionLabel)
+{
+    // Every block belongs to exactly one level 1 unit: the outermost
+    // loop containing it, or the block itself.  Unit identifiers are
+    // built from the internal block ids, which only depend on the
+    // position of the block in the function, so links into a level
+    // stay valid between runs.
+    std::map<BasicBlock*, std::string> units;
+    std::vector<std::string> unitOrder;
+    std::map<std::string, std::string> unitLabels;
+    std::map<std::string, int> unitTargets;
+    unsigned int instructionCount = 0;
+
+    for (Function::iterator bblock = F.begin();
+         bblock != F.end();
+         bblock++) {
+        instructionCount += bblock->size();
+
+        // Blocks dropped by -rocketship-unwind=drop have no unit.
+        GraphBuilder::BlockSummaries::iterator mapped = _blockSummaries.find(bblock);
+        if (mapped == _blockSummaries.end()) {
+            continue;
+        }
+        const GraphBuilder::BlockSummary& block = mapped->second;
+        std::ostringstream unit;
+        std::ostringstream label;
+
+        // The block a unit is entered by: the header of a loop.
+        int entry = block.entry;
+        Loop* loop = loops.getLoopFor(bblock);
+        if (loop != NULL) {
+            while (loop->getParentLoop() != NULL) {
+                loop = loop->getParentLoop();
+            }
+            GraphBuilder::BlockSummaries::iterator header =
+                _blockSummaries.find(loop->getHeader());
+            if (header == _blockSummaries.end()) {
+                continue;
+            }
+            entry = header->second.entry;
+            unit << "loop_" << header->second.id;
+            label << "loop " << std::string(loop->getHeader()->getName())
+                  << "\n" << loop->getBlocks().size() << " blocks";
         } else {
-            label = label + " " + std::string(instruction->getCalledFunction()->getName())
-                + "(";
-
-            for (unsigned int i = 1; i < instruction->getNumOperands(); i++) {
-                if (i != 1) {
-                    label = label + ", ";
-                }
-                label = label + getValueName(instruction->getOperand(i));
+            unit << "block_" << block.id;
+            label << "block " << block.label
+                  << "\n" << bblock->size() << " instructions";
+        }
+
+        units.insert(std::pair<BasicBlock*, std::string>(bblock, unit.str()));
+        if (unitLabels.find(unit.str()) == unitLabels.end()) {
+            unitOrder.push_back(unit.str());
+            unitLabels.insert(std::pair<std::string, std::string>(unit.str(), label.str()));
+            // The unit links to the full graph if the first node of
+            // its entry block is displayed there.
+            unitTargets.insert(std::pair<std::string, int>(unit.str(), entry));
+        }
+    }
+
+    // Level 1 edges are the CFG edges between different units.
+    std::vector<std::pair<std::string, std::string> > unitEdges;
+    std::set<std::pair<std::string, std::string> > seenEdges;
+    for (Function::iterator bblock = F.begin();
+         bblock != F.end();
+         bblock++) {
+        TerminatorInst* terminator = bblock->getTerminator();
+        if (terminator == NULL) {
+            continue;
+        }
+        for (unsigned int i = 0; i < terminator->getNumSuccessors(); i++) {
+            std::map<BasicBlock*, std::string>::iterator from = units.find(bblock);
+            std::map<BasicBlock*, std::string>::iterator to =
+                units.find(terminator->getSuccessor(i));
+            if (from == units.end() || to == units.end()) {
+                continue;
+            }
+            std::pair<std::string, std::string> edge(from->second, to->second);
+            if (edge.first != edge.second && seenEdges.insert(edge).second) {
+                unitEdges.push_back(edge);
             }
-            label = label + ")";
         }
     }
-    
-    return label;
+
+    unsigned int displayedCount = _graph.size();
+
+    // Level 0: a single node summarizing the function.
+    _outputFile.open(_paths.getPath(functionIdentifier, ".L0.dot").c_str());
+    _outputFile << "digraph " << functionIdentifier << "_L0 {\n";
+    std::ostringstream summary;
+    summary << functionLabel << "\n" << F.size() << " blocks, "
+            << instructionCount << " instructions, "
+            << displayedCount << " nodes, "
+            << (loops.end() - loops.begin()) << " outermost loops";
+    _outputFile << functionIdentifier << " [label=\"";
+    DotText::writeEscapedLabel(_outputFile, summary.str());
+    _outputFile << "\" shape=box URL=\"" << _paths.getLink(functionIdentifier, functionIdentifier, ".L1.dot")
+                << _outputFile.getSuffix() << "\"]\n";
+    _outputFile << "}";
+    _outputFile.close();
+
+    // Level 1: one node per unit.
+    _outputFile.open(_paths.getPath(functionIdentifier, ".L1.dot").c_str());
+    _outputFile << "digraph " << functionIdentifier << "_L1 {\n";
+    for (std::vector<std::string>::iterator unit = unitOrder.begin();
+         unit != unitOrder.end();
+         unit++) {
+        _outputFile << *unit << " [label=\"";
+        DotText::writeEscapedLabel(_outputFile, unitLabels[*unit]);
+        _outputFile << "\"";
+        _outputFile << " shape=" << (unit->compare(0, 5, "loop_") == 0 ? "box3d" : "box");
+        // Blocks summarized before slicing may have no node left in
+        // the slice to link to.  Graphviz makes no anchors out of node
+        // ids, so the link is to the file as a whole.
+        if (unitTargets[*unit] >= 0 && _graph.find(unitTargets[*unit]) != Graph::None) {
+            _outputFile << " URL=\"" << _paths.getLink(functionIdentifier, functionIdentifier, ".dot")
+                        << _outputFile.getSuffix() << "\"";
+        }
+        _outputFile << "]\n";
+    }
+    for (std::vector<std::pair<std::string, std::string> >::iterator edge = unitEdges.begin();
+         edge != unitEdges.end();
+         edge++) {
+        _outputFile << edge->first << " -> " << edge->second << "\n";
+    }
+    _outputFile << "}";
+    _outputFile.close();
 }
 
-std::string
-RocketShip::getValueName(Value* value)
+void
+RocketShip::countGraphMetrics()
 {
-    // Recursively calls itself to resolve the base symbol represented
-    // by value.  This is due to the nature of LLVM having "unlimited"
-    // registers which results in not all Value's having associated
-    // names.  We assume that the first Value in the chain that has a
-    // name is the name we want to use.
-    std::string result;
-    
-    if (value->hasName()) {
-        result = value->getName();
-
-        char* demangled = cplus_demangle(result.c_str(), DMGL_ANSI|DMGL_PARAMS);
-        if (demangled != NULL) {
-            result = std::string(demangled);
-            free(demangled);
-        }
-        return result;
-    }
-
-    if (CastInst* castInst = dyn_cast<CastInst>(&*value)) {
-        // Cast instructions get the value name of the base operand
-        result = getValueName(castInst->getOperand(0));
-    }
-    else if (LoadInst* loadInst = dyn_cast<LoadInst>(&*value)) {
-        // Load instructions get the value name of the item pointed to
-        result = getValueName(loadInst->getPointerOperand());
-    }
-    else if (SExtInst* sextInst = dyn_cast<SExtInst>(&*value)) {
-        // Sign extension instructions get the value name of the base operand.
-        result = getValueName(sextInst->getOperand(0));
-    }
-    else if (ConstantInt* constant = dyn_cast<ConstantInt>(&*value)) {
-        // Constant int values get the integer constant as the name,
-        // in base-10.
-        result = constant->getValue().toString(10, false);
-    }
-    else if (AllocaInst* allocaInst = dyn_cast<AllocaInst>(&*value)) {
-        // Allocation instructions get the string "description" of the type.
-        result = allocaInst->getAllocatedType()->getDescription();
-    }
-    else if (GetElementPtrInst* gepInst = dyn_cast<GetElementPtrInst>(&*value)) {
-        // get element pointer instructions are used for dereferencing
-        // arrays and other index based data structures.  The pointer
-        // operand is used as the name with the value name of the
-        // index is used with C-like syntax:
-        // <pointer>[<index>]
-        std::string value = getValueName(gepInst->getPointerOperand());
-
-        std::string index = getValueName(gepInst->getOperand(gepInst->getNumIndices()));
-        value = value + "[" + index + "]";
-        result = value;
-    }
-    else if (BinaryOperator* binOp = dyn_cast<BinaryOperator>(&*value)) {
-        // Binary operators are mathematical operations that take two
-        // operands.  
-        switch (binOp->getOpcode()) {
-        case Instruction::SRem:
-            result = getValueName(binOp->getOperand(0)) + " % "
-                + getValueName(binOp->getOperand(1));
-            break;
-        case Instruction::Sub:
-            result = getValueName(binOp->getOperand(0)) + " - "
-                + getValueName(binOp->getOperand(1));
-            break;
-        case Instruction::Add:
-            result = getValueName(binOp->getOperand(0)) + " + "
-                + getValueName(binOp->getOperand(1));
-            break;
-        case Instruction::Mul:
-            result = getValueName(binOp->getOperand(0)) + " * "
-                + getValueName(binOp->getOperand(1));
-            break;
-        case Instruction::SDiv:
-            result = getValueName(binOp->getOperand(0)) + " / "
-                + getValueName(binOp->getOperand(1));
-            break;
-        default:
-            // An undefined binary operator instruction results in the
-            // operator name and then the two operands it uses.
-            result = binOp->getOpcodeName();
-            result = result + " " + getValueName(binOp->getOperand(0));
-            result = result + " " + getValueName(binOp->getOperand(1));
-        }
-    }
-
-    // If we have not determined a result at this point, use the
-    // description of the value as the identifier.
-    if (result.length() == 0) {
-        result = value->getType()->getDescription();
-    }
-
-    return result;
+    _functionMetrics.nodes = _graph.size();
+    _functionMetrics.edges = _graph.getEdgeCount();
+    for (Graph::Index node = 0; node < _graph.size(); node++) {
+        int type = _graph.getType(node);
+        if (type == Node::DECISION) {
+            _functionMetrics.decisions++;
+        }
+        if (type != Node::START && type != Node::ELIDED) {
+            _functionMetrics.instructionNodes++;
+        }
+    }
 }
 
-std::string
-RocketShip::getDemangledName(std::string name)
+void
+RocketShip::addDegradedMetrics(Function &F, std::string functionIdentifier,
+                               std::string reason)
 {
-    // cplus_demangle returns a NULL pointer if the supplied string
-    // was not a mangled C++ identifier, or a string holding the
-    // demangled symbol.
-    std::string result;
-    char* demangled = cplus_demangle(name.c_str(), DMGL_ANSI|DMGL_PARAMS);
-
-    if (demangled != NULL) {
-        result = std::string(demangled);
-        // cplus_demangle allocates the memory and the caller is
-        // responsible for freeing the char*.
-        free(demangled);
-    } else {
-        result = name;
+    if (Metrics == NoMetrics || F.isDeclaration()) {
+        return;
+    }
+    FunctionMetrics metrics = FunctionMetrics();
+    metrics.identifier = functionIdentifier;
+    for (Function::iterator bblock = F.begin(); bblock != F.end(); bblock++) {
+        metrics.instructions += bblock->size();
     }
+    metrics.degraded = reason;
+    _moduleMetrics.push_back(metrics);
+}
 
-    return result;
+/**
+ * Writes a CSV field, quoted, with any quote in it doubled.
+ */
+static void
+writeCsvField(std::ostream& out, const std::string& value)
+{
+    out << '"';
+    for (std::string::size_type i = 0; i < value.length(); i++) {
+        if (value[i] == '"') {
+            out << '"';
+        }
+        out << value[i];
+    }
+    out << '"';
 }
 
-std::string
-RocketShip::getLabelForNode(Instruction* instruction)
+void
+RocketShip::emitMetrics(std::string moduleIdentifier)
 {
-    std::string result = "";
-
-    // Operations that have no display label
-    if (isa<CmpInst>(&*instruction) ||
-        isa<AllocaInst>(&*instruction) ||
-        isa<CastInst>(&*instruction) ||
-        isa<LoadInst>(&*instruction) ||
-        isa<BinaryOperator>(&*instruction) ||
-        isa<GetElementPtrInst>(&*instruction)) {
-        result = "";
-        // Comparison instructions are not displayed at all.  The
-        // conditional branch instructions link to the comparison
-        // instruction associated.  The decision node for a
-        // conditional branch then displays the actual comparison
-        // being made.
-
-        // Allocation instructions are currently not displayed.
-        // In the future, this should probably be modified to show
-        // what memory is being allocated for each "thing".
-
-        // Bitcast instructions cast from type A to type B but
-        // guarantee there is no change in the value.  The
-        // operation is not necessary to display in the graph.
-
-        // Load instructions pull a value from memory.  This is
-        // inconsequential for every language source except for
-        // assembly.
-
-        // Binary Operators are things like mul, (s|u)div, etc.
-        // These values are assigned or used later, so they do not
-        // need explicit display.
-
-        // GetElementPtrInst references an index in a pointer.
-        // This indexing will be referenced by other operations,
-        // so it is redundant to display the box.
-    }
-    // Call Instructions
-    else if (CallInst* callInst = dyn_cast<CallInst>(&*instruction)) {
-        result = getCallInstructionLabel(callInst);
-    }
-    // Branch Instructions
-    else if (BranchInst* branch = dyn_cast<BranchInst>(&*instruction)) {
-        if (branch->isConditional()) {
-            result = getConditionalBranchLabel(branch);
+    // The reduction ratio is the fraction of instructions that end up
+    // displayed as nodes; start and elided nodes aren't instructions, so
+    // they aren't counted.
+    QueuedFile output(_writer);
+
+    if (Metrics == CsvMetrics) {
+        output.open(_paths.getRootPath(moduleIdentifier + ".metrics.csv").c_str());
+        output << "function,instructions,nodes,edges,decisions,"
+               << "max_switch_fanout,calls,reduction_ratio,degraded\n";
+    } else {
+        output.open(_paths.getRootPath(moduleIdentifier + ".metrics.json").c_str());
+        output << "[\n";
+    }
+
+    for (std::vector<FunctionMetrics>::iterator it = _moduleMetrics.begin();
+         it != _moduleMetrics.end();
+         it++) {
+        double ratio = 0;
+        if (it->instructions > 0) {
+            ratio = static_cast<double>(it->instructionNodes) / it->instructions;
+        }
+
+        if (Metrics == CsvMetrics) {
+            writeCsvField(output, it->identifier);
+            output << ","
+                   << it->instructions << ","
+                   << it->nodes << ","
+                   << it->edges << ","
+                   << it->decisions << ","
+                   << it->maxSwitchFanOut << ","
+                   << it->calls << ","
+                   << ratio << ",";
+            writeCsvField(output, it->degraded);
+            output << "\n";
         } else {
-            // Unconditional branches don't get displayed
+            output << "{\"function\": \"";
+            JsonEmitter::writeEscaped(output, it->identifier);
+            output << "\", \"instructions\": " << it->instructions
+                   << ", \"nodes\": " << it->nodes
+                   << ", \"edges\": " << it->edges
+                   << ", \"decisions\": " << it->decisions
+                   << ", \"max_switch_fanout\": " << it->maxSwitchFanOut
+                   << ", \"calls\": " << it->calls
+                   << ", \"reduction_ratio\": " << ratio
+                   << ", \"degraded\": \"";
+            JsonEmitter::writeEscaped(output, it->degraded);
+            output << "\"}";
+            if (it + 1 != _moduleMetrics.end()) {
+                output << ",";
+            }
+            output << "\n";
         }
     }
-    // Invoke Instructions
-    else if (InvokeInst* invoke = dyn_cast<InvokeInst>(&*instruction)) {
-        result = getInvokeInstLabel(invoke);
+
+    if (Metrics == JsonMetrics) {
+        output << "]\n";
+    }
+    output.close();
+}
+
+void
+RocketShip::emitMemoryReport(std::string moduleIdentifier)
+{
+    long modulePeak = 0;
+    for (std::vector<MemoryPeak>::iterator it = _memoryPeaks.begin();
+         it != _memoryPeaks.end();
+         it++) {
+        modulePeak = std::max(modulePeak, it->total);
+    }
+
+    errs() << "RocketShip memory for " << moduleIdentifier
+           << " (largest function peak " << modulePeak << " bytes)\n";
+    errs() << "category\tallocations\tbytes\tlive\n";
+    for (int i = 0; i < Accounting::NumCategories; i++) {
+        Accounting::Category category = static_cast<Accounting::Category>(i);
+        errs() << Accounting::getCategoryName(category) << "\t"
+               << Accounting::getAllocations(category) << "\t"
+               << Accounting::getBytes(category) << "\t"
+               << Accounting::getLive(category) << "\n";
+    }
+
+    // Functions are listed by peak, largest first (ties in module order),
+    // with the peak of each category alongside.
+    std::vector<std::pair<long, size_t> > order;
+    for (size_t i = 0; i < _memoryPeaks.size(); i++) {
+        order.push_back(std::pair<long, size_t>(-_memoryPeaks[i].total, i));
     }
-    // Switch Instructions
-    else if (SwitchInst* switchInstruction = dyn_cast<SwitchInst>(&*instruction)) {
-        result = getSwitchInstLabel(switchInstruction);
+    std::sort(order.begin(), order.end());
+
+    errs() << "function\tpeak";
+    for (int i = 0; i < Accounting::NumCategories; i++) {
+        errs() << "\t" << Accounting::getCategoryName(static_cast<Accounting::Category>(i));
     }
-    // Store Instructions
-    else if (StoreInst* store = dyn_cast<StoreInst>(&*instruction)) {
-        result = getStoreInstLabel(store);
+    errs() << "\n";
+    for (std::vector<std::pair<long, size_t> >::iterator it = order.begin();
+         it != order.end();
+         it++) {
+        MemoryPeak& peak = _memoryPeaks[it->second];
+        errs() << peak.identifier << "\t" << peak.total;
+        for (int i = 0; i < Accounting::NumCategories; i++) {
+            errs() << "\t" << peak.categories[i];
+        }
+        errs() << "\n";
     }
-    // Default handling is:
-    // <instruction> <operand 1> <operand 2> <operand n>
-    else {
-        result = instruction->getOpcodeName();
+}
 
-        for (unsigned int i = 0; i < instruction->getNumOperands(); i++) {
-            result = result + " "
-                + std::string(instruction->getOperand(i)->getName());
+std::string
+RocketShip::getCanonicalGraph()
+{
+    // Edges lead to the position of a node in emission order rather
+    // than its raw id, since the raw ids also count instructions that
+    // are never displayed.
+    std::ostringstream canonical;
+
+    for (Graph::Index node = 0; node < _graph.size(); node++) {
+        Graph::Index begin = _graph.getEdgesBegin(node);
+        Graph::Index end = _graph.getEdgesEnd(node);
+        canonical << _graph.getType(node) << ':' << (end - begin) << ':';
+        // The start node carries the function name and signature,
+        // which is exactly what differs between duplicates.
+        if (_graph.getType(node) != Node::START) {
+            canonical << _graph.getLabel(node);
+        }
+        canonical << '\0';
+
+        for (Graph::Index edge = begin; edge < end; edge++) {
+            canonical << _graph.getEdgeTarget(edge) << ':' << _graph.getEdgeLabel(edge)
+                      << ':' << _graph.getEdgeWeight(edge) << '\0';
         }
     }
-    
-    return result;
+
+    return canonical.str();
 }
 
 /**
@@ -1,14 +1,26 @@
-#include "Node.h"
-#include "Block.h"
+#include "Accounting.h"
+#include "Graph.h"
+#include "GraphBuilder.h"
+#include "GraphEmitter.h"
+#include "FileWriter.h"
+#include "Journal.h"
+#include "OutputFile.h"
+#include "OutputPaths.h"
+#include "SymbolLegend.h"
 
 #include <vector>
 #include <map>
 #include <fstream>
+#include <ostream>
+#include <stdint.h>
+#include <boost/unordered_map.hpp>
 
 #include "llvm/Function.h"
 #include "llvm/Instructions.h"
 #include "llvm/Module.h"
 #include "llvm/Pass.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ProfileInfo.h"
 
 using namespace llvm;
 
@@ -24,7 +36,10 @@ namespace rocketship {
         /**
          * Construtor, pass everything up to parent class.
          */
-        RocketShip() : ModulePass(&ID), _nodeId(0) {}
+        RocketShip() : ModulePass(&ID), _graph(_strings), _startNodeId(-1), _diffChanged(0),
+                       _diffAdded(0), _diffUnchanged(0), _profile(NULL),
+                       _outputFile(_writer), _jsonFile(_writer),
+                       _graphmlFile(_writer), _svgFile(_writer) {}
 
         /**
          * Called for each module processed by the optimizer.  Each module has its own 
@@ -36,19 +51,100 @@ namespace rocketship {
         virtual bool runOnModule(Module &M);
 
         /**
-         * LLVM bytecode typically gets compiled down using temporary
-         * Values (most 'things' derive from Value).  Temporary Values
-         * don't have a name associated with them.  Some operations,
-         * such as sext (sign extend) and load (load data from memory)
-         * and bitcast (convert types) don't alter the fundamental
-         * behavior or stored values.  This traverses the hierarchy
-         * of instructions until it finds a Value with a name.  If 
-         * an instruction that modifies values is encountered, it
-         * returns an empty string.
-         */
-        static std::string getValueName(Value* value);
-        
+         * Declares the analyses used by the pass.  LoopInfo and ProfileInfo are
+         * only requested when the options using them are enabled.
+         * @param AU The usage information to populate.
+         */
+        virtual void getAnalysisUsage(AnalysisUsage &AU) const;
+
+        /**
+         * Renders the graph of a single function without writing any files,
+         * as used by the graph server.  The graph never carries profile data:
+         * the profile the pass was given is only of the module it runs on,
+         * and the server renders functions of any module it loads.  Clears the string table once rendered.
+         * @param F The function to render.
+         * @return The DOT text of the graph.
+         */
+        std::string renderFunction(Function &F);
+        /**
+         * Forgets the rendered graphs of callees, which must be done before
+         * a module they belong to is destroyed, and clears the strings
+         * interned for them.
+         */
+        void resetCalleeGraphs();
+
     private:
+        /**
+         * A call to a function with a body: the DOT identifier of the node
+         * making the call, and the function called.
+         */
+        typedef std::pair<std::string, Function*> CallEdge;
+        /**
+         * A call waiting to be expanded, with the depth in the call graph it
+         * was reached at.
+         */
+        typedef std::pair<CallEdge, unsigned int> PendingCall;
+        /**
+         * The rendered graph of a function, kept so that it is only generated
+         * once however many graphs it is expanded into.
+         */
+        struct CalleeGraph {
+            // The sanitized identifier of the function.
+            std::string identifier;
+            // The label to display for the function.
+            std::string label;
+            // The node and edge definitions, with prefixed node ids.
+            std::string body;
+            // The DOT identifier of the start node.
+            std::string entry;
+            // The number of nodes in body.
+            unsigned int nodes;
+            // The calls made from the function that could be expanded.
+            std::vector<CallEdge> calls;
+            // The aliases used by the labels in body.
+            SymbolLegend::Entries legend;
+        };
+
+        /**
+         * Size and complexity figures for a single function, gathered while
+         * its graph is built.
+         */
+        struct FunctionMetrics {
+            // The sanitized identifier of the function.
+            std::string identifier;
+            // The number of instructions processed.
+            unsigned int instructions;
+            // The number of nodes displayed in the graph.
+            unsigned int nodes;
+            // The number of those nodes that stand for an instruction,
+            // rather than the start of the function or elided paths.
+            unsigned int instructionNodes;
+            // The number of edges displayed in the graph.
+            unsigned int edges;
+            // The number of decision nodes displayed in the graph.
+            unsigned int decisions;
+            // The most distinct destinations of any switch instruction.
+            unsigned int maxSwitchFanOut;
+            // The number of call and invoke instructions.
+            unsigned int calls;
+            // Why the function was degraded, or empty if it wasn't.  A
+            // degraded function only has its instructions counted.
+            std::string degraded;
+        };
+
+        /**
+         * The memory used while processing a single function, beyond what
+         * was already in use before it.
+         */
+        struct MemoryPeak {
+            // The sanitized identifier of the function.
+            std::string identifier;
+            // The most bytes in use at once, across all categories.
+            long total;
+            // The most bytes in use at once in each category.
+            long categories[Accounting::NumCategories];
+        };
+
         /**
          * Generates the nodes and edges for the function and emits them to the
          * output filestream.  This processes a single function at a time.
@@ -56,90 +152,293 @@ namespace rocketship {
          */
         void processFunction(Function &F);
         /**
-         * Generates the nodes and edges for a block.  This processes a single block
-         * at a time.
-         * @param bblock The LLVM representation of the block to process.
-         * @param block The internal representation of the block.
+         * @return true if the journal records that an earlier run finished
+         * the module, and the files of the module and of every function
+         * that didn't crash are intact.
          */
-        void processBlock(BasicBlock* bblock, pBlock block);
+        bool isModuleFinished(Module &M);
         /**
-         * Populates node data based on the supplied instruction.
-         * @param instruction The LLVM representation of the instruction to process.
-         * @param node The internal representation of a node to track.
+         * Decides whether a function can be skipped when resuming: it
+         * crashed an earlier run, or an earlier run finished it and its
+         * files are intact.
+         * @param F The function to check.
+         * @return true if the function is skipped.
          */
-        void processInstruction(Instruction* instruction, pNode node);
-
+        bool skipFunction(Function &F);
         /**
-         * Outputs a single node to the output filestream base on the node type and
-         * associated edges.
-         * @param node The node to emit.
+         * Builds the graph of the function into _graph with a GraphBuilder
+         * set up from the command line options, replacing whatever was
+         * there.
+         * @param F The function to process.
+         * @return The label for the start node of the function.
          */
-        void emitNode(Node* node);
-
+        std::string buildGraph(Function &F);
+        /**
+         * Frees the graph of the current function.
+         */
+        void releaseGraph();
+        /**
+         * @param F The function to identify.
+         * @return The name of the function, usable as a DOT identifier and
+         * filename.
+         */
+        std::string getFunctionIdentifier(Function &F);
+        /**
+         * Collects the displayed calls in the current graph that call a
+         * function with a body.
+         * @param prefix The prefix applied to node ids of the current graph.
+         * @param calls The list to append the calls to.
+         */
+        void collectCalls(std::string prefix, std::vector<CallEdge>& calls);
+        /**
+         * Retrieves the rendered graph of a callee, generating it on first use.
+         * Generating a graph replaces the current member graph state.
+         * @param callee The function to retrieve the graph for.
+         */
+        CalleeGraph& getCalleeGraph(Function* callee);
+        /**
+         * Outputs the graphs of the functions called from F as clusters of the
+         * graph being written, bounded by the inline depth and node budget.
+         * @param F The function the graph is for.
+         * @param entry The DOT identifier of the start node of F.
+         * @param calls The expandable calls made from F.
+         * @param out The stream to write to.
+         */
+        void emitCallees(Function &F, std::string entry, std::vector<CallEdge> calls,
+                         std::ostream& out);
+        /**
+         * Cuts the current graph down to the slice asked for by
+         * -rocketship-slice-to and -rocketship-slice-from, if any.
+         * @return false if no node of the function matches, in which case
+         * the graph is left as it is and nothing should be written for it.
+         */
+        bool sliceGraph();
+        /**
+         * @param pattern A shell wildcard pattern.
+         * @param node The position of a node of the current graph.
+         * @return true if the pattern matches the label of the node, the
+         * function it calls or the block it is in.
+         */
+        bool matchesNode(const std::string& pattern, Graph::Index node);
+        /**
+         * Fits the labels of the current graph within the label budget,
+         * aliasing the long symbols in them with _legend.
+         * @param F The function the graph is for.
+         */
+        void abbreviateLabels(Function &F);
         /**
-         * Determines the string label to use for the supplied instruction.
-         * @param instruction The instruction to determine the label for.
+         * Outputs the current graph with each of the emitters, in a single
+         * walk over the graph, followed in DOT by its expanded callees.
+         * @param F The function the graph is for.
+         * @param functionIdentifier The sanitized identifier of the function.
+         * @param functionLabel The label to display for the function.
+         * @param emitters The emitters to write the graph with.
+         * @param dot The stream of the DOT emitter, which expanded callees
+         * are written to, or NULL if DOT isn't being written.
          */
-        std::string getLabelForNode(Instruction* instruction);
+        void emitGraph(Function &F,
+                       std::string functionIdentifier,
+                       std::string functionLabel,
+                       const std::vector<GraphEmitter*>& emitters,
+                       std::ostream* dot);
         /**
-         * Determines the appropriate label to display for a call instruction.
-         * @param instruction the call instruction to determine the label for.
+         * Outputs a placeholder graph for a function whose graph is
+         * structurally identical to one that has already been emitted.  The
+         * placeholder names the function and references the original graph.
+         * @param functionIdentifier The sanitized identifier of the function.
+         * @param functionLabel The label to display for the function.
+         * @param original The identifier of the previously emitted graph.
          */
-        std::string getCallInstructionLabel(CallInst* instruction);
+        void emitAlias(std::string functionIdentifier,
+                       std::string functionLabel,
+                       std::string original);
         /**
-         * Determines the appropriate label to display for a switch instruction.
-         * @param instruction the switch instruction to determine the label for.
+         * Outputs the graph of a function that went over budget: a node
+         * giving its size and the reason, followed, with
+         * -rocketship-degrade=blocks, by one node per basic block.
+         * @param F The function to render.
+         * @param functionIdentifier The sanitized identifier of the function.
+         * @param functionLabel The label to display for the function.
+         * @param reason Why the function went over budget.
+         * @param out The stream to write to.
          */
-        std::string getSwitchInstLabel(SwitchInst* instruction);
+        void emitDegraded(Function &F,
+                          std::string functionIdentifier,
+                          std::string functionLabel,
+                          std::string reason,
+                          std::ostream& out);
         /**
-         * Determines the appropriate label to display for a store isntruction.
-         * @param instruction the store instruction to determine the label for.
+         * Compares the current graph with the one written for the function
+         * by a previous run and outputs it with the differences highlighted,
+         * unless there are none.
+         * @param functionIdentifier The sanitized identifier of the function.
          */
-        std::string getStoreInstLabel(StoreInst* instruction);
+        void emitDiff(std::string functionIdentifier);
         /**
-         * Determines the appropriate label to display for a conditional branch
-         * instruction.
-         * @param instruction the branch instruction to determine the label for.
+         * Outputs the coarse zoom levels for the current function.  Level 0
+         * (<function>.L0.dot) is a single summary node.  Level 1
+         * (<function>.L1.dot) has one node per outermost loop and per block
+         * outside of any loop.  Each node links to the next level down,
+         * ending at the full graph in <function>.dot, or the placeholder of a
+         * deduplicated function.  A level 1 node only links if the entry
+         * of what it covers, the header of a loop, is displayed.
+         * @param F The function to summarize.
+         * @param loops The loop structure of the function.
+         * @param functionIdentifier The sanitized identifier of the function.
+         * @param functionLabel The label to display for the function.
          */
-        std::string getConditionalBranchLabel(BranchInst* instruction);
+        void emitLevels(Function &F, LoopInfo &loops,
+                        std::string functionIdentifier,
+                        std::string functionLabel);
         /**
-         * Determines the appropriate label to display for an invoke instruction.
-         * @param instruction The invoke instruction to determine the label for.
+         * Counts the nodes, edges and decisions of the current graph into the
+         * metrics of the current function.
          */
-        std::string getInvokeInstLabel(InvokeInst* instruction);
+        void countGraphMetrics();
         /**
-         * Converts a mangled (C++) symbol name to the unmangled version if it
-         * is a C++ mangled symbol name.  Otherwise, returns the supplied name
-         * unchanged.
-         * @param name The string to demangle.
+         * Adds a function that was degraded to the metrics of the module,
+         * with only its instructions counted, if metrics are written.
+         * @param reason Why the function was degraded.
          */
-        std::string getDemangledName(std::string name);
+        void addDegradedMetrics(Function &F, std::string functionIdentifier,
+                                std::string reason);
+        /**
+         * Outputs the metrics of every function in the module to
+         * <module>.metrics.csv or <module>.metrics.json.
+         * @param moduleIdentifier The sanitized identifier of the module.
+         */
+        void emitMetrics(std::string moduleIdentifier);
+        /**
+         * Reports the memory accounted while processing the module to
+         * stderr: totals per category, then the peak of every function,
+         * largest first.
+         * @param moduleIdentifier The sanitized identifier of the module.
+         */
+        void emitMemoryReport(std::string moduleIdentifier);
+        /**
+         * Writes out the structure of the current function graph (node
+         * types, labels and edges) as text.  The label of the start node is
+         * excluded and node ids are renumbered in emission order, so two
+         * functions with identical bodies give the same text regardless of
+         * their names.
+         * @return The canonical text of the graph.
+         */
+        std::string getCanonicalGraph();
+        /**
+         * @return The id to write to the DOT file for a node of the current
+         * graph: its stable id, or the node id if it doesn't have one.
+         * @param nodeId The internal id of the node.
+         */
+        std::string getDotId(int nodeId);
 
         /**
-         * Shared pointer collection of Node objects.
+         * The strings interned for the graphs of the current module, or of
+         * the function being served.
+         */
+        StringTable _strings;
+        /**
+         * The displayed nodes and edges of the current function, once
+         * built.  Everything that writes the graph out reads it from here.
          */
-        std::vector<pNode> _pnodes;
+        Graph _graph;
 
         /**
-         * Stores the next id to use for a node.  Since few nodes will have unique names,
-         * and DOT files require each node to have a unique name, the name of the node is
-         * the next available integer id.
+         * Stores the id of the start node of the current function.
+         */
+        int _startNodeId;
+        /**
+         * A graph that has been emitted: a second digest of its canonical
+         * text, compared on a match of the first so that a collision isn't
+         * taken for a duplicate, and the identifier of the function it was
+         * emitted for.
+         */
+        struct EmittedGraph {
+            uint64_t check;
+            std::string identifier;
+        };
+        /**
+         * Maps the hash of the canonical text of each emitted graph to the
+         * graph.  Only the digests are kept, not the text, so the map stays
+         * small however much a batch writes.  Persists for the lifetime of
+         * the pass so duplicates are detected across every module in a
+         * batch.
+         */
+        typedef boost::unordered_map<uint64_t, EmittedGraph> EmittedGraphs;
+        EmittedGraphs _emittedGraphs;
+        /**
+         * Why the function being built went over budget, or empty if it
+         * hasn't.
+         */
+        std::string _degradeReason;
+        /**
+         * Each function of the current module that went over budget, with
+         * the reason.
+         */
+        std::vector<std::pair<std::string, std::string> > _degraded;
+        /**
+         * What the level of detail graphs need of every block of the
+         * current function, kept when the blocks are freed.
+         */
+        GraphBuilder::BlockSummaries _blockSummaries;
+        /**
+         * The number of functions of the current module that changed, were
+         * new or were unchanged since the run compared against.
+         */
+        unsigned int _diffChanged;
+        unsigned int _diffAdded;
+        unsigned int _diffUnchanged;
+        /**
+         * Stores the rendered graph of each callee expanded in the current
+         * module.
          */
-        int _nodeId;
+        std::map<Function*, CalleeGraph> _calleeGraphs;
         /**
-         * Stores the next id to use for a block.  Currently unused but would allow
-         * for grouping of blocks in the created graphs.
+         * The metrics of the function currently being built.
          */
-        int _blockId;
+        FunctionMetrics _functionMetrics;
         /**
-         * Stores the LLVM representation of blocks mapped to the internal
-         * representation of blocks.  Provides easy access for determining linkage
-         * between blocks.
+         * The metrics of every function processed in the current module.
          */
-        std::map<BasicBlock*, pBlock> _blocks;
+        std::vector<FunctionMetrics> _moduleMetrics;
+        /**
+         * The memory peak of every function processed in the current module,
+         * when accounting memory.
+         */
+        std::vector<MemoryPeak> _memoryPeaks;
+        /**
+         * The execution profile of the module, or NULL if profile data isn't
+         * being used.
+         */
+        ProfileInfo* _profile;
+        /**
+         * The progress of the current module, kept with
+         * -rocketship-journal or -rocketship-resume.
+         */
+        Journal _journal;
+        /**
+         * Compresses and writes the files of each function on its own
+         * thread, while the next function is built.  Declared before the
+         * files handing it their content.
+         */
+        FileWriter _writer;
         /**
          * The output filestream to send graph data to.
          */
-        std::ofstream _outputFile;
+        QueuedFile _outputFile;
+        /**
+         * The output filestreams for the JSON, GraphML and SVG formats.
+         */
+        QueuedFile _jsonFile;
+        QueuedFile _graphmlFile;
+        QueuedFile _svgFile;
+        /**
+         * Where the files of each function are written.
+         */
+        OutputPaths _paths;
+        /**
+         * The aliases of long symbols in labels, numbered across the
+         * current module.
+         */
+        SymbolLegend _legend;
     };
 }
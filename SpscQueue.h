@@ -0,0 +1,111 @@
+/*
+** SpscQueue.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	SPSCQUEUE_H_
+# define   	SPSCQUEUE_H_
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * A bounded queue between exactly one producer thread and one consumer
+ * thread, without locks.  The producer only ever writes the tail and the
+ * consumer only ever writes the head, so each side just needs a memory
+ * barrier between touching a slot and publishing its index.
+ *
+ * Neither side blocks: tryPush fails when the queue is full and tryPop
+ * when it is empty, leaving the caller to decide how to wait, which is
+ * what gives the stages on either side their backpressure.
+ */
+template <class T>
+class SpscQueue {
+public:
+    /**
+     * Constructor.
+     * @param capacity The most items the queue holds at once, at least 1.
+     */
+    SpscQueue(std::size_t capacity) :
+        _slots(capacity > 0 ? capacity + 1 : 2),
+        _head(0),
+        _tail(0)
+    {
+    }
+
+    /**
+     * Adds an item at the tail.  Only called by the producer.
+     * @return false if the queue is full.
+     */
+    bool tryPush(const T& item)
+    {
+        std::size_t tail = _tail;
+        std::size_t next = tail + 1 == _slots.size() ? 0 : tail + 1;
+        if (next == _head) {
+            return false;
+        }
+        // The consumer must be done reading the slot before it is
+        // overwritten.
+        __sync_synchronize();
+        _slots[tail] = item;
+        // The item must be in place before the consumer can see it.
+        __sync_synchronize();
+        _tail = next;
+        return true;
+    }
+
+    /**
+     * Removes the item at the head.  Only called by the consumer.
+     * @return false if the queue is empty.
+     */
+    bool tryPop(T& item)
+    {
+        std::size_t head = _head;
+        if (head == _tail) {
+            return false;
+        }
+        // The item is read only once the producer has published it, and
+        // before the slot is handed back.
+        __sync_synchronize();
+        item = _slots[head];
+        __sync_synchronize();
+        _head = head + 1 == _slots.size() ? 0 : head + 1;
+        return true;
+    }
+
+    /**
+     * @return true if the queue held nothing when checked.
+     */
+    bool empty() const
+    {
+        return _head == _tail;
+    }
+
+    /**
+     * @return true if the queue had no room left when checked.
+     */
+    bool full() const
+    {
+        std::size_t tail = _tail;
+        return (tail + 1 == _slots.size() ? 0 : tail + 1) == _head;
+    }
+
+    /**
+     * @return The most items the queue holds at once.
+     */
+    std::size_t capacity() const
+    {
+        return _slots.size() - 1;
+    }
+private:
+    SpscQueue(const SpscQueue&);
+    SpscQueue& operator=(const SpscQueue&);
+
+    // One slot is always left free to tell a full queue from an empty one.
+    std::vector<T> _slots;
+    volatile std::size_t _head;
+    volatile std::size_t _tail;
+};
+
+#endif 	    /* !SPSCQUEUE_H_ */
@@ -0,0 +1,98 @@
+#include "StringTable.h"
+
+const StringTable::Id StringTable::Empty;
+
+StringTable::StringTable() :
+    _count(0),
+    _full(false)
+{
+    pthread_rwlock_init(&_lock, NULL);
+    for (unsigned int i = 0; i < MaxChunks; i++) {
+        _chunks[i] = NULL;
+    }
+
+    // Reserve id 0 for the empty string so a default constructed id
+    // is always valid.
+    intern("");
+}
+
+StringTable::~StringTable()
+{
+    for (unsigned int i = 0; i < MaxChunks; i++) {
+        delete [] _chunks[i];
+    }
+    pthread_rwlock_destroy(&_lock);
+}
+
+StringTable::Id
+StringTable::intern(const std::string& value)
+{
+    // Nearly every lookup is for a string that is already interned, so
+    // try that under the shared lock first.
+    pthread_rwlock_rdlock(&_lock);
+    Ids::iterator found = _ids.find(value);
+    if (found != _ids.end()) {
+        Id id = found->second;
+        pthread_rwlock_unlock(&_lock);
+        return id;
+    }
+    pthread_rwlock_unlock(&_lock);
+
+    // Another thread may have interned the string between the two
+    // locks, so check again once we hold the exclusive lock.
+    pthread_rwlock_wrlock(&_lock);
+    found = _ids.find(value);
+    if (found != _ids.end()) {
+        Id id = found->second;
+        pthread_rwlock_unlock(&_lock);
+        return id;
+    }
+
+    Id id = _count;
+    unsigned int chunk = id >> ChunkBits;
+    if (chunk >= MaxChunks) {
+        _full = true;
+        pthread_rwlock_unlock(&_lock);
+        return Empty;
+    }
+    if (_chunks[chunk] == NULL) {
+        _chunks[chunk] = new const std::string*[ChunkSize];
+        Accounting::allocated(Accounting::LabelMemory, ChunkSize * sizeof(std::string*));
+    }
+
+    found = _ids.insert(std::pair<std::string, Id>(value, id)).first;
+    // The map's allocator counts its elements, not the characters held by
+    // the key, which are counted here (an overestimate for short strings
+    // stored inline).
+    Accounting::allocated(Accounting::LabelMemory, found->first.capacity());
+    _chunks[chunk][id & (ChunkSize - 1)] = &found->first;
+
+    // The slot has to be visible before anything can learn the id.
+    __sync_synchronize();
+    _count = id + 1;
+    pthread_rwlock_unlock(&_lock);
+
+    return id;
+}
+
+void
+StringTable::clear()
+{
+    pthread_rwlock_wrlock(&_lock);
+    for (Ids::iterator it = _ids.begin(); it != _ids.end(); it++) {
+        Accounting::released(Accounting::LabelMemory, it->first.capacity());
+    }
+    _ids.clear();
+    for (unsigned int i = 0; i < MaxChunks; i++) {
+        if (_chunks[i] != NULL) {
+            delete [] _chunks[i];
+            _chunks[i] = NULL;
+            Accounting::released(Accounting::LabelMemory, ChunkSize * sizeof(std::string*));
+        }
+    }
+    _count = 0;
+    _full = false;
+    pthread_rwlock_unlock(&_lock);
+
+    intern("");
+}
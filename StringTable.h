@@ -0,0 +1,112 @@
+/*
+** StringTable.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	STRINGTABLE_H_
+# define   	STRINGTABLE_H_
+
+#include "Accounting.h"
+
+#include <boost/unordered_map.hpp>
+#include <pthread.h>
+#include <string>
+
+/**
+ * Interns strings, handing out a compact integer id for each distinct
+ * string.  Labels, names and edge labels are stored as ids so that the
+ * text of a label repeated across thousands of nodes ("call printf (...)",
+ * "true", "default", ...) is held only once.
+ *
+ * Each table is independent: ids are only meaningful to the table that
+ * handed them out, so the builder, the graphs and the nodes sharing ids
+ * are all given the same table.  Interned strings stay valid until the
+ * table is cleared, which is done once no graph holds an id any more.
+ * Interning is safe from any number of threads; resolving an id never
+ * takes a lock.
+ *
+ * The table holds a bounded number of strings.  Once it is full, further
+ * strings intern as the empty string and isFull says so, for the function
+ * being built to be degraded rather than the process stopped.
+ */
+class StringTable {
+public:
+    /**
+     * The type of an interned string id.
+     */
+    typedef unsigned int Id;
+    /**
+     * The id of the empty string, which is always interned.
+     */
+    static const Id Empty = 0;
+
+    /**
+     * Constructor, creates a table holding only the empty string.
+     */
+    StringTable();
+    /**
+     * Destructor, frees every interned string.
+     */
+    ~StringTable();
+
+    /**
+     * Interns the supplied string.
+     * @param value The string to intern.
+     * @return The id of the string, the same for every call with equal text
+     * until the table is cleared, or Empty if the table is full.
+     */
+    Id intern(const std::string& value);
+    /**
+     * Resolves an id handed out by intern.
+     * @param id The id to resolve.
+     * @return The interned string.
+     */
+    const std::string& lookup(Id id) const
+    {
+        return *_chunks[id >> ChunkBits][id & (ChunkSize - 1)];
+    }
+    /**
+     * @return The number of distinct strings interned.
+     */
+    unsigned int size() const { return _count; }
+    /**
+     * @return Whether a string was turned away since the table was last
+     * cleared.
+     */
+    bool isFull() const { return _full; }
+    /**
+     * Drops every interned string but the empty one.  Every id handed out
+     * before is invalidated, so nothing may hold one, or be interning,
+     * while the table is cleared.
+     */
+    void clear();
+private:
+    StringTable(const StringTable&);
+    StringTable& operator=(const StringTable&);
+
+    // Ids are split into a chunk index and an index within the chunk.
+    // Chunks are allocated as needed and never moved, so a reader can
+    // index into them without synchronizing with writers.
+    static const unsigned int ChunkBits = 12;
+    static const unsigned int ChunkSize = 1 << ChunkBits;
+    static const unsigned int MaxChunks = 4096;
+
+    // Maps each interned string to its id.  Elements of an
+    // unordered_map are never moved, so the chunks point at its keys.
+    typedef boost::unordered_map<std::string, Id, boost::hash<std::string>,
+                                 std::equal_to<std::string>,
+                                 Accounting::Allocator<std::pair<const std::string, Id>,
+                                                       Accounting::LabelMemory> > Ids;
+    Ids _ids;
+    // Stores the string for each id, ChunkSize at a time.
+    const std::string** _chunks[MaxChunks];
+    // Stores the number of ids handed out.
+    volatile Id _count;
+    // Set once a string is turned away for lack of room.
+    volatile bool _full;
+    // Guards _ids and the allocation of chunks.
+    pthread_rwlock_t _lock;
+};
+
+#endif 	    /* !STRINGTABLE_H_ */
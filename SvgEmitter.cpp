@@ -0,0 +1,155 @@
+#include "SvgEmitter.h"
+#include "GraphMLEmitter.h"
+#include "Node.h"
+
+#include <math.h>
+
+// The space left around the drawing, in points.
+static const double Margin = 8;
+
+SvgEmitter::SvgEmitter(std::ostream& out, const Layout& layout) :
+    GraphEmitter(out),
+    _layout(layout)
+{
+}
+
+void
+SvgEmitter::beginGraph(const std::string& identifier, const std::string& label)
+{
+    long width = static_cast<long>(ceil(_layout.getWidth() + 2 * Margin));
+    long height = static_cast<long>(ceil(_layout.getHeight() + 2 * Margin));
+    _out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+         << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width
+         << "pt\" height=\"" << height << "pt\" viewBox=\"0 0 " << width
+         << " " << height << "\">\n";
+    // XML escaping covers everything SVG text needs.
+    _out << "<title>";
+    GraphMLEmitter::writeEscaped(_out, label);
+    _out << "</title>\n"
+         << "<defs><marker id=\"arrow\" viewBox=\"0 0 10 10\" refX=\"10\" refY=\"5\""
+         << " markerWidth=\"8\" markerHeight=\"8\" orient=\"auto\">"
+         << "<path d=\"M0,0 L10,5 L0,10 z\"/></marker></defs>\n"
+         << "<g id=\"";
+    GraphMLEmitter::writeEscaped(_out, identifier);
+    _out << "\" font-family=\"Times,serif\" font-size=\"14\" text-anchor=\"middle\""
+         << " fill=\"none\" stroke=\"black\">\n";
+}
+
+void
+SvgEmitter::emitNode(const Graph& graph, Graph::Index node)
+{
+    double x = _layout.getX(node);
+    double y = _layout.getY(node);
+    double halfWidth = _layout.getNodeWidth(node) / 2;
+    double halfHeight = _layout.getNodeHeight(node) / 2;
+
+    switch (graph.getType(node)) {
+    case Node::START:
+    case Node::END:
+        break;
+    case Node::DECISION:
+        _out << "<polygon points=\"";
+        writeX(x - halfWidth);
+        _out << ",";
+        writeY(y);
+        _out << " ";
+        writeX(x);
+        _out << ",";
+        writeY(y + halfHeight);
+        _out << " ";
+        writeX(x + halfWidth);
+        _out << ",";
+        writeY(y);
+        _out << " ";
+        writeX(x);
+        _out << ",";
+        writeY(y - halfHeight);
+        _out << "\"/>\n";
+        break;
+    case Node::ELIDED:
+    case Node::ACTIVITY:
+    default:
+        _out << "<rect x=\"";
+        writeX(x - halfWidth);
+        _out << "\" y=\"";
+        writeY(y + halfHeight);
+        _out << "\" width=\"" << static_cast<long>(halfWidth * 2 + 0.5)
+             << "\" height=\"" << static_cast<long>(halfHeight * 2 + 0.5) << "\"";
+        if (graph.getType(node) == Node::ELIDED) {
+            _out << " stroke-dasharray=\"4,2\"";
+        }
+        _out << "/>\n";
+    }
+
+    // One text element per line, the block of lines centred on the node.
+    const std::string& label = graph.getLabel(node);
+    double line = y + halfHeight - 23;
+    std::string::size_type start = 0;
+    while (start <= label.length()) {
+        std::string::size_type end = label.find('\n', start);
+        if (end == std::string::npos) {
+            end = label.length();
+        }
+        _out << "<text x=\"";
+        writeX(x);
+        _out << "\" y=\"";
+        writeY(line);
+        _out << "\" fill=\"black\" stroke=\"none\">";
+        GraphMLEmitter::writeEscaped(_out, label.substr(start, end - start));
+        _out << "</text>\n";
+        line -= 14;
+        start = end + 1;
+    }
+
+    // Edges leave from the side of the node facing their target, so back
+    // edges run upwards.
+    for (Graph::Index edge = graph.getEdgesBegin(node);
+         edge < graph.getEdgesEnd(node);
+         edge++) {
+        Graph::Index target = graph.getEdgeTarget(edge);
+        double targetX = _layout.getX(target);
+        double targetY = _layout.getY(target);
+        double targetHalfHeight = _layout.getNodeHeight(target) / 2;
+        double fromY = targetY < y ? y - halfHeight : y + halfHeight;
+        double toY = targetY < y ? targetY + targetHalfHeight : targetY - targetHalfHeight;
+
+        _out << "<line x1=\"";
+        writeX(x);
+        _out << "\" y1=\"";
+        writeY(fromY);
+        _out << "\" x2=\"";
+        writeX(targetX);
+        _out << "\" y2=\"";
+        writeY(toY);
+        _out << "\" marker-end=\"url(#arrow)\"/>\n";
+
+        const std::string& edgeLabel = graph.getEdgeLabel(edge);
+        if (edgeLabel.length() > 0) {
+            _out << "<text x=\"";
+            writeX((x + targetX) / 2);
+            _out << "\" y=\"";
+            writeY((fromY + toY) / 2);
+            _out << "\" font-size=\"10\" fill=\"black\" stroke=\"none\">";
+            GraphMLEmitter::writeEscaped(_out, edgeLabel);
+            _out << "</text>\n";
+        }
+    }
+}
+
+void
+SvgEmitter::endGraph()
+{
+    _out << "</g>\n</svg>\n";
+}
+
+void
+SvgEmitter::writeX(double x)
+{
+    _out << static_cast<long>(floor(x + Margin + 0.5));
+}
+
+void
+SvgEmitter::writeY(double y)
+{
+    _out << static_cast<long>(floor(_layout.getHeight() - y + Margin + 0.5));
+}
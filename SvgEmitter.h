@@ -0,0 +1,43 @@
+/*
+** SvgEmitter.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	SVGEMITTER_H_
+# define   	SVGEMITTER_H_
+
+#include "GraphEmitter.h"
+#include "Layout.h"
+
+/**
+ * Draws a graph as an SVG image at the positions of a Layout, without
+ * Graphviz.  Shapes follow DotEmitter: diamonds for decisions, dashed
+ * boxes for elided parts of the graph, bare text for the start and end
+ * nodes and boxes for everything else.  Edges are straight lines.
+ */
+class SvgEmitter : public GraphEmitter {
+public:
+    /**
+     * Constructor.
+     * @param out The stream to write to.
+     * @param layout The layout of the graphs to write, computed before
+     * each of them is begun.
+     */
+    SvgEmitter(std::ostream& out, const Layout& layout);
+
+    virtual void beginGraph(const std::string& identifier, const std::string& label);
+    virtual void emitNode(const Graph& graph, Graph::Index node);
+    virtual void endGraph();
+private:
+    /**
+     * Writes a coordinate of the layout, in whole points, with SVG's y
+     * axis pointing down.
+     */
+    void writeX(double x);
+    void writeY(double y);
+
+    const Layout& _layout;
+};
+
+#endif 	    /* !SVGEMITTER_H_ */
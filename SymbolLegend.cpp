@@ -0,0 +1,101 @@
+#include "SymbolLegend.h"
+
+#include <algorithm>
+#include <sstream>
+
+const std::string::size_type SymbolLegend::MinSymbolLength;
+
+/**
+ * Orders symbols longest first, so a symbol is replaced before any
+ * shorter symbol it contains.
+ */
+static bool
+isLonger(const std::string& left, const std::string& right)
+{
+    return left.length() > right.length();
+}
+
+SymbolLegend::SymbolLegend(std::string::size_type budget) :
+    _budget(budget)
+{
+}
+
+std::string
+SymbolLegend::abbreviate(const std::string& label, std::vector<std::string> symbols)
+{
+    if (_budget == 0 || label.length() <= _budget) {
+        return label;
+    }
+
+    std::string result = label;
+    std::sort(symbols.begin(), symbols.end(), isLonger);
+    for (std::vector<std::string>::iterator symbol = symbols.begin();
+         symbol != symbols.end() && result.length() > _budget;
+         symbol++) {
+        if (symbol->length() <= MinSymbolLength) {
+            break;
+        }
+
+        std::string::size_type found = result.find(*symbol);
+        if (found == std::string::npos) {
+            continue;
+        }
+        const std::string& alias = getAlias(*symbol);
+        if (_graphAliases.insert(alias).second) {
+            _graphEntries.push_back(Entry(alias, *symbol));
+        }
+        while (found != std::string::npos) {
+            result.replace(found, symbol->length(), alias);
+            found = result.find(*symbol, found + alias.length());
+        }
+    }
+
+    // The "..." counts towards the budget, but never leaves nothing of
+    // the label.
+    if (result.length() > _budget) {
+        std::string::size_type kept = _budget > 3 ? _budget - 3 : 1;
+        result = result.substr(0, kept) + "...";
+    }
+    return result;
+}
+
+const std::string&
+SymbolLegend::getAlias(const std::string& symbol)
+{
+    std::map<std::string, std::string>::iterator found = _aliases.find(symbol);
+    if (found != _aliases.end()) {
+        return found->second;
+    }
+
+    std::ostringstream alias;
+    alias << "F" << _entries.size() + 1;
+    _entries.push_back(Entry(alias.str(), symbol));
+    return _aliases.insert(std::pair<std::string, std::string>(symbol, alias.str())).first->second;
+}
+
+void
+SymbolLegend::beginGraph()
+{
+    _graphAliases.clear();
+    _graphEntries.clear();
+}
+
+void
+SymbolLegend::addGraphEntries(const Entries& entries)
+{
+    for (Entries::const_iterator it = entries.begin();
+         it != entries.end();
+         it++) {
+        if (_graphAliases.insert(it->first).second) {
+            _graphEntries.push_back(*it);
+        }
+    }
+}
+
+void
+SymbolLegend::clear()
+{
+    beginGraph();
+    _aliases.clear();
+    _entries.clear();
+}
@@ -0,0 +1,91 @@
+/*
+** SymbolLegend.h
+**
+** Created on Sun Oct 18 2026
+*/
+
+#ifndef   	SYMBOLLEGEND_H_
+# define   	SYMBOLLEGEND_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Keeps labels within a length budget by replacing the long symbols in
+ * them, typically demangled template instantiations, with short aliases
+ * such as "F17".  Each symbol gets one alias, numbered in the order
+ * symbols are first aliased, so a symbol reads the same in every graph of
+ * a module.  The legend of aliases used can be had per graph and for the
+ * whole module.
+ */
+class SymbolLegend {
+public:
+    /**
+     * An alias and the symbol it stands for.
+     */
+    typedef std::pair<std::string, std::string> Entry;
+    typedef std::vector<Entry> Entries;
+
+    /**
+     * Symbols no longer than this are never aliased, since an alias would
+     * save little and read worse.
+     */
+    static const std::string::size_type MinSymbolLength = 8;
+
+    /**
+     * Constructor.
+     * @param budget The longest label to leave as is, or 0 for no limit.
+     */
+    SymbolLegend(std::string::size_type budget = 0);
+
+    void setBudget(std::string::size_type budget) { _budget = budget; }
+    std::string::size_type getBudget() const { return _budget; }
+
+    /**
+     * Fits a label within the budget.  Labels already within it are
+     * returned unchanged.  Otherwise the symbols found in the label are
+     * replaced by their aliases, longest first, and whatever is still
+     * over the budget is cut off and marked with "...".
+     * @param label The label to fit.
+     * @param symbols The symbols the label may contain.
+     */
+    std::string abbreviate(const std::string& label, std::vector<std::string> symbols);
+    /**
+     * @return The alias of a symbol, assigning the next one if it has none.
+     */
+    const std::string& getAlias(const std::string& symbol);
+
+    /**
+     * Starts a new graph, forgetting which aliases the last one used.
+     */
+    void beginGraph();
+    /**
+     * @return The aliases used since beginGraph, in the order first used.
+     */
+    const Entries& getGraphEntries() const { return _graphEntries; }
+    /**
+     * Counts aliases as used by the current graph, such as those of a
+     * graph drawn into it.
+     * @param entries The aliases to add.
+     */
+    void addGraphEntries(const Entries& entries);
+    /**
+     * @return Every alias assigned, in order.
+     */
+    const Entries& getEntries() const { return _entries; }
+    /**
+     * Forgets every alias, so numbering starts again from F1.
+     */
+    void clear();
+private:
+    std::string::size_type _budget;
+    std::map<std::string, std::string> _aliases;
+    Entries _entries;
+    std::set<std::string> _graphAliases;
+    Entries _graphEntries;
+};
+
+#endif 	    /* !SYMBOLLEGEND_H_ */
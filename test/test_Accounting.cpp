@@ -0,0 +1,90 @@
+#include "gtest/gtest.h"
+
+#include "../Accounting.h"
+#include "../Edge.h"
+
+#include <map>
+
+/**
+ * Enables accounting for the duration of a test, starting from zeroed
+ * totals and peaks.
+ */
+class AccountingTest : public ::testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        Accounting::setEnabled(true);
+        Accounting::resetTotals();
+        Accounting::resetPeaks();
+    }
+    virtual void TearDown()
+    {
+        Accounting::setEnabled(false);
+    }
+};
+
+TEST_F(AccountingTest, ObjectAllocation)
+{
+    StringTable strings;
+    long live = Accounting::getLive(Accounting::EdgeMemory);
+    Edge* edge = new Edge(strings, "1", "true");
+
+    ASSERT_EQ(1, Accounting::getAllocations(Accounting::EdgeMemory));
+    ASSERT_EQ(static_cast<long>(sizeof(Edge)), Accounting::getBytes(Accounting::EdgeMemory));
+    ASSERT_EQ(live + static_cast<long>(sizeof(Edge)), Accounting::getLive(Accounting::EdgeMemory));
+
+    delete edge;
+    ASSERT_EQ(live, Accounting::getLive(Accounting::EdgeMemory));
+    ASSERT_EQ(live + static_cast<long>(sizeof(Edge)), Accounting::getPeak(Accounting::EdgeMemory));
+}
+
+TEST_F(AccountingTest, ContainerAllocator)
+{
+    typedef std::map<int, int, std::less<int>,
+                     Accounting::Allocator<std::pair<const int, int>,
+                                           Accounting::BlockMapMemory> > Map;
+    long live = Accounting::getLive(Accounting::BlockMapMemory);
+    {
+        Map map;
+        for (int i = 0; i < 100; i++) {
+            map[i] = i;
+        }
+        ASSERT_EQ(100, Accounting::getAllocations(Accounting::BlockMapMemory));
+        ASSERT_LT(live, Accounting::getLive(Accounting::BlockMapMemory));
+    }
+    ASSERT_EQ(live, Accounting::getLive(Accounting::BlockMapMemory));
+}
+
+TEST_F(AccountingTest, SharedControlBlock)
+{
+    StringTable strings;
+    long live = Accounting::getLive(Accounting::ControlBlockMemory);
+    {
+        boost::shared_ptr<Edge> edge = Accounting::share(new Edge(strings, "2"));
+        boost::shared_ptr<Edge> copy = edge;
+        ASSERT_EQ(1, Accounting::getAllocations(Accounting::ControlBlockMemory));
+        ASSERT_EQ(1, Accounting::getAllocations(Accounting::EdgeMemory));
+    }
+    ASSERT_EQ(live, Accounting::getLive(Accounting::ControlBlockMemory));
+}
+
+TEST_F(AccountingTest, PeakReset)
+{
+    Accounting::allocated(Accounting::DemanglerMemory, 100);
+    Accounting::released(Accounting::DemanglerMemory, 100);
+    ASSERT_EQ(100, Accounting::getPeak(Accounting::DemanglerMemory));
+    ASSERT_LE(100, Accounting::getPeakTotal());
+
+    Accounting::resetPeaks();
+    ASSERT_EQ(Accounting::getLive(Accounting::DemanglerMemory),
+              Accounting::getPeak(Accounting::DemanglerMemory));
+}
+
+TEST(AccountingDisabledTest, NotCounted)
+{
+    StringTable strings;
+    Accounting::resetTotals();
+    Edge* edge = new Edge(strings);
+    delete edge;
+    ASSERT_EQ(0, Accounting::getAllocations(Accounting::EdgeMemory));
+}
@@ -6,21 +6,24 @@
 
 TEST(BlockTest, BlockConstructor)
 {
-    Block block(0, "test_block");
+    StringTable strings;
+    Block block(strings, 0, "test_block");
     EXPECT_EQ(0, block.getId());
     EXPECT_EQ("test_block", block.getLabel());
 }
 
 TEST(BlockTest, NodeConstructorDefaultLabel)
 {
-    Block block(0);
+    StringTable strings;
+    Block block(strings, 0);
     EXPECT_EQ(0, block.getId());
     EXPECT_EQ("", block.getLabel());
 }
 
 TEST(BlockTest, BlockLabels)
 {
-    Block block(0, "test_block");
+    StringTable strings;
+    Block block(strings, 0, "test_block");
 
     block.setId(1);
     ASSERT_EQ(1, block.getId());
@@ -30,15 +33,17 @@ TEST(BlockTest, BlockLabels)
 
 TEST(BlockTest, GetEmptyNodes)
 {
-    Block block(0);
+    StringTable strings;
+    Block block(strings, 0);
 
     ASSERT_EQ(0, block.getNodes().size());
 }
 
 TEST(BlockTest, AppendNode)
 {
-    Block block(0);
-    pNode node(new Node(1));
+    StringTable strings;
+    Block block(strings, 0);
+    pNode node(new Node(strings, 1));
     block.appendNode(node);
     ASSERT_EQ(1, block.getNodes().size());
     ASSERT_EQ(1, block.getNodes()[0]->getNodeId());
@@ -46,15 +51,16 @@ TEST(BlockTest, AppendNode)
 
 TEST(BlockTest, FindEdgeOneDeep)
 {
+    StringTable strings;
     int blockId = 0;
     int nodeId = 1;
-    pBlock block(new Block(blockId));
-    pNode node(new Node(nodeId));
+    pBlock block(new Block(strings, blockId));
+    pNode node(new Node(strings, nodeId));
     llvm::LLVMContext context;
     llvm::BasicBlock* source = llvm::BasicBlock::Create(context);
     llvm::BasicBlock* target = llvm::BasicBlock::Create(context);
     llvm::BranchInst* instruction = llvm::BranchInst::Create(target);
-    std::map<llvm::BasicBlock*, pBlock> blocks;
+    BlockMap blocks;
     blocks.insert(std::pair<llvm::BasicBlock*, pBlock>(target, block));
     block->appendNode(node);
     source->getInstList().push_back(instruction);
@@ -66,12 +72,13 @@ TEST(BlockTest, FindEdgeOneDeep)
 
 TEST(BlockTest, FindEdgeTwoDeep)
 {
+    StringTable strings;
     int blockId = 0;
     int node_one_id = 1;
     int node_two_id = 2;
-    pBlock block(new Block(blockId));
-    pNode node_one(new Node(node_one_id));
-    pNode node_two(new Node(node_two_id));
+    pBlock block(new Block(strings, blockId));
+    pNode node_one(new Node(strings, node_one_id));
+    pNode node_two(new Node(strings, node_two_id));
 
     llvm::LLVMContext context;
     llvm::BasicBlock* source = llvm::BasicBlock::Create(context);
@@ -81,7 +88,7 @@ TEST(BlockTest, FindEdgeTwoDeep)
     node_one->setInstruction(instruction);
     node_two->setInstruction(instruction);
     node_two->setNodeLabel("x");
-    std::map<llvm::BasicBlock*, pBlock> blocks;
+    BlockMap blocks;
     blocks.insert(std::pair<llvm::BasicBlock*, pBlock>(target, block));
     block->appendNode(node_one);
     block->appendNode(node_two);
@@ -103,10 +110,11 @@ TEST(BlockTest, FindEdgeRecursive)
     llvm::BranchInst* finstruction = llvm::BranchInst::Create(sbblock);
     llvm::BranchInst* sinstruction = llvm::BranchInst::Create(fbblock);
 
-    pBlock fblock(new Block(0));
-    pBlock sblock(new Block(1));
-    pNode fnode(new Node(0));
-    pNode snode(new Node(1));
+    StringTable strings;
+    pBlock fblock(new Block(strings, 0));
+    pBlock sblock(new Block(strings, 1));
+    pNode fnode(new Node(strings, 0));
+    pNode snode(new Node(strings, 1));
 
     fbblock->getInstList().push_back(finstruction);
     sbblock->getInstList().push_back(sinstruction);
@@ -116,20 +124,50 @@ TEST(BlockTest, FindEdgeRecursive)
     snode->setInstruction(sinstruction);
     snode->setNodeLabel("test_label");
 
-    std::map<llvm::BasicBlock*, pBlock> blocks;
+    BlockMap blocks;
     blocks.insert(std::pair<llvm::BasicBlock*, pBlock>(fbblock, fblock));
     blocks.insert(std::pair<llvm::BasicBlock*, pBlock>(sbblock, sblock));
     ASSERT_EQ(1, fblock->findEdge(fbblock, blocks));
 }
 
+TEST(BlockTest, FindEdgeCycleWithoutLabel)
+{
+    // Two blocks that branch to each other and have nothing labelled
+    // must terminate with -1 rather than recursing forever.
+    llvm::LLVMContext context;
+    llvm::BasicBlock* fbblock = llvm::BasicBlock::Create(context);
+    llvm::BasicBlock* sbblock = llvm::BasicBlock::Create(context);
+    llvm::BranchInst* finstruction = llvm::BranchInst::Create(sbblock);
+    llvm::BranchInst* sinstruction = llvm::BranchInst::Create(fbblock);
+
+    StringTable strings;
+    pBlock fblock(new Block(strings, 0));
+    pBlock sblock(new Block(strings, 1));
+    pNode fnode(new Node(strings, 0));
+    pNode snode(new Node(strings, 1));
+
+    fbblock->getInstList().push_back(finstruction);
+    sbblock->getInstList().push_back(sinstruction);
+    fblock->appendNode(fnode);
+    sblock->appendNode(snode);
+    fnode->setInstruction(finstruction);
+    snode->setInstruction(sinstruction);
+
+    BlockMap blocks;
+    blocks.insert(std::pair<llvm::BasicBlock*, pBlock>(fbblock, fblock));
+    blocks.insert(std::pair<llvm::BasicBlock*, pBlock>(sbblock, sblock));
+    ASSERT_EQ(-1, fblock->findEdge(fbblock, blocks));
+}
+
 TEST(BlockTest, ProcessNodesContiguous)
 {
-    pBlock block(new Block(0));
-    pNode node_one(new Node(0));
-    pNode node_two(new Node(1));
-    pNode node_three(new Node(2));
-    pNode node_four(new Node(3));
-    std::map<llvm::BasicBlock*, pBlock> blocks;
+    StringTable strings;
+    pBlock block(new Block(strings, 0));
+    pNode node_one(new Node(strings, 0));
+    pNode node_two(new Node(strings, 1));
+    pNode node_three(new Node(strings, 2));
+    pNode node_four(new Node(strings, 3));
+    BlockMap blocks;
     node_one->setNodeLabel("node_one");
     node_two->setNodeLabel("node_two");
     node_three->setNodeLabel("node_three");
@@ -151,12 +189,13 @@ TEST(BlockTest, ProcessNodesBlockEdges)
     // Block 1 -> unconditional branch to bblock 1, with label
     // Block 2 -> unconditional branch to bblock 2, no label
     // Block 3 -> blank node with label
-    pBlock block_one(new Block(0));
-    pBlock block_two(new Block(1));
-    pBlock block_three(new Block(2));
-    pNode node_one(new Node(0));
-    pNode node_two(new Node(1));
-    pNode node_three(new Node(2));
+    StringTable strings;
+    pBlock block_one(new Block(strings, 0));
+    pBlock block_two(new Block(strings, 1));
+    pBlock block_three(new Block(strings, 2));
+    pNode node_one(new Node(strings, 0));
+    pNode node_two(new Node(strings, 1));
+    pNode node_three(new Node(strings, 2));
 
     llvm::LLVMContext context;
     llvm::BasicBlock* bblock_one = llvm::BasicBlock::Create(context);
@@ -172,7 +211,7 @@ TEST(BlockTest, ProcessNodesBlockEdges)
     block_two->appendNode(node_two);
     block_three->appendNode(node_three);
 
-    std::map<llvm::BasicBlock*, pBlock> blocks;
+    BlockMap blocks;
     blocks.insert(std::pair<llvm::BasicBlock*, pBlock>(bblock_one, block_two));
     blocks.insert(std::pair<llvm::BasicBlock*, pBlock>(bblock_two, block_three));
     block_one->processNodes(blocks);
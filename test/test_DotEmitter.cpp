@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+
+#include "../DotEmitter.h"
+#include "../Node.h"
+
+#include <sstream>
+
+TEST(DotEmitterTest, Graph)
+{
+    StringTable strings;
+    Graph graph(strings);
+    graph.reset(2, 1);
+    graph.addNode(0, Node::DECISION, strings.intern(std::string("x < \"3\"")), StringTable::Empty, NULL);
+    graph.addEdge(1, strings.intern(std::string("true")), 12);
+    graph.addNode(1, Node::END, strings.intern(std::string("ret")), StringTable::Empty, NULL);
+    graph.finish();
+
+    std::ostringstream out;
+    DotEmitter emitter(out);
+    emitter.beginGraph("main", "int main()");
+    emitter.emitNode(graph, 0);
+    emitter.emitNode(graph, 1);
+    emitter.endGraph();
+
+    ASSERT_EQ("digraph main {\n"
+              "0 [label=\"x < \\\"3\\\"\" shape=diamond]\n"
+              "0 -> 1[label=\"true (12)\"]\n"
+              "1 [label=\"ret\" shape=none]\n"
+              "}", out.str());
+}
+
+TEST(DotEmitterTest, Prefix)
+{
+    StringTable strings;
+    Graph graph(strings);
+    graph.reset(2, 1);
+    graph.addNode(3, Node::ACTIVITY, strings.intern(std::string("call f")), StringTable::Empty, NULL);
+    graph.addEdge(4, StringTable::Empty, -1);
+    graph.addNode(4, Node::ELIDED, strings.intern(std::string("cold paths elided")), StringTable::Empty, NULL);
+    graph.finish();
+
+    std::ostringstream out;
+    DotEmitter emitter(out, "foo_");
+    emitter.emitNode(graph, 0);
+    emitter.emitNode(graph, 1);
+
+    ASSERT_EQ("foo_3 [label=\"call f\" shape=box]\n"
+              "foo_3 -> foo_4[label=\"\"]\n"
+              "foo_4 [label=\"cold paths elided\" shape=note]\n", out.str());
+}
+
+TEST(DotEmitterTest, Layout)
+{
+    StringTable strings;
+    Graph graph(strings);
+    graph.reset(2, 1);
+    graph.addNode(0, Node::ACTIVITY, strings.intern(std::string("call f")), StringTable::Empty, NULL);
+    graph.addEdge(1, StringTable::Empty, -1);
+    graph.addNode(1, Node::END, strings.intern(std::string("ret")), StringTable::Empty, NULL);
+    graph.finish();
+
+    Layout layout;
+    layout.compute(graph, 4);
+    std::ostringstream out;
+    DotEmitter emitter(out);
+    emitter.setLayout(&layout);
+    emitter.beginGraph("main", "int main()");
+    emitter.emitNode(graph, 0);
+    emitter.emitNode(graph, 1);
+    emitter.endGraph();
+
+    ASSERT_EQ("digraph main {\n"
+              "layout=neato\n"
+              "0 [label=\"call f\" shape=box pos=\"29,90!\"]\n"
+              "0 -> 1[label=\"\"]\n"
+              "1 [label=\"ret\" shape=none pos=\"29,18!\"]\n"
+              "}", out.str());
+}
@@ -0,0 +1,82 @@
+#include "gtest/gtest.h"
+
+#include "../DotText.h"
+
+#include <sstream>
+
+TEST(DotTextTest, SanitizeIdentifierUnchanged)
+{
+    EXPECT_EQ("main", DotText::sanitizeIdentifier("main"));
+    EXPECT_EQ("__ZN3foo3barEv", DotText::sanitizeIdentifier("_ZN3foo3barEv"));
+}
+
+TEST(DotTextTest, SanitizeIdentifierReplaces)
+{
+    EXPECT_EQ("hello_2Ebc", DotText::sanitizeIdentifier("hello.bc"));
+    EXPECT_EQ("foo_24bar_2E_3C1_3E", DotText::sanitizeIdentifier("foo$bar.<1>"));
+}
+
+TEST(DotTextTest, SanitizeIdentifierLeadingDigit)
+{
+    EXPECT_EQ("_31abc", DotText::sanitizeIdentifier("1abc"));
+    EXPECT_EQ("_", DotText::sanitizeIdentifier(""));
+}
+
+TEST(DotTextTest, SanitizeIdentifierLong)
+{
+    // Long enough to go through the vector loop, with an invalid
+    // character in each chunk and in the scalar tail.
+    std::string name;
+    std::string expected;
+    for (int i = 0; i < 100; i++) {
+        name += (i % 7 == 0) ? '.' : static_cast<char>('a' + i % 26);
+        expected += (i % 7 == 0) ? std::string("_2E") : std::string(1, static_cast<char>('a' + i % 26));
+    }
+    name[0] = 'x';
+    expected.replace(0, 3, "x");
+    EXPECT_EQ(expected, DotText::sanitizeIdentifier(name));
+}
+
+TEST(DotTextTest, SanitizeIdentifierHighBytes)
+{
+    EXPECT_EQ("a_C3_A9b", DotText::sanitizeIdentifier("a\xc3\xa9" "b"));
+}
+
+TEST(DotTextTest, SanitizeIdentifierDistinct)
+{
+    // Names differing only in characters that are escaped stay apart.
+    EXPECT_NE(DotText::sanitizeIdentifier("foo.1"), DotText::sanitizeIdentifier("foo$1"));
+    EXPECT_NE(DotText::sanitizeIdentifier("foo.1"), DotText::sanitizeIdentifier("foo_1"));
+    EXPECT_NE(DotText::sanitizeIdentifier("foo_2E1"), DotText::sanitizeIdentifier("foo.1"));
+    EXPECT_NE(DotText::sanitizeIdentifier("1"), DotText::sanitizeIdentifier("_31"));
+}
+
+TEST(DotTextTest, EscapeLabelUnchanged)
+{
+    EXPECT_EQ("call foo<int> (x, {y})",
+              DotText::escapeLabel("call foo<int> (x, {y})"));
+}
+
+TEST(DotTextTest, EscapeLabelSpecial)
+{
+    EXPECT_EQ("say \\\"hi\\\" \\\\ bye\\nnext line",
+              DotText::escapeLabel("say \"hi\" \\ bye\nnext\tline"));
+}
+
+TEST(DotTextTest, EscapeLabelLong)
+{
+    std::string label(70, 'a');
+    label[40] = '"';
+    label[69] = '\\';
+    std::string expected(70, 'a');
+    expected.replace(69, 1, "\\\\");
+    expected.replace(40, 1, "\\\"");
+    EXPECT_EQ(expected, DotText::escapeLabel(label));
+}
+
+TEST(DotTextTest, WriteEscapedLabel)
+{
+    std::ostringstream out;
+    DotText::writeEscapedLabel(out, "a \"b\"");
+    EXPECT_EQ("a \\\"b\\\"", out.str());
+}
@@ -4,7 +4,17 @@
 
 TEST(EdgeTest, EdgeGetValues)
 {
-    Edge* edge = new Edge("test_id", "test_label");
+    StringTable strings;
+    Edge* edge = new Edge(strings, "test_id", "test_label");
     EXPECT_EQ("test_id", edge->getId());
     EXPECT_EQ("test_label", edge->getLabel());
 }
+
+TEST(EdgeTest, EdgeWeight)
+{
+    StringTable strings;
+    Edge edge(strings, "test_id");
+    EXPECT_EQ(-1, edge.getWeight());
+    edge.setWeight(42);
+    EXPECT_EQ(42, edge.getWeight());
+}
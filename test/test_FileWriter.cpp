@@ -0,0 +1,144 @@
+#include "gtest/gtest.h"
+
+#include "../FileWriter.h"
+
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+/**
+ * @return The content of a file, or an empty string if it can't be read.
+ */
+static std::string
+readFile(const char* path)
+{
+    std::ifstream input(path);
+    std::ostringstream read;
+    read << input.rdbuf();
+    return read.str();
+}
+
+TEST(FileWriterTest, Synchronous)
+{
+    FileWriter writer;
+    std::string content = "digraph test {\n}";
+
+    writer.setQueueDepth(0);
+    writer.write("test_writer_sync.dot", content);
+    ASSERT_TRUE(content.empty());
+    // Written before write returns.
+    ASSERT_EQ("digraph test {\n}", readFile("test_writer_sync.dot"));
+    unlink("test_writer_sync.dot");
+}
+
+TEST(FileWriterTest, Queued)
+{
+    FileWriter writer;
+    writer.setQueueDepth(2);
+
+    // More files than the queue holds, so the producer has to wait.
+    for (int i = 0; i < 20; i++) {
+        std::ostringstream path;
+        path << "test_writer_" << i << ".dot";
+        std::ostringstream content;
+        content << "digraph f" << i << " {\n}";
+        std::string data = content.str();
+        writer.write(path.str(), data);
+    }
+    writer.flush();
+
+    for (int i = 0; i < 20; i++) {
+        std::ostringstream path;
+        path << "test_writer_" << i << ".dot";
+        std::ostringstream content;
+        content << "digraph f" << i << " {\n}";
+        ASSERT_EQ(content.str(), readFile(path.str().c_str()));
+        unlink(path.str().c_str());
+    }
+    ASSERT_TRUE(writer.takeFailures().empty());
+}
+
+TEST(FileWriterTest, IdleWriterParks)
+{
+    FileWriter writer;
+    writer.setQueueDepth(1);
+
+    // Long enough between files for the writer to give up yielding and
+    // park, so each file has to wake it.
+    for (int i = 0; i < 5; i++) {
+        std::string data = "digraph idle {\n}";
+        writer.write("test_writer_idle.dot", data);
+        usleep(20 * 1000);
+    }
+    writer.flush();
+
+    ASSERT_EQ("digraph idle {\n}", readFile("test_writer_idle.dot"));
+    unlink("test_writer_idle.dot");
+}
+
+TEST(FileWriterTest, Failures)
+{
+    FileWriter writer;
+    std::string content = "digraph test {\n}";
+
+    writer.setQueueDepth(2);
+    writer.write("no_such_directory/test.dot", content);
+    std::vector<std::string> failures = writer.takeFailures();
+    ASSERT_EQ(1, failures.size());
+    ASSERT_EQ("no_such_directory/test.dot", failures[0]);
+    ASSERT_TRUE(writer.takeFailures().empty());
+}
+
+TEST(FileWriterTest, QueuedFile)
+{
+    FileWriter writer;
+    writer.setQueueDepth(2);
+    QueuedFile output(writer);
+
+    ASSERT_FALSE(output.is_open());
+    output.open("test_queued_file.dot");
+    ASSERT_TRUE(output.is_open());
+    output << "digraph test {\n" << 42 << " [label=\"x\"]\n}";
+    output.close();
+    ASSERT_FALSE(output.is_open());
+
+    // A second file through the same stream starts out empty.
+    output.open("test_queued_file2.dot");
+    output << "digraph second {\n}";
+    output.close();
+    writer.flush();
+
+    ASSERT_EQ("digraph test {\n42 [label=\"x\"]\n}", readFile("test_queued_file.dot"));
+    ASSERT_EQ("digraph second {\n}", readFile("test_queued_file2.dot"));
+    unlink("test_queued_file.dot");
+    unlink("test_queued_file2.dot");
+}
+
+TEST(FileWriterTest, Journal)
+{
+    FileWriter writer;
+    Journal journal;
+    std::string error;
+    std::string content = "digraph f {\n}";
+
+    ASSERT_TRUE(journal.open("test_writer.journal", false, error));
+    writer.setQueueDepth(2);
+    writer.setJournal(&journal);
+    writer.beginUnit("function:f");
+    writer.write("test_writer_f.dot", content);
+    // g is never done: one of its files fails.
+    writer.beginUnit("function:g");
+    content = "digraph g {\n}";
+    writer.write("no_such_directory/g.dot", content);
+    writer.endUnit();
+    writer.flush();
+    writer.setJournal(NULL);
+    journal.close();
+
+    ASSERT_TRUE(journal.open("test_writer.journal", true, error));
+    ASSERT_TRUE(journal.isFinished("function:f"));
+    ASSERT_FALSE(journal.isFinished("function:g"));
+    journal.close();
+    unlink("test_writer.journal");
+    unlink("test_writer_f.dot");
+}
@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+
+#include "../Accounting.h"
+#include "../Graph.h"
+
+#include <set>
+#include <string>
+
+TEST(GraphTest, Empty)
+{
+    StringTable strings;
+    Graph graph(strings);
+    graph.finish();
+
+    ASSERT_EQ(0u, graph.size());
+    ASSERT_EQ(0u, graph.getEdgeCount());
+    ASSERT_EQ(Graph::None, graph.find(0));
+}
+
+TEST(GraphTest, NodesAndEdges)
+{
+    StringTable strings;
+    Graph graph(strings);
+    graph.reset(3, 3);
+
+    // Ids needn't be contiguous, only increasing; edges may lead
+    // forward to nodes not added yet.
+    graph.addNode(1, 0, strings.intern(std::string("main")), StringTable::Empty, NULL);
+    graph.addEdge(4, StringTable::Empty, -1);
+    graph.addNode(4, 2, strings.intern(std::string("x < 3")), StringTable::Empty, NULL);
+    graph.addEdge(9, strings.intern(std::string("true")), 12);
+    graph.addEdge(1, strings.intern(std::string("false")), -1);
+    graph.addNode(9, 3, strings.intern(std::string("ret")), StringTable::Empty, NULL);
+    graph.finish();
+
+    ASSERT_EQ(3u, graph.size());
+    ASSERT_EQ(3u, graph.getEdgeCount());
+    ASSERT_EQ(1u, graph.find(4));
+    ASSERT_EQ(Graph::None, graph.find(5));
+
+    ASSERT_EQ(4, graph.getId(1));
+    ASSERT_EQ(2, graph.getType(1));
+    ASSERT_EQ("x < 3", graph.getLabel(1));
+
+    ASSERT_EQ(0u, graph.getEdgesBegin(0));
+    ASSERT_EQ(1u, graph.getEdgesEnd(0));
+    ASSERT_EQ(1u, graph.getEdgeTarget(0));
+
+    ASSERT_EQ(1u, graph.getEdgesBegin(1));
+    ASSERT_EQ(3u, graph.getEdgesEnd(1));
+    ASSERT_EQ(2u, graph.getEdgeTarget(1));
+    ASSERT_EQ("true", graph.getEdgeLabel(1));
+    ASSERT_EQ(12, graph.getEdgeWeight(1));
+    ASSERT_EQ(0u, graph.getEdgeTarget(2));
+    ASSERT_EQ("false", graph.getEdgeLabel(2));
+
+    ASSERT_EQ(graph.getEdgesBegin(2), graph.getEdgesEnd(2));
+}
+
+TEST(GraphTest, UnresolvedEdgesDropped)
+{
+    StringTable strings;
+    Graph graph(strings);
+    graph.reset(2, 3);
+
+    graph.addNode(0, 1, strings.intern(std::string("a")), StringTable::Empty, NULL);
+    graph.addEdge(7, StringTable::Empty, -1);
+    graph.addEdge(1, StringTable::Empty, -1);
+    graph.addNode(1, 1, strings.intern(std::string("b")), StringTable::Empty, NULL);
+    graph.addEdge(8, StringTable::Empty, -1);
+    graph.finish();
+
+    ASSERT_EQ(1u, graph.getEdgeCount());
+    ASSERT_EQ(0u, graph.getEdgesBegin(0));
+    ASSERT_EQ(1u, graph.getEdgesEnd(0));
+    ASSERT_EQ(1u, graph.getEdgeTarget(0));
+    ASSERT_EQ(1u, graph.getEdgesBegin(1));
+    ASSERT_EQ(1u, graph.getEdgesEnd(1));
+}
+
+TEST(GraphTest, CapacityBounded)
+{
+    StringTable strings;
+    Graph graph(strings);
+    graph.reset(1, 1);
+
+    ASSERT_EQ(0u, graph.addNode(0, 1, StringTable::Empty, StringTable::Empty, NULL));
+    ASSERT_EQ(Graph::None, graph.addNode(1, 1, StringTable::Empty, StringTable::Empty, NULL));
+    graph.addEdge(0, StringTable::Empty, -1);
+    graph.addEdge(0, StringTable::Empty, -1);
+    graph.finish();
+
+    ASSERT_EQ(1u, graph.size());
+    ASSERT_EQ(1u, graph.getEdgeCount());
+}
+
+TEST(GraphTest, StableIds)
+{
+    StringTable strings;
+    Graph graph(strings);
+    graph.reset(3, 0);
+    graph.addNode(0, 1, strings.intern(std::string("call f")), StringTable::Empty, NULL);
+    graph.addNode(5, 1, strings.intern(std::string("call f")), StringTable::Empty, NULL);
+    graph.addNode(6, 1, strings.intern(std::string("call g")), StringTable::Empty, NULL);
+    graph.finish();
+
+    ASSERT_EQ("5", graph.getDotId(1));
+    graph.assignStableIds();
+
+    std::set<std::string> ids;
+    for (Graph::Index node = 0; node < graph.size(); node++) {
+        ASSERT_EQ(17u, graph.getDotId(node).length());
+        ASSERT_EQ('n', graph.getDotId(node)[0]);
+        ids.insert(graph.getDotId(node));
+    }
+    ASSERT_EQ(3u, ids.size());
+
+    // The same labels in the same order give the same ids, whatever the
+    // internal ids.
+    Graph other(strings);
+    other.reset(2, 0);
+    other.addNode(10, 1, strings.intern(std::string("call f")), StringTable::Empty, NULL);
+    other.addNode(11, 1, strings.intern(std::string("call f")), StringTable::Empty, NULL);
+    other.finish();
+    other.assignStableIds();
+    ASSERT_EQ(graph.getDotId(0), other.getDotId(0));
+    ASSERT_EQ(graph.getDotId(1), other.getDotId(1));
+}
+
+TEST(GraphTest, SingleAllocation)
+{
+    StringTable strings;
+    Accounting::setEnabled(true);
+    Accounting::resetTotals();
+    long live = Accounting::getLive(Accounting::GraphMemory);
+
+    {
+        Graph graph(strings);
+        graph.reset(100, 200);
+        ASSERT_EQ(1, Accounting::getAllocations(Accounting::GraphMemory));
+        ASSERT_EQ(live + static_cast<long>(graph.getBytes()),
+                  Accounting::getLive(Accounting::GraphMemory));
+        graph.release();
+        ASSERT_EQ(live, Accounting::getLive(Accounting::GraphMemory));
+        graph.reset(10, 10);
+    }
+    ASSERT_EQ(live, Accounting::getLive(Accounting::GraphMemory));
+
+    Accounting::setEnabled(false);
+}
+
+TEST(GraphTest, Swap)
+{
+    StringTable strings;
+    Graph first(strings);
+    Graph second(strings);
+    first.reset(1, 0);
+    first.addNode(7, 0, strings.intern(std::string("main")), StringTable::Empty, NULL);
+    first.finish();
+
+    first.swap(second);
+    ASSERT_EQ(0u, first.size());
+    ASSERT_EQ(1u, second.size());
+    ASSERT_EQ(0u, second.find(7));
+    ASSERT_EQ("main", second.getLabel(0));
+}
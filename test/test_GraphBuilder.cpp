@@ -0,0 +1,106 @@
+#include "gtest/gtest.h"
+
+#include "../GraphBuilder.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Instructions.h"
+#include "llvm/Module.h"
+
+/**
+ * Creates "void f()" in module, with an entry block branching to a block
+ * that returns.
+ */
+static llvm::Function*
+createFunction(llvm::LLVMContext& context, llvm::Module& module)
+{
+    llvm::Function* function =
+        llvm::Function::Create(llvm::FunctionType::get(llvm::Type::getVoidTy(context), false),
+                               llvm::GlobalValue::ExternalLinkage, "f", &module);
+    llvm::BasicBlock* entry = llvm::BasicBlock::Create(context, "entry", function);
+    llvm::BasicBlock* exit = llvm::BasicBlock::Create(context, "exit", function);
+    llvm::BranchInst::Create(exit, entry);
+    llvm::ReturnInst::Create(context, exit);
+    return function;
+}
+
+TEST(GraphBuilderTest, FunctionLabel)
+{
+    llvm::LLVMContext context;
+    llvm::Module module("test", context);
+    llvm::Function* function = createFunction(context, module);
+
+    ASSERT_EQ("void f()", GraphBuilder::getFunctionLabel(*function));
+}
+
+TEST(GraphBuilderTest, Build)
+{
+    StringTable strings;
+    llvm::LLVMContext context;
+    llvm::Module module("test", context);
+    llvm::Function* function = createFunction(context, module);
+    GraphBuilder builder;
+    Graph graph(strings);
+
+    ASSERT_EQ("void f()", builder.build(*function, graph));
+    ASSERT_EQ("", builder.getDegradeReason());
+    ASSERT_EQ(2, builder.getStatistics().instructions);
+    ASSERT_EQ(0, builder.getStatistics().calls);
+
+    Graph::Index start = graph.find(builder.getStartNodeId());
+    ASSERT_NE(Graph::None, start);
+    ASSERT_EQ(Node::START, graph.getType(start));
+    ASSERT_EQ("void f()", graph.getLabel(start));
+    ASSERT_TRUE(builder.getBlockSummaries().empty());
+}
+
+TEST(GraphBuilderTest, BuildIsRepeatable)
+{
+    StringTable strings;
+    llvm::LLVMContext context;
+    llvm::Module module("test", context);
+    llvm::Function* function = createFunction(context, module);
+    GraphBuilder builder;
+    Graph first(strings);
+    Graph second(strings);
+
+    builder.build(*function, first);
+    builder.build(*function, second);
+    ASSERT_EQ(first.size(), second.size());
+    ASSERT_EQ(first.getEdgeCount(), second.getEdgeCount());
+    for (Graph::Index node = 0; node < first.size(); node++) {
+        ASSERT_EQ(first.getDotId(node), second.getDotId(node));
+    }
+}
+
+TEST(GraphBuilderTest, SummarizeBlocks)
+{
+    StringTable strings;
+    llvm::LLVMContext context;
+    llvm::Module module("test", context);
+    llvm::Function* function = createFunction(context, module);
+    GraphBuilder::Options options;
+    options.summarizeBlocks = true;
+    GraphBuilder builder(options);
+    Graph graph(strings);
+
+    builder.build(*function, graph);
+    const GraphBuilder::BlockSummaries& summaries = builder.getBlockSummaries();
+    ASSERT_EQ(2, summaries.size());
+    ASSERT_EQ("entry", summaries.find(&function->getEntryBlock())->second.label);
+}
+
+TEST(GraphBuilderTest, OverInstructionBudget)
+{
+    StringTable strings;
+    llvm::LLVMContext context;
+    llvm::Module module("test", context);
+    llvm::Function* function = createFunction(context, module);
+    GraphBuilder::Options options;
+    options.maxInstructions = 1;
+    GraphBuilder builder(options);
+    Graph graph(strings);
+
+    ASSERT_EQ("void f()", builder.build(*function, graph));
+    ASSERT_EQ("2 instructions, over the budget of 1", builder.getDegradeReason());
+    ASSERT_EQ(0, graph.size());
+}
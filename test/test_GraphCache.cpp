@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+
+#include "../GraphCache.h"
+
+TEST(GraphCacheTest, LookupMissing)
+{
+    GraphCache cache(1024);
+    std::string graph;
+
+    ASSERT_FALSE(cache.lookup("a.bc", "main", graph));
+}
+
+TEST(GraphCacheTest, InsertLookup)
+{
+    GraphCache cache(1024);
+    std::string graph;
+
+    cache.insert("a.bc", "main", "digraph main {}");
+    ASSERT_TRUE(cache.lookup("a.bc", "main", graph));
+    ASSERT_EQ("digraph main {}", graph);
+    ASSERT_FALSE(cache.lookup("b.bc", "main", graph));
+
+    cache.insert("a.bc", "main", "digraph main {x}");
+    ASSERT_TRUE(cache.lookup("a.bc", "main", graph));
+    ASSERT_EQ("digraph main {x}", graph);
+    ASSERT_EQ(1u, cache.size());
+}
+
+TEST(GraphCacheTest, EvictsLeastRecentlyUsed)
+{
+    // Each entry is 1 + 1 + 8 bytes, so three fit.
+    GraphCache cache(30);
+    std::string graph;
+
+    cache.insert("m", "a", "aaaaaaaa");
+    cache.insert("m", "b", "bbbbbbbb");
+    cache.insert("m", "c", "cccccccc");
+    ASSERT_EQ(30u, cache.getBytes());
+
+    // Using a makes b the least recently used.
+    ASSERT_TRUE(cache.lookup("m", "a", graph));
+    cache.insert("m", "d", "dddddddd");
+
+    ASSERT_EQ(3u, cache.size());
+    ASSERT_FALSE(cache.lookup("m", "b", graph));
+    ASSERT_TRUE(cache.lookup("m", "a", graph));
+    ASSERT_TRUE(cache.lookup("m", "c", graph));
+    ASSERT_TRUE(cache.lookup("m", "d", graph));
+}
+
+TEST(GraphCacheTest, TooLarge)
+{
+    GraphCache cache(10);
+    std::string graph;
+
+    cache.insert("m", "a", "aaaaaaaaaaaaaaaa");
+    ASSERT_FALSE(cache.lookup("m", "a", graph));
+    ASSERT_EQ(0u, cache.getBytes());
+}
+
+TEST(GraphCacheTest, Invalidate)
+{
+    GraphCache cache(1024);
+    std::string graph;
+
+    cache.insert("a.bc", "main", "1");
+    cache.insert("a.bc", "foo", "2");
+    cache.insert("b.bc", "main", "3");
+    cache.invalidate("a.bc");
+
+    ASSERT_FALSE(cache.lookup("a.bc", "main", graph));
+    ASSERT_FALSE(cache.lookup("a.bc", "foo", graph));
+    ASSERT_TRUE(cache.lookup("b.bc", "main", graph));
+    ASSERT_EQ(1u, cache.size());
+}
@@ -0,0 +1,116 @@
+#include "gtest/gtest.h"
+
+#include "../GraphDiff.h"
+
+#include <sstream>
+
+static const char* Previous =
+    "digraph main {\n"
+    "nstart [label=\"int main()\" shape=none]\n"
+    "nstart -> na[label=\"\"]\n"
+    "na [label=\"call puts (x[0])\" shape=box]\n"
+    "na -> nb[label=\"\"]\n"
+    "nb [label=\"ret\" shape=none]\n"
+    "}";
+
+TEST(GraphDiffTest, Unchanged)
+{
+    GraphDiff diff;
+    std::istringstream previous(Previous);
+    std::istringstream current(Previous);
+
+    diff.readPrevious(previous);
+    diff.readCurrent(current);
+    ASSERT_FALSE(diff.isChanged());
+}
+
+TEST(GraphDiffTest, AddedAndRemoved)
+{
+    GraphDiff diff;
+    std::istringstream previous(Previous);
+    std::istringstream current(
+        "digraph main {\n"
+        "nstart [label=\"int main()\" shape=none]\n"
+        "nstart -> na[label=\"\"]\n"
+        "na [label=\"call puts (x[0])\" shape=box]\n"
+        "na -> nc[label=\"\"]\n"
+        "nc [label=\"call exit (1)\" shape=none]\n"
+        "}");
+
+    diff.readPrevious(previous);
+    diff.readCurrent(current);
+    ASSERT_TRUE(diff.isChanged());
+    // nc added, nb removed.
+    ASSERT_EQ(2u, diff.getChangedNodes());
+    // na -> nc added, na -> nb removed.
+    ASSERT_EQ(2u, diff.getChangedEdges());
+
+    std::ostringstream out;
+    diff.write(out);
+    std::string result = out.str();
+    EXPECT_NE(std::string::npos, result.find(
+        "na [label=\"call puts (x[0])\" shape=box]\n"));
+    EXPECT_NE(std::string::npos, result.find(
+        "nc [label=\"call exit (1)\" shape=none color=green fontcolor=green]\n"));
+    EXPECT_NE(std::string::npos, result.find(
+        "na -> nc [label=\"\" color=green fontcolor=green]\n"));
+    EXPECT_NE(std::string::npos, result.find(
+        "nb [label=\"ret\" shape=none color=red fontcolor=red style=dashed]\n"));
+    EXPECT_NE(std::string::npos, result.find(
+        "na -> nb [label=\"\" color=red fontcolor=red style=dashed]\n"));
+}
+
+TEST(GraphDiffTest, ChangedAttributes)
+{
+    GraphDiff diff;
+    std::istringstream previous("a [label=\"x\" shape=box]\na -> b[label=\"true\"]\nb [label=\"y\"]\n");
+    std::istringstream current("a [label=\"x\" shape=diamond]\na -> b[label=\"false\"]\nb [label=\"y\"]\n");
+
+    diff.readPrevious(previous);
+    diff.readCurrent(current);
+    ASSERT_EQ(1u, diff.getChangedNodes());
+    // The edge with the old label is removed and one with the new
+    // label added.
+    ASSERT_EQ(2u, diff.getChangedEdges());
+
+    std::ostringstream out;
+    diff.write(out);
+    EXPECT_NE(std::string::npos, out.str().find("color=orange"));
+    EXPECT_NE(std::string::npos, out.str().find("a -> b [label=\"true\" color=red"));
+    EXPECT_NE(std::string::npos, out.str().find("a -> b [label=\"false\" color=green"));
+}
+
+TEST(GraphDiffTest, ParallelEdges)
+{
+    GraphDiff diff;
+    std::istringstream previous("a [label=\"x\"]\na -> b[label=\"1\"]\na -> b[label=\"2\"]\nb [label=\"y\"]\n");
+    std::istringstream current("a [label=\"x\"]\na -> b[label=\"1\"]\nb [label=\"y\"]\n");
+
+    diff.readPrevious(previous);
+    diff.readCurrent(current);
+    ASSERT_EQ(0u, diff.getChangedNodes());
+    ASSERT_EQ(1u, diff.getChangedEdges());
+
+    std::ostringstream out;
+    diff.write(out);
+    EXPECT_NE(std::string::npos, out.str().find("a -> b [label=\"1\"]\n"));
+    EXPECT_NE(std::string::npos, out.str().find("a -> b [label=\"2\" color=red"));
+}
+
+TEST(GraphDiffTest, ClustersIgnored)
+{
+    GraphDiff diff;
+    std::istringstream previous(Previous);
+    std::istringstream current(
+        std::string(Previous, std::string(Previous).length() - 1) +
+        "subgraph cluster_foo {\n"
+        "label=\"void foo()\"\n"
+        "foo_nstart [label=\"void foo()\" shape=none]\n"
+        "}\n"
+        "na -> foo_nstart [style=dashed]\n"
+        "}");
+
+    diff.readPrevious(previous);
+    diff.readCurrent(current);
+    ASSERT_FALSE(diff.isChanged());
+}
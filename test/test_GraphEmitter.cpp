@@ -0,0 +1,51 @@
+#include "gtest/gtest.h"
+
+#include "../DotEmitter.h"
+#include "../GraphEmitter.h"
+#include "../JsonEmitter.h"
+#include "../Node.h"
+
+#include <sstream>
+
+TEST(GraphEmitterTest, TypeNames)
+{
+    ASSERT_STREQ("start", GraphEmitter::getTypeName(Node::START));
+    ASSERT_STREQ("decision", GraphEmitter::getTypeName(Node::DECISION));
+    ASSERT_STREQ("elided", GraphEmitter::getTypeName(Node::ELIDED));
+}
+
+TEST(GraphEmitterTest, FanOut)
+{
+    StringTable strings;
+    Graph graph(strings);
+    graph.reset(2, 1);
+    graph.addNode(0, Node::ACTIVITY, strings.intern(std::string("call f")), StringTable::Empty, NULL);
+    graph.addEdge(1, StringTable::Empty, -1);
+    graph.addNode(1, Node::END, strings.intern(std::string("ret")), StringTable::Empty, NULL);
+    graph.finish();
+
+    // Written together, each format comes out as it would on its own.
+    std::ostringstream dotAlone;
+    std::ostringstream jsonAlone;
+    DotEmitter dotOnly(dotAlone);
+    JsonEmitter jsonOnly(jsonAlone);
+    std::vector<GraphEmitter*> emitters;
+    emitters.push_back(&dotOnly);
+    GraphEmitter::emitNodes(graph, emitters);
+    emitters.clear();
+    emitters.push_back(&jsonOnly);
+    GraphEmitter::emitNodes(graph, emitters);
+
+    std::ostringstream dotOut;
+    std::ostringstream jsonOut;
+    DotEmitter dot(dotOut);
+    JsonEmitter json(jsonOut);
+    emitters.clear();
+    emitters.push_back(&dot);
+    emitters.push_back(&json);
+    GraphEmitter::emitNodes(graph, emitters);
+
+    ASSERT_EQ(dotAlone.str(), dotOut.str());
+    ASSERT_EQ(jsonAlone.str(), jsonOut.str());
+    ASSERT_NE(std::string::npos, dotOut.str().find("0 -> 1"));
+}
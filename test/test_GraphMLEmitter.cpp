@@ -0,0 +1,43 @@
+#include "gtest/gtest.h"
+
+#include "../GraphMLEmitter.h"
+#include "../Node.h"
+
+#include <sstream>
+
+TEST(GraphMLEmitterTest, Escaped)
+{
+    std::ostringstream out;
+    GraphMLEmitter::writeEscaped(out, std::string("vector<int>& \"v\"\n\x01"));
+    ASSERT_EQ("vector&lt;int&gt;&amp; &quot;v&quot;&#10; ", out.str());
+}
+
+TEST(GraphMLEmitterTest, Graph)
+{
+    StringTable strings;
+    Graph graph(strings);
+    graph.reset(2, 1);
+    graph.addNode(0, Node::DECISION, strings.intern(std::string("x < 3")), StringTable::Empty, NULL);
+    graph.addEdge(1, strings.intern(std::string("true")), 4);
+    graph.addNode(1, Node::END, strings.intern(std::string("ret")), StringTable::Empty, NULL);
+    graph.finish();
+
+    std::ostringstream out;
+    GraphMLEmitter emitter(out);
+    emitter.beginGraph("main", "int main()");
+    emitter.emitNode(graph, 0);
+    emitter.emitNode(graph, 1);
+    emitter.endGraph();
+
+    std::string text = out.str();
+    ASSERT_EQ(0u, text.find("<?xml"));
+    ASSERT_NE(std::string::npos, text.find("<graph id=\"main\" edgedefault=\"directed\">\n"
+                                           "<data key=\"glabel\">int main()</data>\n"
+                                           "<node id=\"0\"><data key=\"type\">decision</data>"
+                                           "<data key=\"label\">x &lt; 3</data></node>\n"
+                                           "<edge source=\"0\" target=\"1\"><data key=\"elabel\">true</data>"
+                                           "<data key=\"weight\">4</data></edge>\n"
+                                           "<node id=\"1\"><data key=\"type\">end</data>"
+                                           "<data key=\"label\">ret</data></node>\n"
+                                           "</graph>\n</graphml>\n"));
+}
@@ -0,0 +1,106 @@
+#include "gtest/gtest.h"
+
+#include "../GraphSlicer.h"
+#include "../Node.h"
+
+/**
+ * Fills graph with a function deciding between a call to lock and a call
+ * to log, both returning:
+ *
+ *   0 start -> 1 decision -> 2 lock -> 4 ret
+ *                         -> 3 log  -> 4 ret
+ */
+static void
+buildGraph(Graph& graph)
+{
+    graph.reset(5, 5);
+    graph.addNode(0, Node::START, graph.getStrings().intern(std::string("f")), StringTable::Empty, NULL);
+    graph.addEdge(1, StringTable::Empty, -1);
+    graph.addNode(1, Node::DECISION, graph.getStrings().intern(std::string("x")), StringTable::Empty, NULL);
+    graph.addEdge(2, graph.getStrings().intern(std::string("true")), -1);
+    graph.addEdge(3, graph.getStrings().intern(std::string("false")), -1);
+    graph.addNode(2, Node::ACTIVITY, graph.getStrings().intern(std::string("call lock")), StringTable::Empty, NULL);
+    graph.addEdge(4, StringTable::Empty, -1);
+    graph.addNode(3, Node::ACTIVITY, graph.getStrings().intern(std::string("call log")), StringTable::Empty, NULL);
+    graph.addEdge(4, StringTable::Empty, -1);
+    graph.addNode(4, Node::END, graph.getStrings().intern(std::string("ret")), StringTable::Empty, NULL);
+    graph.finish();
+}
+
+TEST(GraphSlicerTest, PathsToSink)
+{
+    StringTable strings;
+    Graph graph(strings);
+    Graph slice(strings);
+    buildGraph(graph);
+
+    std::vector<Graph::Index> sinks(1, 2);
+    GraphSlicer::slice(graph, 0, std::vector<Graph::Index>(1, 0), &sinks, slice);
+
+    // start, decision and lock, plus an elided node each for the false
+    // branch and for what follows lock.
+    ASSERT_EQ(5u, slice.size());
+    ASSERT_EQ(Graph::None, slice.find(3));
+    ASSERT_EQ(Graph::None, slice.find(4));
+    ASSERT_EQ(Node::ELIDED, slice.getType(3));
+    ASSERT_EQ("paths elided", slice.getLabel(3));
+    ASSERT_EQ(Node::ELIDED, slice.getType(4));
+
+    Graph::Index decision = slice.find(1);
+    ASSERT_EQ(2u, slice.getEdgesEnd(decision) - slice.getEdgesBegin(decision));
+    ASSERT_EQ(slice.find(2), slice.getEdgeTarget(slice.getEdgesBegin(decision)));
+    ASSERT_EQ("true", slice.getEdgeLabel(slice.getEdgesBegin(decision)));
+    Graph::Index lock = slice.find(2);
+    ASSERT_EQ(Node::ELIDED, slice.getType(slice.getEdgeTarget(slice.getEdgesBegin(lock))));
+}
+
+TEST(GraphSlicerTest, NoSinkKeepsStart)
+{
+    StringTable strings;
+    Graph graph(strings);
+    Graph slice(strings);
+    buildGraph(graph);
+
+    std::vector<Graph::Index> sinks;
+    GraphSlicer::slice(graph, 0, std::vector<Graph::Index>(1, 0), &sinks, slice);
+
+    // Only the start node, leading to everything else elided.
+    ASSERT_EQ(2u, slice.size());
+    ASSERT_EQ(Node::START, slice.getType(0));
+    ASSERT_EQ(Node::ELIDED, slice.getType(1));
+    ASSERT_EQ(1u, slice.getEdgeCount());
+}
+
+TEST(GraphSlicerTest, FromSource)
+{
+    StringTable strings;
+    Graph graph(strings);
+    Graph slice(strings);
+    buildGraph(graph);
+
+    GraphSlicer::slice(graph, 0, std::vector<Graph::Index>(1, 3), NULL, slice);
+
+    // log and ret, entered from start through an elided node.
+    ASSERT_EQ(4u, slice.size());
+    ASSERT_EQ(Graph::None, slice.find(1));
+    ASSERT_EQ(Graph::None, slice.find(2));
+    Graph::Index start = slice.find(0);
+    ASSERT_EQ(1u, slice.getEdgesEnd(start) - slice.getEdgesBegin(start));
+    Graph::Index entry = slice.getEdgeTarget(slice.getEdgesBegin(start));
+    ASSERT_EQ(Node::ELIDED, slice.getType(entry));
+    ASSERT_EQ(slice.find(3), slice.getEdgeTarget(slice.getEdgesBegin(entry)));
+}
+
+TEST(GraphSlicerTest, FromReachedSource)
+{
+    StringTable strings;
+    Graph graph(strings);
+    Graph slice(strings);
+    buildGraph(graph);
+
+    // The decision follows the start node directly, so it needs no
+    // elided node to be entered through.
+    GraphSlicer::slice(graph, 0, std::vector<Graph::Index>(1, 1), NULL, slice);
+    ASSERT_EQ(5u, slice.size());
+    ASSERT_EQ(5u, slice.getEdgeCount());
+}
@@ -0,0 +1,151 @@
+#include "gtest/gtest.h"
+
+#include "../Journal.h"
+#include "../OutputFile.h"
+
+#include <fstream>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * Writes a file through OutputFile.
+ * @return The hash OutputFile gives it.
+ */
+static uint64_t
+writeFile(const char* path, const char* content)
+{
+    OutputFile output;
+    output.open(path);
+    output << content;
+    output.close();
+    return output.getHash();
+}
+
+TEST(JournalTest, HashMatchesOutputFile)
+{
+    uint64_t written = writeFile("test_journal.dot", "digraph test {\n}");
+    uint64_t read;
+
+    ASSERT_TRUE(Journal::hashFile("test_journal.dot", read));
+    ASSERT_EQ(written, read);
+    ASSERT_FALSE(Journal::hashFile("test_journal_missing.dot", read));
+    unlink("test_journal.dot");
+}
+
+TEST(JournalTest, Resume)
+{
+    std::string error;
+    uint64_t hash = writeFile("test_journal_f.dot", "digraph f {\n}");
+    {
+        Journal journal;
+        ASSERT_TRUE(journal.open("test.journal", false, error));
+        journal.recordStart("function:f");
+        journal.recordFile("function:f", "test_journal_f.dot", hash);
+        journal.recordDone("function:f");
+        // Killed before g was done.
+        journal.recordStart("function:g");
+        // Nothing from the current run is known.
+        ASSERT_FALSE(journal.isFinished("function:f"));
+    }
+
+    Journal journal;
+    ASSERT_TRUE(journal.open("test.journal", true, error));
+    ASSERT_TRUE(journal.isFinished("function:f"));
+    ASSERT_FALSE(journal.isFinished("function:g"));
+    ASSERT_FALSE(journal.isFinished("function:h"));
+    ASSERT_FALSE(journal.hasCrashed("function:g"));
+    ASSERT_EQ(1, journal.getFiles("function:f").size());
+    ASSERT_EQ("test_journal_f.dot", journal.getFiles("function:f")[0]);
+
+    // Changed output is done again.
+    writeFile("test_journal_f.dot", "digraph changed {\n}");
+    ASSERT_FALSE(journal.isFinished("function:f"));
+    journal.close();
+
+    // Without resuming, the journal starts over.
+    ASSERT_TRUE(journal.open("test.journal", false, error));
+    journal.close();
+    ASSERT_TRUE(journal.open("test.journal", true, error));
+    ASSERT_TRUE(journal.getFiles("function:f").empty());
+    journal.close();
+    unlink("test.journal");
+    unlink("test_journal_f.dot");
+}
+
+TEST(JournalTest, Crash)
+{
+    std::string error;
+    {
+        std::ofstream records("test.journal");
+        records << "start\tfunction:f\ncrash\tfunction:f\nstart\tfunction:g\ncrash\tfunction:g\n"
+                << "start\tfunction:g\ndone\tfunction:g\nstart\tfunction:h\ndo";
+    }
+
+    Journal journal;
+    ASSERT_TRUE(journal.open("test.journal", true, error));
+    ASSERT_TRUE(journal.hasCrashed("function:f"));
+    // Done since it crashed.
+    ASSERT_FALSE(journal.hasCrashed("function:g"));
+    ASSERT_TRUE(journal.isFinished("function:g"));
+    journal.recordDone("function:h");
+    journal.close();
+
+    // The torn record was ended before the next was added.
+    ASSERT_TRUE(journal.open("test.journal", true, error));
+    ASSERT_TRUE(journal.isFinished("function:h"));
+    journal.close();
+    unlink("test.journal");
+}
+
+/**
+ * Crashes while writing a file for function:f, as the writer thread would.
+ */
+static void*
+crashWriting(void* argument)
+{
+    Journal* journal = static_cast<Journal*>(argument);
+    journal->recordWriting("function:f");
+    raise(SIGSEGV);
+    return NULL;
+}
+
+TEST(JournalTest, CrashWhileWriting)
+{
+    pid_t child = fork();
+    ASSERT_NE(-1, child);
+    if (child == 0) {
+        std::string error;
+        Journal journal;
+        journal.open("test.journal", false, error);
+        journal.recordStart("function:f");
+        // The pass has moved on to g while f's files are written.
+        journal.recordStart("function:g");
+        pthread_t thread;
+        pthread_create(&thread, NULL, &crashWriting, &journal);
+        pthread_join(thread, NULL);
+        _exit(0);
+    }
+    int status;
+    ASSERT_EQ(child, waitpid(child, &status, 0));
+    ASSERT_TRUE(WIFSIGNALED(status));
+
+    std::string error;
+    Journal journal;
+    ASSERT_TRUE(journal.open("test.journal", true, error));
+    ASSERT_TRUE(journal.hasCrashed("function:f"));
+    ASSERT_FALSE(journal.hasCrashed("function:g"));
+    journal.close();
+    unlink("test.journal");
+}
+
+TEST(JournalTest, OpenFailure)
+{
+    Journal journal;
+    std::string error;
+
+    ASSERT_FALSE(journal.open("no_such_directory/test.journal", false, error));
+    ASSERT_FALSE(journal.isOpen());
+    ASSERT_NE("", error);
+}
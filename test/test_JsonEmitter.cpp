@@ -0,0 +1,42 @@
+#include "gtest/gtest.h"
+
+#include "../JsonEmitter.h"
+#include "../Node.h"
+
+#include <sstream>
+
+TEST(JsonEmitterTest, Escaped)
+{
+    std::ostringstream out;
+    JsonEmitter::writeEscaped(out, std::string("a\"b\\c\nd\x01" "e"));
+    ASSERT_EQ("a\\\"b\\\\c\\nd\\u0001e", out.str());
+}
+
+TEST(JsonEmitterTest, Graph)
+{
+    StringTable strings;
+    Graph graph(strings);
+    graph.reset(3, 2);
+    graph.addNode(0, Node::START, strings.intern(std::string("int main()")), StringTable::Empty, NULL);
+    graph.addEdge(2, StringTable::Empty, -1);
+    graph.addNode(2, Node::DECISION, strings.intern(std::string("x < 3")), StringTable::Empty, NULL);
+    graph.addEdge(5, strings.intern(std::string("true")), 7);
+    graph.addNode(5, Node::END, strings.intern(std::string("ret")), StringTable::Empty, NULL);
+    graph.finish();
+
+    std::ostringstream out;
+    JsonEmitter emitter(out);
+    emitter.beginGraph("main", "int main()");
+    for (Graph::Index node = 0; node < graph.size(); node++) {
+        emitter.emitNode(graph, node);
+    }
+    emitter.endGraph();
+
+    ASSERT_EQ("{\"graph\": \"main\", \"label\": \"int main()\", \"nodes\": [\n"
+              "{\"id\": \"0\", \"type\": \"start\", \"label\": \"int main()\", \"edges\": ["
+              "{\"to\": \"2\", \"label\": \"\"}]},\n"
+              "{\"id\": \"2\", \"type\": \"decision\", \"label\": \"x < 3\", \"edges\": ["
+              "{\"to\": \"5\", \"label\": \"true\", \"weight\": 7}]},\n"
+              "{\"id\": \"5\", \"type\": \"end\", \"label\": \"ret\", \"edges\": []}\n"
+              "]}\n", out.str());
+}
@@ -0,0 +1,49 @@
+#include "gtest/gtest.h"
+
+#include "../LabelRenderer.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Instructions.h"
+
+static std::string
+renderAllocaForTest(llvm::Instruction*)
+{
+    return "custom alloca";
+}
+
+TEST(LabelRendererTest, HiddenInstruction)
+{
+    llvm::LLVMContext context;
+    llvm::AllocaInst* instruction = new llvm::AllocaInst(llvm::Type::getInt32Ty(context));
+    ASSERT_EQ("", LabelRenderer::render(instruction));
+    delete instruction;
+}
+
+TEST(LabelRendererTest, UnconditionalBranch)
+{
+    llvm::LLVMContext context;
+    llvm::BasicBlock* target = llvm::BasicBlock::Create(context);
+    llvm::BranchInst* instruction = llvm::BranchInst::Create(target);
+    ASSERT_EQ("", LabelRenderer::render(instruction));
+    delete instruction;
+    delete target;
+}
+
+TEST(LabelRendererTest, RegisterRenderer)
+{
+    llvm::LLVMContext context;
+    llvm::AllocaInst* instruction = new llvm::AllocaInst(llvm::Type::getInt32Ty(context));
+
+    LabelRenderer::registerRenderer(llvm::Instruction::Alloca, renderAllocaForTest);
+    ASSERT_EQ("custom alloca", LabelRenderer::render(instruction));
+
+    // NULL puts the built in renderer back.
+    LabelRenderer::registerRenderer(llvm::Instruction::Alloca, NULL);
+    ASSERT_EQ("", LabelRenderer::render(instruction));
+    delete instruction;
+}
+
+TEST(LabelRendererTest, DemangledName)
+{
+    ASSERT_EQ("foo::bar()", LabelRenderer::getDemangledName("_ZN3foo3barEv"));
+    ASSERT_EQ("main", LabelRenderer::getDemangledName("main"));
+}
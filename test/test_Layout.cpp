@@ -0,0 +1,134 @@
+#include "gtest/gtest.h"
+
+#include "../Layout.h"
+#include "../Node.h"
+
+#include <sstream>
+
+/**
+ * Builds a decision at 0 branching to 1 and 2, both joining at 3, which
+ * loops back to 0.
+ */
+static void
+buildDiamond(Graph& graph)
+{
+    StringTable::Id label = graph.getStrings().intern(std::string("x"));
+    graph.reset(4, 5);
+    graph.addNode(0, Node::DECISION, label, StringTable::Empty, NULL);
+    graph.addEdge(1, StringTable::Empty, -1);
+    graph.addEdge(2, StringTable::Empty, -1);
+    graph.addNode(1, Node::ACTIVITY, label, StringTable::Empty, NULL);
+    graph.addEdge(3, StringTable::Empty, -1);
+    graph.addNode(2, Node::ACTIVITY, label, StringTable::Empty, NULL);
+    graph.addEdge(3, StringTable::Empty, -1);
+    graph.addNode(3, Node::ACTIVITY, label, StringTable::Empty, NULL);
+    graph.addEdge(0, StringTable::Empty, -1);
+    graph.finish();
+}
+
+TEST(LayoutTest, Empty)
+{
+    StringTable strings;
+    Graph graph(strings);
+    Layout layout;
+    layout.compute(graph, 4);
+    ASSERT_EQ(0, layout.size());
+    ASSERT_EQ(0, layout.getLayerCount());
+}
+
+TEST(LayoutTest, Layers)
+{
+    StringTable strings;
+    Graph graph(strings);
+    buildDiamond(graph);
+    Layout layout;
+    layout.compute(graph, 4);
+
+    // The edge back to 0 doesn't push it below 3.
+    ASSERT_EQ(3, layout.getLayerCount());
+    ASSERT_EQ(0, layout.getLayer(0));
+    ASSERT_EQ(1, layout.getLayer(1));
+    ASSERT_EQ(1, layout.getLayer(2));
+    ASSERT_EQ(2, layout.getLayer(3));
+}
+
+TEST(LayoutTest, LongestPath)
+{
+    StringTable strings;
+    StringTable::Id label = strings.intern(std::string("x"));
+    Graph graph(strings);
+    graph.reset(3, 3);
+    graph.addNode(0, Node::DECISION, label, StringTable::Empty, NULL);
+    graph.addEdge(1, StringTable::Empty, -1);
+    graph.addEdge(2, StringTable::Empty, -1);
+    graph.addNode(1, Node::ACTIVITY, label, StringTable::Empty, NULL);
+    graph.addEdge(2, StringTable::Empty, -1);
+    graph.addNode(2, Node::END, label, StringTable::Empty, NULL);
+    graph.finish();
+
+    Layout layout;
+    layout.compute(graph, 0);
+    ASSERT_EQ(2, layout.getLayer(2));
+}
+
+TEST(LayoutTest, Coordinates)
+{
+    StringTable strings;
+    Graph graph(strings);
+    buildDiamond(graph);
+    Layout layout;
+    layout.compute(graph, 4);
+
+    // Layers run down the page, siblings side by side, each layer
+    // centred.
+    ASSERT_GT(layout.getY(0), layout.getY(1));
+    ASSERT_EQ(layout.getY(1), layout.getY(2));
+    ASSERT_GT(layout.getY(2), layout.getY(3));
+    ASSERT_LT(layout.getX(1), layout.getX(2));
+    ASSERT_EQ(layout.getX(0), layout.getX(3));
+    ASSERT_EQ((layout.getX(1) + layout.getX(2)) / 2, layout.getX(0));
+    ASSERT_EQ(2 * 54 + 18, layout.getWidth());
+    ASSERT_EQ(3 * 36 + 2 * 36, layout.getHeight());
+
+    std::ostringstream out;
+    layout.writePosition(out, 0);
+    ASSERT_EQ("63,162", out.str());
+}
+
+TEST(LayoutTest, SweepsRemoveCrossing)
+{
+    // 0 and 1 lead to 3 and 2 respectively, which cross in function
+    // order.
+    StringTable strings;
+    StringTable::Id label = strings.intern(std::string("x"));
+    Graph graph(strings);
+    graph.reset(5, 4);
+    graph.addNode(0, Node::DECISION, label, StringTable::Empty, NULL);
+    graph.addEdge(1, StringTable::Empty, -1);
+    graph.addEdge(2, StringTable::Empty, -1);
+    graph.addNode(1, Node::ACTIVITY, label, StringTable::Empty, NULL);
+    graph.addEdge(4, StringTable::Empty, -1);
+    graph.addNode(2, Node::ACTIVITY, label, StringTable::Empty, NULL);
+    graph.addEdge(3, StringTable::Empty, -1);
+    graph.addNode(3, Node::END, label, StringTable::Empty, NULL);
+    graph.addNode(4, Node::END, label, StringTable::Empty, NULL);
+    graph.finish();
+
+    Layout unswept;
+    unswept.compute(graph, 0);
+    ASSERT_EQ(0, unswept.getOrder(3));
+    ASSERT_EQ(1, unswept.getOrder(4));
+
+    Layout layout;
+    layout.compute(graph, 1);
+    ASSERT_EQ(1, layout.getOrder(3));
+    ASSERT_EQ(0, layout.getOrder(4));
+}
+
+TEST(LayoutTest, LabelSize)
+{
+    ASSERT_EQ(54, Layout::getLabelWidth(""));
+    ASSERT_EQ(16 + 7 * 11, Layout::getLabelWidth("short\nmuch longer"));
+    ASSERT_EQ(36, Layout::getLabelHeight("one line"));
+    ASSERT_EQ(50, Layout::getLabelHeight("two\nlines"));
+}
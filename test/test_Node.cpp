@@ -7,28 +7,32 @@
 
 TEST(NodeTest, NodeConstructor)
 {
-    Node node(1, Node::START);
+    StringTable strings;
+    Node node(strings, 1, Node::START);
     EXPECT_EQ(1, node.getNodeId());
     EXPECT_EQ(Node::START, node.getNodeType());
 }
 
 TEST(NodeTest, NodeConstructorDefaultType)
 {
-    Node node(1);
+    StringTable strings;
+    Node node(strings, 1);
     EXPECT_EQ(1, node.getNodeId());
     EXPECT_EQ(Node::ACTIVITY, node.getNodeType());
 }
 
 TEST(NodeTest, NodeConstructorDefaults)
 {
-    Node node;
+    StringTable strings;
+    Node node(strings);
     EXPECT_EQ(0, node.getNodeId());
     EXPECT_EQ(Node::ACTIVITY, node.getNodeType());
 }
 
 TEST(NodeTest, NodeLabels)
 {
-    Node node(1, Node::ACTIVITY);
+    StringTable strings;
+    Node node(strings, 1, Node::ACTIVITY);
     node.setNodeLabel("test_label");
     node.setNodeName("test_name");
     ASSERT_EQ("test_label", node.getNodeLabel());
@@ -37,8 +41,9 @@ TEST(NodeTest, NodeLabels)
 
 TEST(NodeTest, NodeEdge)
 {
-    Node node;
-    node.addNodeEdge(new Edge("test_edge"));
+    StringTable strings;
+    Node node(strings);
+    node.addNodeEdge(new Edge(strings, "test_edge"));
     std::vector<Edge*> edges = node.getNodeEdges();
     ASSERT_EQ(1, edges.size());
     ASSERT_EQ("test_edge", edges[0]->getId());
@@ -46,13 +51,15 @@ TEST(NodeTest, NodeEdge)
 
 TEST(NodeTest, NullInstructionBlockEdges)
 {
-    Node node;
+    StringTable strings;
+    Node node(strings);
     ASSERT_EQ(0, node.getBlockEdges().size());
 }
 
 TEST(NodeTest, NoBlockEdgesInstruction)
 {
-    Node node;
+    StringTable strings;
+    Node node(strings);
     // Use an Allocation instruction since they won't ever result in
     // block edges (branches).
     llvm::LLVMContext context;
@@ -63,7 +70,8 @@ TEST(NodeTest, NoBlockEdgesInstruction)
 
 TEST(NodeTest, UnconditionalBranchInstruction)
 {
-    Node node;
+    StringTable strings;
+    Node node(strings);
     llvm::LLVMContext context;
     llvm::BasicBlock* source = llvm::BasicBlock::Create(context);
     llvm::BasicBlock* target = llvm::BasicBlock::Create(context);
@@ -76,7 +84,8 @@ TEST(NodeTest, UnconditionalBranchInstruction)
 
 TEST(NodeTest, ConditionalBranchInstruction)
 {
-    Node node;
+    StringTable strings;
+    Node node(strings);
     llvm::LLVMContext context;
     llvm::BasicBlock* source = llvm::BasicBlock::Create(context);
     llvm::BasicBlock* true_target = llvm::BasicBlock::Create(context);
@@ -98,7 +107,8 @@ TEST(NodeTest, ConditionalBranchInstruction)
 
 TEST(NodeTest, SwitchInstruction)
 {
-    Node node;
+    StringTable strings;
+    Node node(strings);
     llvm::LLVMContext context;
     llvm::BasicBlock* source = llvm::BasicBlock::Create(context);
     llvm::BasicBlock* default_target = llvm::BasicBlock::Create(context);
@@ -123,9 +133,69 @@ TEST(NodeTest, SwitchInstruction)
     ASSERT_EQ(target_two, node.getBlockEdges()["2"]);
 }
 
+TEST(NodeTest, SwitchInstructionGroupedCases)
+{
+    StringTable strings;
+    Node node(strings);
+    llvm::LLVMContext context;
+    llvm::BasicBlock* source = llvm::BasicBlock::Create(context);
+    llvm::BasicBlock* default_target = llvm::BasicBlock::Create(context);
+    llvm::BasicBlock* target_one = llvm::BasicBlock::Create(context);
+    llvm::BasicBlock* target_two = llvm::BasicBlock::Create(context);
+    llvm::ConstantInt* condition = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context),
+                                                          0, false);
+    llvm::SwitchInst* instruction = llvm::SwitchInst::Create(condition, default_target,
+                                                             10);
+    // 1 through 7 and 12 go to target_one, 8 to target_two and 9 to
+    // the default destination.
+    for (int i = 7; i >= 1; i--) {
+        instruction->addCase(llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), i),
+                             target_one);
+    }
+    instruction->addCase(llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), 12),
+                         target_one);
+    instruction->addCase(llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), 8),
+                         target_two);
+    instruction->addCase(llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), 9),
+                         default_target);
+    source->getInstList().push_back(instruction);
+    node.setInstruction(instruction);
+
+    ASSERT_EQ(3, node.getBlockEdges().size());
+    ASSERT_EQ(default_target, node.getBlockEdges()["default, 9"]);
+    ASSERT_EQ(target_one, node.getBlockEdges()["1..7, 12"]);
+    ASSERT_EQ(target_two, node.getBlockEdges()["8"]);
+}
+
+TEST(NodeTest, SwitchInstructionUnsignedCases)
+{
+    StringTable strings;
+    Node node(strings);
+    llvm::LLVMContext context;
+    llvm::BasicBlock* source = llvm::BasicBlock::Create(context);
+    llvm::BasicBlock* default_target = llvm::BasicBlock::Create(context);
+    llvm::BasicBlock* target = llvm::BasicBlock::Create(context);
+    llvm::ConstantInt* condition = llvm::ConstantInt::get(llvm::Type::getInt8Ty(context),
+                                                          0, false);
+    llvm::SwitchInst* instruction = llvm::SwitchInst::Create(condition, default_target,
+                                                             4);
+    // Case values are printed unsigned, so 255 sorts after 1 rather
+    // than printing as -1 ahead of it.
+    instruction->addCase(llvm::ConstantInt::get(llvm::Type::getInt8Ty(context), 255),
+                         target);
+    instruction->addCase(llvm::ConstantInt::get(llvm::Type::getInt8Ty(context), 1),
+                         target);
+    source->getInstList().push_back(instruction);
+    node.setInstruction(instruction);
+
+    ASSERT_EQ(2, node.getBlockEdges().size());
+    ASSERT_EQ(target, node.getBlockEdges()["1, 255"]);
+}
+
 TEST(NodeTest, InvokeInstruction)
 {
-    Node node;
+    StringTable strings;
+    Node node(strings);
     llvm::LLVMContext context;
     llvm::BasicBlock* source = llvm::BasicBlock::Create(context);
     llvm::BasicBlock* normal_target = llvm::BasicBlock::Create(context);
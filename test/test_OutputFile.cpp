@@ -0,0 +1,117 @@
+#include "gtest/gtest.h"
+
+#include "../OutputFile.h"
+
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+/**
+ * @return the content written for a graph big enough to go through the
+ * stream buffer several times.
+ */
+static std::string
+largeGraph()
+{
+    std::ostringstream graph;
+    graph << "digraph test {\n";
+    for (int i = 0; i < 20000; i++) {
+        graph << i << " [label=\"call printf (...)\" shape=box]\n";
+        graph << i << " -> " << i + 1 << "[label=\"\"]\n";
+    }
+    graph << "}";
+    return graph.str();
+}
+
+TEST(OutputFileTest, PlainOutput)
+{
+    OutputFile output;
+    std::string content = largeGraph();
+
+    output.open("test_output_plain.dot");
+    ASSERT_TRUE(output.is_open());
+    output << content;
+    output.close();
+    ASSERT_FALSE(output.is_open());
+    ASSERT_TRUE(output.good());
+
+    std::ifstream input("test_output_plain.dot");
+    std::ostringstream read;
+    read << input.rdbuf();
+    ASSERT_EQ(content, read.str());
+    unlink("test_output_plain.dot");
+}
+
+TEST(OutputFileTest, OpenFailure)
+{
+    OutputFile output;
+    output.open("no/such/directory/test.dot");
+    ASSERT_FALSE(output.is_open());
+    ASSERT_TRUE(output.fail());
+}
+
+TEST(OutputFileTest, ReplacedOnClose)
+{
+    {
+        std::ofstream previous("test_output_atomic.dot");
+        previous << "previous";
+    }
+
+    OutputFile output;
+    output.open("test_output_atomic.dot");
+    output << "current";
+    output.flush();
+
+    // Until closed, readers still see the previous file.
+    std::ifstream before("test_output_atomic.dot");
+    std::ostringstream readBefore;
+    readBefore << before.rdbuf();
+    ASSERT_EQ("previous", readBefore.str());
+
+    output.close();
+    ASSERT_TRUE(output.good());
+    std::ifstream after("test_output_atomic.dot");
+    std::ostringstream readAfter;
+    readAfter << after.rdbuf();
+    ASSERT_EQ("current", readAfter.str());
+
+    std::ostringstream temporary;
+    temporary << "test_output_atomic.dot.tmp." << getpid();
+    ASSERT_NE(0, access(temporary.str().c_str(), F_OK));
+    unlink("test_output_atomic.dot");
+}
+
+#ifdef ROCKETSHIP_HAVE_ZLIB
+TEST(OutputFileTest, GzipOutput)
+{
+    OutputFile output(OutputFile::GZIP, 9);
+    std::string content = largeGraph();
+
+    ASSERT_EQ(".gz", output.getSuffix());
+    output.open("test_output_gzip.dot");
+    output << content;
+    output.close();
+    ASSERT_TRUE(output.good());
+
+    gzFile input = gzopen("test_output_gzip.dot.gz", "rb");
+    ASSERT_TRUE(input != NULL);
+    std::string read;
+    char buffer[4096];
+    int length;
+    while ((length = gzread(input, buffer, sizeof(buffer))) > 0) {
+        read.append(buffer, length);
+    }
+    gzclose(input);
+    ASSERT_EQ(content, read);
+    unlink("test_output_gzip.dot.gz");
+}
+#endif
+
+#ifndef ROCKETSHIP_HAVE_ZSTD
+TEST(OutputFileTest, UnavailableCompressionFallsBack)
+{
+    OutputFile output(OutputFile::ZSTD);
+    ASSERT_EQ(OutputFile::NONE, output.getCompression());
+    ASSERT_EQ("", output.getSuffix());
+}
+#endif
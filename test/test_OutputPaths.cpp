@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+
+#include "../OutputPaths.h"
+
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+TEST(OutputPathsTest, Unsharded)
+{
+    OutputPaths paths;
+    ASSERT_EQ("main.dot", paths.getRelativePath("main", ".dot"));
+    ASSERT_EQ("main.dot", paths.getPath("main", ".dot"));
+    ASSERT_EQ("f.dot", paths.getLink("main", "f", ".dot"));
+    ASSERT_EQ("m.metrics.csv", paths.getRootPath("m.metrics.csv"));
+}
+
+TEST(OutputPathsTest, LongNames)
+{
+    std::string identifier(300, 'a');
+    std::string other = identifier + "b";
+    std::string name = OutputPaths::getFileName(identifier);
+
+    ASSERT_EQ(117, name.length());
+    ASSERT_EQ(std::string(100, 'a') + "_", name.substr(0, 101));
+    ASSERT_NE(name, OutputPaths::getFileName(other));
+    ASSERT_EQ(name, OutputPaths::getFileName(identifier));
+    ASSERT_EQ("short", OutputPaths::getFileName("short"));
+}
+
+TEST(OutputPathsTest, Sharded)
+{
+    OutputPaths paths;
+    paths.setRoot("test_output_paths/");
+    paths.setShardDepth(2);
+
+    std::string relative = paths.getRelativePath("main", ".dot");
+    ASSERT_EQ(14, relative.length());
+    ASSERT_EQ('/', relative[2]);
+    ASSERT_EQ('/', relative[5]);
+    ASSERT_EQ("main.dot", relative.substr(6));
+
+    std::string path = paths.getPath("main", ".dot");
+    ASSERT_EQ("test_output_paths/" + relative, path);
+    struct stat status;
+    std::string directory = path.substr(0, path.rfind('/'));
+    ASSERT_EQ(0, stat(directory.c_str(), &status));
+    ASSERT_TRUE(S_ISDIR(status.st_mode));
+
+    // Links from one shard to another climb out of both levels.
+    ASSERT_EQ("main.L1.dot", paths.getLink("main", "main", ".L1.dot"));
+    ASSERT_EQ("../../" + paths.getRelativePath("f", ".dot"), paths.getLink("main", "f", ".dot"));
+
+    rmdir(directory.c_str());
+    rmdir(directory.substr(0, directory.rfind('/')).c_str());
+    rmdir("test_output_paths");
+}
+
+TEST(OutputPathsTest, Manifest)
+{
+    OutputPaths paths;
+    paths.setShardDepth(1);
+    paths.record("main", "main");
+    paths.record("_ZN1a1bEv", "_ZN1a1bEv");
+    paths.record("main", "main");
+
+    std::ostringstream out;
+    paths.writeManifest(out);
+    ASSERT_EQ(paths.getRelativePath("main", "") + "\tmain\n" +
+              paths.getRelativePath("_ZN1a1bEv", "") + "\t_ZN1a1bEv\n", out.str());
+
+    std::ostringstream empty;
+    paths.writeManifest(empty);
+    ASSERT_EQ("", empty.str());
+}
@@ -0,0 +1,156 @@
+#include "gtest/gtest.h"
+
+#include "../RocketShip.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Module.h"
+#include "llvm/PassManager.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/IRBuilder.h"
+
+#include <dirent.h>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <stdlib.h>
+#include <unistd.h>
+
+/**
+ * Turns on -rocketship-dedup.  Options can only be given once per
+ * process, so this parses them on the first call only.
+ */
+static void
+enableDedup()
+{
+    static bool parsed = false;
+    if (parsed) {
+        return;
+    }
+    static char program[] = "test_RocketShip";
+    static char dedup[] = "-rocketship-dedup";
+    char* argv[] = { program, dedup };
+    llvm::cl::ParseCommandLineOptions(2, argv);
+    parsed = true;
+}
+
+/**
+ * Creates "void name()" in module, calling sink then returning, so every
+ * function created here has the same graph.
+ */
+static llvm::Function*
+createFunction(llvm::Module* module, std::string name)
+{
+    llvm::LLVMContext& context = module->getContext();
+    llvm::FunctionType* type = llvm::FunctionType::get(llvm::Type::getVoidTy(context),
+                                                       false);
+    llvm::Function* sink = module->getFunction("sink");
+    if (sink == NULL) {
+        sink = llvm::Function::Create(type, llvm::GlobalValue::ExternalLinkage,
+                                      "sink", module);
+    }
+    llvm::Function* function = llvm::Function::Create(type, llvm::GlobalValue::ExternalLinkage,
+                                                      name, module);
+    llvm::IRBuilder<> builder(context);
+    builder.SetInsertPoint(llvm::BasicBlock::Create(context, "entry", function));
+    builder.CreateCall(sink);
+    builder.CreateRetVoid();
+    return function;
+}
+
+/**
+ * @return The names of the DOT files in a directory.
+ */
+static std::set<std::string>
+listDotFiles(const std::string& path)
+{
+    std::set<std::string> files;
+    DIR* directory = opendir(path.c_str());
+    if (directory != NULL) {
+        struct dirent* entry;
+        while ((entry = readdir(directory)) != NULL) {
+            std::string name = entry->d_name;
+            if (name.length() > 4 && name.compare(name.length() - 4, 4, ".dot") == 0) {
+                files.insert(name);
+            }
+        }
+        closedir(directory);
+    }
+    return files;
+}
+
+/**
+ * @return The content of a file, empty if it can't be read.
+ */
+static std::string
+readFile(const std::string& path)
+{
+    std::ifstream in(path.c_str());
+    std::ostringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+
+/**
+ * Deletes the files in a directory, then the directory.
+ */
+static void
+removeDirectory(const std::string& path)
+{
+    DIR* directory = opendir(path.c_str());
+    if (directory != NULL) {
+        struct dirent* entry;
+        while ((entry = readdir(directory)) != NULL) {
+            std::string name = entry->d_name;
+            if (name != "." && name != "..") {
+                unlink((path + "/" + name).c_str());
+            }
+        }
+        closedir(directory);
+    }
+    rmdir(path.c_str());
+}
+
+TEST(RocketShipTest, DedupIdenticalBodies)
+{
+    enableDedup();
+    char directory[] = "/tmp/rocketship_dedup_XXXXXX";
+    ASSERT_TRUE(mkdtemp(directory) != NULL);
+    char previous[4096];
+    ASSERT_TRUE(getcwd(previous, sizeof(previous)) != NULL);
+    ASSERT_EQ(0, chdir(directory));
+
+    llvm::LLVMContext context;
+    llvm::Module* first = new llvm::Module("dedup_first", context);
+    createFunction(first, "original");
+    createFunction(first, "copy");
+    llvm::Module* second = new llvm::Module("dedup_second", context);
+    createFunction(second, "original");
+
+    // One pass over both modules, the way a batch runs.
+    llvm::PassManager manager;
+    manager.add(new rocketship::RocketShip());
+    manager.run(*first);
+
+    // The declaration of sink gets a graph of its own, not an alias.
+    std::set<std::string> files = listDotFiles(".");
+    unsigned int aliases = 0;
+    for (std::set<std::string>::iterator file = files.begin(); file != files.end(); file++) {
+        if (readFile(*file).find("same graph as") != std::string::npos) {
+            aliases++;
+        }
+    }
+    EXPECT_EQ(1u, aliases);
+    EXPECT_EQ(1u, files.count("original.dot"));
+    EXPECT_EQ(1u, files.count("copy.dot"));
+    EXPECT_NE(std::string::npos, readFile("copy.dot").find("same graph as original"));
+
+    // The copy of the same name in the next module is a duplicate too,
+    // and writes nothing rather than the same file again.
+    ASSERT_EQ(0, unlink("original.dot"));
+    manager.run(*second);
+    EXPECT_EQ(0u, listDotFiles(".").count("original.dot"));
+
+    ASSERT_EQ(0, chdir(previous));
+    removeDirectory(directory);
+    delete second;
+    delete first;
+}
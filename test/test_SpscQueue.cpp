@@ -0,0 +1,73 @@
+#include "gtest/gtest.h"
+
+#include "../SpscQueue.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+TEST(SpscQueueTest, FirstInFirstOut)
+{
+    SpscQueue<int> queue(3);
+    int value;
+
+    ASSERT_TRUE(queue.empty());
+    ASSERT_FALSE(queue.tryPop(value));
+    ASSERT_TRUE(queue.tryPush(1));
+    ASSERT_TRUE(queue.tryPush(2));
+    ASSERT_FALSE(queue.empty());
+    ASSERT_TRUE(queue.tryPop(value));
+    ASSERT_EQ(1, value);
+    ASSERT_TRUE(queue.tryPop(value));
+    ASSERT_EQ(2, value);
+    ASSERT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTest, Full)
+{
+    SpscQueue<int> queue(2);
+    int value;
+
+    ASSERT_EQ(2, queue.capacity());
+    ASSERT_TRUE(queue.tryPush(1));
+    ASSERT_TRUE(queue.tryPush(2));
+    ASSERT_FALSE(queue.tryPush(3));
+    ASSERT_TRUE(queue.tryPop(value));
+    ASSERT_TRUE(queue.tryPush(3));
+    ASSERT_TRUE(queue.tryPop(value));
+    ASSERT_TRUE(queue.tryPop(value));
+    ASSERT_EQ(3, value);
+}
+
+static const int Count = 100000;
+
+/**
+ * Pushes 0 to Count - 1 onto the queue, yielding while it is full.
+ */
+static void*
+produce(void* queue)
+{
+    SpscQueue<int>* ints = static_cast<SpscQueue<int>*>(queue);
+    for (int i = 0; i < Count; i++) {
+        while (!ints->tryPush(i)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+TEST(SpscQueueTest, AcrossThreads)
+{
+    SpscQueue<int> queue(4);
+    pthread_t producer;
+    ASSERT_EQ(0, pthread_create(&producer, NULL, &produce, &queue));
+
+    for (int expected = 0; expected < Count; expected++) {
+        int value;
+        while (!queue.tryPop(value)) {
+            sched_yield();
+        }
+        ASSERT_EQ(expected, value);
+    }
+    pthread_join(producer, NULL);
+    ASSERT_TRUE(queue.empty());
+}
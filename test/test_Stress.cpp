@@ -0,0 +1,325 @@
+#include "gtest/gtest.h"
+
+#include "../RocketShip.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Module.h"
+#include "llvm/PassManager.h"
+#include "llvm/Support/IRBuilder.h"
+
+#include <dirent.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * Stress tests build pathological control flow graphs with IRBuilder
+ * and run the whole pass over them.  Each test has a wall time and a
+ * memory budget; a watchdog kills the test binary if a shape hangs
+ * outright so a regression fails the run instead of stalling it.
+ */
+
+// Seconds before the watchdog gives up on a single test.
+static const unsigned int WatchdogSeconds = 120;
+
+static void
+onWatchdog(int)
+{
+    const char message[] = "stress test exceeded its watchdog, aborting\n";
+    write(2, message, sizeof(message) - 1);
+    _exit(1);
+}
+
+/**
+ * Measures the wall time from construction, and arms the watchdog for the
+ * lifetime of the object.
+ */
+class StressBudget {
+public:
+    StressBudget()
+    {
+        signal(SIGALRM, onWatchdog);
+        alarm(WatchdogSeconds);
+        gettimeofday(&_start, NULL);
+    }
+
+    ~StressBudget()
+    {
+        alarm(0);
+    }
+
+    long elapsedMillis()
+    {
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        return (now.tv_sec - _start.tv_sec) * 1000 +
+            (now.tv_usec - _start.tv_usec) / 1000;
+    }
+private:
+    struct timeval _start;
+};
+
+/**
+ * @return The resident memory of the process right now, in kB.
+ */
+static long
+residentKb()
+{
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm == NULL) {
+        return 0;
+    }
+    long size = 0;
+    long resident = 0;
+    if (fscanf(statm, "%ld %ld", &size, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(statm);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/**
+ * Deletes a directory and everything under it.
+ */
+static void
+removeTree(const std::string& path)
+{
+    DIR* directory = opendir(path.c_str());
+    if (directory != NULL) {
+        struct dirent* entry;
+        while ((entry = readdir(directory)) != NULL) {
+            std::string name = entry->d_name;
+            if (name == "." || name == "..") {
+                continue;
+            }
+            std::string child = path + "/" + name;
+            struct stat status;
+            if (lstat(child.c_str(), &status) == 0 && S_ISDIR(status.st_mode)) {
+                removeTree(child);
+            } else {
+                unlink(child.c_str());
+            }
+        }
+        closedir(directory);
+    }
+    rmdir(path.c_str());
+}
+
+/**
+ * Runs RocketShip over the module through a pass manager, the same
+ * way opt does.  The pass writes to the current directory, so it is run
+ * from a temporary directory, deleted afterwards.
+ *
+ * The pass runs in a forked child, since the peak resident memory of a
+ * process only ever goes up: once an earlier test has raised it, a later
+ * one would seem to use nothing.  The child starts out with the memory of
+ * the test, so that is taken off its peak.
+ * @param growthKb Receives the peak memory of the pass, in kB.
+ */
+static void
+runRocketShip(llvm::Module* module, long& growthKb)
+{
+    char directory[] = "/tmp/rocketship_stress_XXXXXX";
+    ASSERT_TRUE(mkdtemp(directory) != NULL);
+
+    long startKb = residentKb();
+    pid_t child = fork();
+    ASSERT_LE(0, child);
+    if (child == 0) {
+        // Alarms aren't inherited, so the child has its own watchdog.
+        alarm(WatchdogSeconds);
+        if (chdir(directory) != 0) {
+            _exit(1);
+        }
+        llvm::PassManager manager;
+        manager.add(new rocketship::RocketShip());
+        manager.run(*module);
+        _exit(0);
+    }
+
+    int status;
+    struct rusage usage;
+    ASSERT_EQ(child, wait4(child, &status, 0, &usage));
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    growthKb = usage.ru_maxrss - startKb;
+    removeTree(directory);
+}
+
+/**
+ * Creates a function taking a single i32 argument and returning void.
+ */
+static llvm::Function*
+createFunction(llvm::Module* module, std::string name)
+{
+    llvm::LLVMContext& context = module->getContext();
+    std::vector<const llvm::Type*> params(1, llvm::Type::getInt32Ty(context));
+    llvm::FunctionType* type = llvm::FunctionType::get(llvm::Type::getVoidTy(context),
+                                                       params, false);
+    return llvm::Function::Create(type, llvm::GlobalValue::ExternalLinkage,
+                                  name, module);
+}
+
+/**
+ * Creates an external declaration used to give blocks something to
+ * display.
+ */
+static llvm::Function*
+createSink(llvm::Module* module)
+{
+    llvm::LLVMContext& context = module->getContext();
+    llvm::FunctionType* type = llvm::FunctionType::get(llvm::Type::getVoidTy(context),
+                                                       false);
+    return llvm::Function::Create(type, llvm::GlobalValue::ExternalLinkage,
+                                  "sink", module);
+}
+
+/**
+ * entry branches into a ring of blocks that only branch to the next
+ * block in the ring, so nothing after the start node is displayable.
+ */
+static void
+generateEmptyCycle(llvm::Function* function, unsigned int size)
+{
+    llvm::LLVMContext& context = function->getContext();
+    llvm::IRBuilder<> builder(context);
+    llvm::BasicBlock* entry = llvm::BasicBlock::Create(context, "entry", function);
+    std::vector<llvm::BasicBlock*> ring;
+
+    for (unsigned int i = 0; i < size; i++) {
+        ring.push_back(llvm::BasicBlock::Create(context, "ring", function));
+    }
+
+    builder.SetInsertPoint(entry);
+    builder.CreateBr(ring[0]);
+    for (unsigned int i = 0; i < size; i++) {
+        builder.SetInsertPoint(ring[i]);
+        builder.CreateBr(ring[(i + 1) % size]);
+    }
+}
+
+/**
+ * A switch on the argument with one distinct destination per case.
+ */
+static void
+generateSwitch(llvm::Function* function, llvm::Function* sink, unsigned int cases)
+{
+    llvm::LLVMContext& context = function->getContext();
+    llvm::IRBuilder<> builder(context);
+    llvm::BasicBlock* entry = llvm::BasicBlock::Create(context, "entry", function);
+    llvm::BasicBlock* exit = llvm::BasicBlock::Create(context, "exit", function);
+
+    builder.SetInsertPoint(entry);
+    llvm::SwitchInst* instruction = builder.CreateSwitch(&*function->arg_begin(),
+                                                         exit, cases);
+    for (unsigned int i = 0; i < cases; i++) {
+        llvm::BasicBlock* target = llvm::BasicBlock::Create(context, "case", function);
+        instruction->addCase(llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), i),
+                             target);
+        builder.SetInsertPoint(target);
+        builder.CreateCall(sink);
+        builder.CreateBr(exit);
+    }
+
+    builder.SetInsertPoint(exit);
+    builder.CreateRetVoid();
+}
+
+/**
+ * A single block made up of the supplied number of calls.
+ */
+static void
+generateLongBlock(llvm::Function* function, llvm::Function* sink,
+                  unsigned int instructions)
+{
+    llvm::LLVMContext& context = function->getContext();
+    llvm::IRBuilder<> builder(context);
+    builder.SetInsertPoint(llvm::BasicBlock::Create(context, "entry", function));
+
+    for (unsigned int i = 0; i < instructions; i++) {
+        builder.CreateCall(sink);
+    }
+    builder.CreateRetVoid();
+}
+
+/**
+ * Stores through a chain of GEPs a value computed by a chain of adds
+ * whose operands are both the previous add, so naming either operand
+ * tree naively is linear in stack depth and exponential in time.
+ */
+static void
+generateDeepOperands(llvm::Function* function, unsigned int depth)
+{
+    llvm::LLVMContext& context = function->getContext();
+    llvm::IRBuilder<> builder(context);
+    builder.SetInsertPoint(llvm::BasicBlock::Create(context, "entry", function));
+
+    llvm::Value* value = &*function->arg_begin();
+    llvm::Value* pointer = builder.CreateAlloca(llvm::Type::getInt32Ty(context),
+                                                llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), depth));
+    for (unsigned int i = 0; i < depth; i++) {
+        value = builder.CreateAdd(value, value);
+        pointer = builder.CreateGEP(pointer, value);
+    }
+    builder.CreateStore(value, pointer);
+    builder.CreateRetVoid();
+}
+
+TEST(StressTest, EmptyBlockCycle)
+{
+    llvm::LLVMContext context;
+    llvm::Module* module = new llvm::Module("stress_cycle", context);
+    generateEmptyCycle(createFunction(module, "stress_cycle"), 10000);
+
+    StressBudget budget;
+    long growthKb = 0;
+    runRocketShip(module, growthKb);
+    EXPECT_GT(2000, budget.elapsedMillis());
+    EXPECT_GT(128 * 1024, growthKb);
+    delete module;
+}
+
+TEST(StressTest, WideSwitch)
+{
+    llvm::LLVMContext context;
+    llvm::Module* module = new llvm::Module("stress_switch", context);
+    generateSwitch(createFunction(module, "stress_switch"), createSink(module), 10000);
+
+    StressBudget budget;
+    long growthKb = 0;
+    runRocketShip(module, growthKb);
+    EXPECT_GT(5000, budget.elapsedMillis());
+    EXPECT_GT(256 * 1024, growthKb);
+    delete module;
+}
+
+TEST(StressTest, LongBlock)
+{
+    llvm::LLVMContext context;
+    llvm::Module* module = new llvm::Module("stress_block", context);
+    generateLongBlock(createFunction(module, "stress_block"), createSink(module), 100000);
+
+    StressBudget budget;
+    long growthKb = 0;
+    runRocketShip(module, growthKb);
+    EXPECT_GT(10000, budget.elapsedMillis());
+    EXPECT_GT(512 * 1024, growthKb);
+    delete module;
+}
+
+TEST(StressTest, DeepOperandTrees)
+{
+    llvm::LLVMContext context;
+    llvm::Module* module = new llvm::Module("stress_operands", context);
+    generateDeepOperands(createFunction(module, "stress_operands"), 10000);
+
+    StressBudget budget;
+    long growthKb = 0;
+    runRocketShip(module, growthKb);
+    EXPECT_GT(2000, budget.elapsedMillis());
+    EXPECT_GT(128 * 1024, growthKb);
+    delete module;
+}
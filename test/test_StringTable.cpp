@@ -0,0 +1,121 @@
+#include "gtest/gtest.h"
+
+#include "../StringTable.h"
+
+#include <pthread.h>
+#include <sstream>
+#include <vector>
+
+TEST(StringTableTest, EmptyString)
+{
+    StringTable strings;
+    EXPECT_EQ(StringTable::Empty, strings.intern(std::string("")));
+    EXPECT_EQ("", strings.lookup(StringTable::Empty));
+}
+
+TEST(StringTableTest, InternSameText)
+{
+    StringTable strings;
+    StringTable::Id first = strings.intern(std::string("call printf (...)"));
+    StringTable::Id second = strings.intern(std::string("call printf (...)"));
+    StringTable::Id other = strings.intern(std::string("call puts (...)"));
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, other);
+    EXPECT_EQ("call printf (...)", strings.lookup(first));
+    EXPECT_EQ("call puts (...)", strings.lookup(other));
+}
+
+TEST(StringTableTest, ManyStrings)
+{
+    // Enough strings to need more than one chunk.
+    StringTable strings;
+    std::vector<StringTable::Id> ids;
+    for (int i = 0; i < 10000; i++) {
+        std::ostringstream value;
+        value << "many_" << i;
+        ids.push_back(strings.intern(value.str()));
+    }
+    for (int i = 0; i < 10000; i++) {
+        std::ostringstream value;
+        value << "many_" << i;
+        ASSERT_EQ(value.str(), strings.lookup(ids[i]));
+    }
+}
+
+/**
+ * The table a thread interns into, and the ids it was given.
+ */
+struct Interning {
+    StringTable* strings;
+    int offset;
+    std::vector<StringTable::Id> ids;
+};
+
+static void*
+internConcurrently(void* argument)
+{
+    // Every thread interns the same strings in a different order and
+    // records the ids it was given.
+    Interning* interning = static_cast<Interning*>(argument);
+    interning->ids.assign(1000, 0);
+    for (int i = 0; i < 1000; i++) {
+        int index = (i + interning->offset * 37) % 1000;
+        std::ostringstream value;
+        value << "concurrent_" << index;
+        interning->ids[index] = interning->strings->intern(value.str());
+    }
+    return NULL;
+}
+
+TEST(StringTableTest, ConcurrentIntern)
+{
+    const int threadCount = 8;
+    StringTable strings;
+    pthread_t threads[threadCount];
+    Interning interning[threadCount];
+
+    for (int i = 0; i < threadCount; i++) {
+        interning[i].strings = &strings;
+        interning[i].offset = i;
+        pthread_create(&threads[i], NULL, internConcurrently, &interning[i]);
+    }
+    for (int i = 0; i < threadCount; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (int i = 1; i < threadCount; i++) {
+        ASSERT_EQ(interning[0].ids, interning[i].ids);
+    }
+    for (int i = 0; i < 1000; i++) {
+        std::ostringstream value;
+        value << "concurrent_" << i;
+        ASSERT_EQ(value.str(), strings.lookup(interning[0].ids[i]));
+    }
+}
+
+TEST(StringTableTest, Clear)
+{
+    StringTable strings;
+    strings.intern(std::string("call printf (...)"));
+    ASSERT_LT(1u, strings.size());
+
+    strings.clear();
+    EXPECT_EQ(1u, strings.size());
+    EXPECT_FALSE(strings.isFull());
+    EXPECT_EQ("", strings.lookup(StringTable::Empty));
+    StringTable::Id id = strings.intern(std::string("call puts (...)"));
+    EXPECT_EQ(1u, id);
+    EXPECT_EQ("call puts (...)", strings.lookup(id));
+}
+
+TEST(StringTableTest, SeparateTables)
+{
+    // Ids are per table: clearing one leaves the other's valid.
+    StringTable first;
+    StringTable second;
+    StringTable::Id id = first.intern(std::string("call printf (...)"));
+    second.intern(std::string("call puts (...)"));
+    second.clear();
+    EXPECT_EQ("call printf (...)", first.lookup(id));
+    EXPECT_EQ(1u, second.size());
+}
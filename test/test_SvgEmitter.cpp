@@ -0,0 +1,41 @@
+#include "gtest/gtest.h"
+
+#include "../SvgEmitter.h"
+#include "../Node.h"
+
+#include <sstream>
+
+TEST(SvgEmitterTest, Graph)
+{
+    StringTable strings;
+    Graph graph(strings);
+    graph.reset(2, 1);
+    graph.addNode(0, Node::DECISION, strings.intern(std::string("x < 3")), StringTable::Empty, NULL);
+    graph.addEdge(1, strings.intern(std::string("true")), -1);
+    graph.addNode(1, Node::END, strings.intern(std::string("ret")), StringTable::Empty, NULL);
+    graph.finish();
+
+    Layout layout;
+    layout.compute(graph, 4);
+    std::ostringstream out;
+    SvgEmitter emitter(out, layout);
+    emitter.beginGraph("main", "int main()");
+    emitter.emitNode(graph, 0);
+    emitter.emitNode(graph, 1);
+    emitter.endGraph();
+
+    ASSERT_EQ("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+              "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"70pt\" height=\"124pt\" viewBox=\"0 0 70 124\">\n"
+              "<title>int main()</title>\n"
+              "<defs><marker id=\"arrow\" viewBox=\"0 0 10 10\" refX=\"10\" refY=\"5\""
+              " markerWidth=\"8\" markerHeight=\"8\" orient=\"auto\">"
+              "<path d=\"M0,0 L10,5 L0,10 z\"/></marker></defs>\n"
+              "<g id=\"main\" font-family=\"Times,serif\" font-size=\"14\" text-anchor=\"middle\""
+              " fill=\"none\" stroke=\"black\">\n"
+              "<polygon points=\"8,26 35,8 62,26 35,44\"/>\n"
+              "<text x=\"35\" y=\"31\" fill=\"black\" stroke=\"none\">x &lt; 3</text>\n"
+              "<line x1=\"35\" y1=\"44\" x2=\"35\" y2=\"80\" marker-end=\"url(#arrow)\"/>\n"
+              "<text x=\"35\" y=\"62\" font-size=\"10\" fill=\"black\" stroke=\"none\">true</text>\n"
+              "<text x=\"35\" y=\"103\" fill=\"black\" stroke=\"none\">ret</text>\n"
+              "</g>\n</svg>\n", out.str());
+}
@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+
+#include "../SymbolLegend.h"
+
+static const std::string LongSymbol =
+    "std::vector<std::basic_string<char>, std::allocator<std::basic_string<char> > >::push_back";
+
+TEST(SymbolLegendTest, NoBudget)
+{
+    SymbolLegend legend;
+    std::string label = "call " + LongSymbol;
+    ASSERT_EQ(label, legend.abbreviate(label, std::vector<std::string>(1, LongSymbol)));
+    ASSERT_TRUE(legend.getEntries().empty());
+}
+
+TEST(SymbolLegendTest, WithinBudget)
+{
+    SymbolLegend legend(20);
+    ASSERT_EQ("call printf (x)", legend.abbreviate("call printf (x)", std::vector<std::string>()));
+}
+
+TEST(SymbolLegendTest, Alias)
+{
+    SymbolLegend legend(40);
+    std::vector<std::string> symbols(1, LongSymbol);
+    legend.beginGraph();
+
+    ASSERT_EQ("call F1", legend.abbreviate("call " + LongSymbol, symbols));
+    ASSERT_EQ("invoke F1 F1", legend.abbreviate("invoke " + LongSymbol + " " + LongSymbol, symbols));
+    ASSERT_EQ(1, legend.getEntries().size());
+    ASSERT_EQ(1, legend.getGraphEntries().size());
+    ASSERT_EQ("F1", legend.getGraphEntries()[0].first);
+    ASSERT_EQ(LongSymbol, legend.getGraphEntries()[0].second);
+
+    // Aliases carry over to later graphs, which list only their own.
+    legend.beginGraph();
+    ASSERT_TRUE(legend.getGraphEntries().empty());
+    ASSERT_EQ("F2", legend.getAlias("another_rather_long_symbol"));
+    ASSERT_EQ("F1", legend.getAlias(LongSymbol));
+
+    SymbolLegend::Entries entries(1, SymbolLegend::Entry("F1", LongSymbol));
+    legend.addGraphEntries(entries);
+    legend.addGraphEntries(entries);
+    ASSERT_EQ(1, legend.getGraphEntries().size());
+
+    legend.clear();
+    ASSERT_EQ("F1", legend.getAlias("another_rather_long_symbol"));
+}
+
+TEST(SymbolLegendTest, LongestFirst)
+{
+    SymbolLegend legend(10);
+    std::vector<std::string> symbols;
+    symbols.push_back("ns::inner_function");
+    symbols.push_back("ns::inner_function<ns::type>");
+
+    ASSERT_EQ("call F1", legend.abbreviate("call ns::inner_function<ns::type>", symbols));
+    ASSERT_EQ("ns::inner_function<ns::type>", legend.getEntries()[0].second);
+}
+
+TEST(SymbolLegendTest, Truncate)
+{
+    SymbolLegend legend(10);
+    ASSERT_EQ("call ab...", legend.abbreviate("call abcdefghijkl", std::vector<std::string>()));
+    // Short symbols aren't worth an alias.
+    ASSERT_EQ("call ab...", legend.abbreviate("call abcdefgh (x, y)", std::vector<std::string>(1, "abcdefgh")));
+    ASSERT_TRUE(legend.getEntries().empty());
+}